@@ -83,7 +83,7 @@ int main(void) {
 
 
 	/*
-	 * Alarm pointer used for iterating over the alarms list
+	 * Alarm pointer used for iterating over the alarms lists
 	 * and also to store new alarms created by the user.
 	 */
 	Alarm *curr_alarm = NULL;
@@ -104,10 +104,18 @@ int main(void) {
 
 
 
-	/* Pointer to the head of the threads singly-linked-list. */
-	Thread *thread_list_head = NULL;
 	/*
-	 * Thread pointer used for iterating over the threads list
+	 * Pointer to the head of the partitions singly-linked-list, i.e.,
+	 * the alarms table partitioned by the alarms' message types.
+	 */
+	Partition *partition_list_head = NULL;
+	/*
+	 * Partition pointer used for iterating over the partitions list
+	 * and also to store the partition of the current command's type.
+	 */
+	Partition *curr_partition = NULL;
+	/*
+	 * Thread pointer used for iterating over the threads lists
 	 * and also to store new threads created by the user.
 	 */
 	Thread *curr_thread = NULL;
@@ -115,17 +123,11 @@ int main(void) {
 
 
 	/*
-	 * Thread pointer used to save the pointer to the previous
-	 * node in the local threads list when removing nodes from
+	 * Partition pointer used to save the pointer to the previous
+	 * node in the partitions list when removing a partition from
 	 * the list in Type C command executions.
 	 */
-	Thread *prev_thread = NULL;
-	/*
-	 * Alarm pointer used to save the pointer to the previous
-	 * node in the global alarms list when removing alarms from
-	 * the list in Type C command executions.
-	 */
-	Alarm *prev_alarm = NULL;
+	Partition *prev_partition = NULL;
 
 
 
@@ -155,7 +157,7 @@ int main(void) {
 	data.err.val = 0; data.err.msg = "";
 	data.separate_log_file = separate_log_file;
 	data.line = line;
-	data.thread_list_head = thread_list_head;
+	data.partition_list_head = partition_list_head;
 
 
 
@@ -407,6 +409,21 @@ int main(void) {
 
 
 
+			/* Find or create the partition of the new alarm's message type. */
+			status = find_partition(&partition_list_head, msg_type, true, &curr_partition);
+			data.partition_list_head = partition_list_head;
+			if (status != 0) {
+				/* Cleanup main thread and terminate. */
+				data.err.linenum = __LINE__;
+				data.err.val = status;
+				if (status == ALLOC_PARTITION_ERR) {
+					data.err.msg = ALLOC_PARTITION_ERR_MSG;
+				} else { /* (status == MUTEX_INIT_ERR) */
+					data.err.msg = MUTEX_INIT_ERR_MSG;
+				}
+				pthread_exit(&data);
+			}
+
 			/* Allocate memory for the new alarm node. */
 			curr_alarm = MALLOC(Alarm);
 			if (curr_alarm == NULL) {
@@ -423,8 +440,8 @@ int main(void) {
 			strcpy(curr_alarm->msg, msg); /* Set curr_alarm's message. */
 			curr_alarm->is_assigned = false;
 
-			/* Lock the mutex. */
-			status = pthread_mutex_lock(&mutex);
+			/* Lock the partition's mutex. */
+			status = pthread_mutex_lock(&(curr_partition->mutex));
 			if (status != 0) {
 				free(curr_alarm); /* Free memory allocated to curr_alarm. */
 
@@ -436,23 +453,45 @@ int main(void) {
 
 			/*
 			 * Critical Section:
-			 * Insert the new alarm pointed to by curr_alarm into the global
+			 * Insert the new alarm pointed to by curr_alarm into the partition's
 			 * alarms list in sorted order using the insert_alarm method.
 			 */
-			insert_alarm(&alarm_list_head, curr_alarm, next_alarm,
+			insert_alarm(&(curr_partition->alarm_list_head), curr_alarm, next_alarm,
 						insert_first_alarm, insert_after_alarm);
 
+			/*
+			 * Post the new alarm to the inbox of the first alarm handler
+			 * thread of its message type(if any) and wake the thread up, so
+			 * that it is assigned right away rather than being searched for.
+			 */
+			curr_thread = curr_partition->thread_list_head;
+			if (curr_thread != NULL) {
+				/* Set the alarm's state to ASSIGNED. */
+				curr_alarm->is_assigned = true;
+				/* Add the alarm to the beginning of the thread's inbox in O(1). */
+				curr_alarm->link_handle = curr_thread->inbox_head;
+				curr_thread->inbox_head = curr_alarm;
+
+				status = pthread_cond_signal(&(curr_thread->wakeup_cond_var));
+				if (status != 0) {
+					/* Cleanup main thread and terminate. */
+					data.err.linenum = __LINE__;
+					data.err.val = COND_VAR_SIGNAL_ERR; data.err.msg = COND_VAR_SIGNAL_ERR_MSG;
+					pthread_exit(&data);
+				}
+			}
+
 			/* Print status message informing the user of the internal state. */
 			fprintf(app_log, "New alarm with message type = %" PRIuFAST32 \
 						" inserted by Main thread with ID = %" PRIuFAST64 \
 						" into the alarms list at %" PRIuFAST64 ".\n", msg_type, id, now());
 
-			/* Unlock the mutex. */
-			status = pthread_mutex_unlock(&mutex);
+			/* Unlock the partition's mutex. */
+			status = pthread_mutex_unlock(&(curr_partition->mutex));
 			if (status != 0) {
 				/*
 				 * We do not need to free memory allocated to curr_alarm
-				 * since it has been successfully inserted into the global
+				 * since it has been successfully inserted into the partition's
 				 * alarms list which will be freed by the main cleanup.
 				 */
 
@@ -491,6 +530,21 @@ int main(void) {
 
 
 
+			/* Find or create the partition of the new thread's message type. */
+			status = find_partition(&partition_list_head, msg_type, true, &curr_partition);
+			data.partition_list_head = partition_list_head;
+			if (status != 0) {
+				/* Cleanup main thread and terminate. */
+				data.err.linenum = __LINE__;
+				data.err.val = status;
+				if (status == ALLOC_PARTITION_ERR) {
+					data.err.msg = ALLOC_PARTITION_ERR_MSG;
+				} else { /* (status == MUTEX_INIT_ERR) */
+					data.err.msg = MUTEX_INIT_ERR_MSG;
+				}
+				pthread_exit(&data);
+			}
+
 			/* Allocate memory for the new thread node. */
 			curr_thread = MALLOC(Thread);
 			if (curr_thread == NULL) {
@@ -503,9 +557,20 @@ int main(void) {
 			/* Initialize the new thread node's attributes. */
 			curr_thread->link = NULL;
 			curr_thread->msg_type = msg_type;
+			curr_thread->partition = curr_partition;
+			curr_thread->inbox_head = NULL;
+			status = init_monotonic_cond_var(&(curr_thread->wakeup_cond_var));
+			if (status != 0) {
+				free(curr_thread); /* Free memory allocated to curr_thread. */
+				/* Cleanup main thread and terminate. */
+				data.err.linenum = __LINE__;
+				data.err.val = COND_VAR_INIT_ERR; data.err.msg = COND_VAR_INIT_ERR_MSG;
+				pthread_exit(&data);
+			}
 			status = pthread_create(&(curr_thread->id), NULL,
-						alarm_handler, (void *) (&msg_type));
+						alarm_handler, (void *) curr_thread);
 			if (status != 0) {
+				pthread_cond_destroy(&(curr_thread->wakeup_cond_var));
 				free(curr_thread); /* Free memory allocated to curr_thread. */
 
 				/* Cleanup main thread and terminate. */
@@ -514,9 +579,9 @@ int main(void) {
 				pthread_exit(&data);
 			}
 
-			/* Add the new thread to the beginning of the (local) threads list in O(1). */
-			curr_thread->link = thread_list_head;
-			data.thread_list_head = thread_list_head = curr_thread;
+			/* Add the new thread to the beginning of the partition's threads list in O(1). */
+			curr_thread->link = curr_partition->thread_list_head;
+			curr_partition->thread_list_head = curr_thread;
 
 			/* Print status message informing the user of the internal state. */
 			fprintf(app_log, "New Alarm thread with ID = %" PRIuFAST64 \
@@ -553,10 +618,24 @@ int main(void) {
 
 
 
-			/* Cancel all threads handling messages of type msg_type. */
-			prev_thread = NULL;
-			for (curr_thread = thread_list_head; curr_thread != NULL; /* Update inside. */) {
-				if (curr_thread->msg_type == msg_type) {
+			/*
+			 * Find the partition of message type msg_type(if any) which is
+			 * the only part of the alarms table that the command touches.
+			 */
+			prev_partition = NULL;
+			for (curr_partition = partition_list_head; curr_partition != NULL; curr_partition = curr_partition->link) {
+				if (curr_partition->msg_type == msg_type) { break; }
+				prev_partition = curr_partition;
+			}
+
+			if (curr_partition != NULL) {
+				/* Cancel all threads handling messages of type msg_type. */
+				while (curr_partition->thread_list_head != NULL) {
+					/* Save the current first element. */
+					curr_thread = curr_partition->thread_list_head;
+					/* Move to the next element. */
+					curr_partition->thread_list_head = curr_partition->thread_list_head->link;
+
 					/* Attempt to cancel the thread. */
 					status = cancel_thread(curr_thread->id);
 					if (status != 0) {
@@ -573,57 +652,39 @@ int main(void) {
 						pthread_exit(&data);
 					}
 
-					/* Remove the thread from the local threads list. */
-					if (curr_thread == thread_list_head) {
-						/* The current thread is the first thread in the list. */
-
-						/* Update the head pointer of the list. */
-						data.thread_list_head = thread_list_head = thread_list_head->link;
+					/* Destroy the thread's conditional variable. */
+					status = pthread_cond_destroy(&(curr_thread->wakeup_cond_var));
+					if (status != 0) {
+						/* Cleanup main thread and terminate. */
+						data.err.linenum = __LINE__;
+						data.err.val = COND_VAR_DESTROY_ERR; data.err.msg = COND_VAR_DESTROY_ERR_MSG;
+						pthread_exit(&data);
+					}
 
-						/* Detach and free the element saved in curr_thread. */
-						curr_thread->link = NULL;
-						free(curr_thread);
+					/* Detach and free the element saved in curr_thread. */
+					curr_thread->link = NULL;
+					free(curr_thread);
+				}
 
-						/* Update curr_thread. */
-						curr_thread = thread_list_head;
-					} else { /* (curr_thread != thread_list_head) */
-						/* The current thread is NOT the first thread in the list. */
 
-						/* Make the prev node point to the next node in the list. */
-						prev_thread->link = curr_thread->link;
 
-						/* Detach and free the element saved in curr_thread. */
-						curr_thread->link = NULL;
-						free(curr_thread);
+				/*
+				 * No need to lock the partition's mutex since all of
+				 * its alarm handler threads have been cancelled and
+				 * as such the main thread is the only thread left
+				 * which accesses the partition.
+				 */
 
-						/* Update curr_thread. */
-						curr_thread = prev_thread->link;
-					}
-				} else { /* (curr_thread->msg_type != msg_type) */
+				/*
+				 * Remove all alarms of message type msg_type from
+				 * the partition's alarms list and free the allocated memory.
+				 */
+				while (curr_partition->alarm_list_head != NULL) {
+					/* Save the current first element. */
+					curr_alarm = curr_partition->alarm_list_head;
 					/* Move to the next element. */
-					prev_thread = curr_thread;
-					curr_thread = curr_thread->link;
-				}
-			}
-
-
-
-			/* Lock the mutex. */
-			status = pthread_mutex_lock(&mutex);
-			if (status != 0) {
-				/* Cleanup main thread and terminate. */
-				data.err.linenum = __LINE__;
-				data.err.val = MUTEX_LOCK_ERR; data.err.msg = MUTEX_LOCK_ERR_MSG;
-				pthread_exit(&data);
-			}
+					curr_partition->alarm_list_head = curr_partition->alarm_list_head->link;
 
-			/*
-			 * Remove all alarms of message type msg_type from
-			 * the global alarms list and free the allocated memory.
-			 */
-			prev_alarm = NULL;
-			for (curr_alarm = alarm_list_head; curr_alarm != NULL; /* Update inside. */) {
-				if (curr_alarm->msg_type == msg_type) {
 					/*
 					 * If the alarm was assigned to a thread, then its
 					 * link_handle attribute has been set to NULL by
@@ -633,50 +694,36 @@ int main(void) {
 					 * attribute was initialized to NULL and has remained so.
 					 *
 					 * Therefore, at this point, we only have to worry about
-					 * the link attribute which connects nodes in the global
-					 * alarms list.
+					 * the link attribute which connects nodes in the
+					 * partition's alarms list.
 					 */
 
-					/* Remove the alarm from the global alarms list. */
-					if (curr_alarm == alarm_list_head) {
-						/* The current alarm is the first alarm in the list. */
-
-						/* Update the head pointer of the list. */
-						alarm_list_head = alarm_list_head->link;
-
-						/* Detach and free the element saved in curr_alarm. */
-						curr_alarm->link = NULL;
-						free(curr_alarm);
-
-						/* Update curr_alarm. */
-						curr_alarm = alarm_list_head;
-					} else { /* (curr_alarm != alarm_list_head) */
-						/* The current alarm is NOT the first alarm in the list. */
-
-						/* Make the prev node point to the next node in the list. */
-						prev_alarm->link = curr_alarm->link;
+					/* Detach and free the element saved in curr_alarm. */
+					curr_alarm->link = NULL;
+					free(curr_alarm);
+				}
 
-						/* Detach and free the element saved in curr_alarm. */
-						curr_alarm->link = NULL;
-						free(curr_alarm);
+				/* Destroy the partition's mutex. */
+				status = pthread_mutex_destroy(&(curr_partition->mutex));
+				if (status != 0) {
+					/* Cleanup main thread and terminate. */
+					data.err.linenum = __LINE__;
+					data.err.val = MUTEX_DESTROY_ERR; data.err.msg = MUTEX_DESTROY_ERR_MSG;
+					pthread_exit(&data);
+				}
 
-						/* Update curr_alarm. */
-						curr_alarm = prev_alarm->link;
-					}
-				} else { /* (curr_alarm->msg_type != msg_type) */
-					/* Move to the next element. */
-					prev_alarm = curr_alarm;
-					curr_alarm = curr_alarm->link;
+				/* Remove the partition from the partitions list. */
+				if (curr_partition == partition_list_head) {
+					/* Update the head pointer of the list. */
+					data.partition_list_head = partition_list_head = partition_list_head->link;
+				} else { /* (curr_partition != partition_list_head) */
+					/* Make the prev node point to the next node in the list. */
+					prev_partition->link = curr_partition->link;
 				}
-			}
 
-			/* Unlock the mutex. */
-			status = pthread_mutex_unlock(&mutex);
-			if (status != 0) {
-				/* Cleanup main thread and terminate. */
-				data.err.linenum = __LINE__;
-				data.err.val = MUTEX_UNLOCK_ERR; data.err.msg = MUTEX_UNLOCK_ERR_MSG;
-				pthread_exit(&data);
+				/* Detach and free the element saved in curr_partition. */
+				curr_partition->link = NULL;
+				free(curr_partition);
 			}
 
 			/* Print status message informing the user of the internal state. */
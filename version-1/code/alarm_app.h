@@ -23,7 +23,6 @@
 	/* Headers */
 
 	#include "alarm_def.h"
-	#include <sched.h>
 
 
 
@@ -85,8 +84,8 @@
 		/* Last read line of input. */
 		char					*line;
 
-		/* Pointer to the head of the threads singly-linked-list. */
-		Thread					*thread_list_head;
+		/* Pointer to the head of the partitions singly-linked-list. */
+		Partition				*partition_list_head;
 	} MLData;
 
 
@@ -96,18 +95,12 @@
 	/*
 	 * Shared data between threads:
 	 *
-	 * 1. The mutex used to lock access to the alarms singly-linked-list.
+	 * 1. Application log file where all application messages are printed to.
 	 *
-	 * 2. Pointer to the head of the alarms singly-linked-list.
-	 *
-	 * 3. Application log file where all application messages are printed to.
+	 * The alarms are partitioned by their message types and each alarm
+	 * handler thread only shares the partition of its message type(and
+	 * its mutex) with the main thread, which it is given on creation.
 	 */
-	/* Initialize the mutex. */
-	EXTERN pthread_mutex_t mutex SET(PTHREAD_MUTEX_INITIALIZER);
-
-	/* Initialize an empty alarms list. */
-	EXTERN Alarm *alarm_list_head SET(NULL);
-
 	/* Initialize the application log file. */
 	EXTERN FILE *app_log SET(NULL);
 
@@ -134,7 +127,7 @@
 	/*
 	 * The alarm handler thread routine.
 	 *
-	 * Precondition: arg can be safely casted into (uint_fast32_t *).
+	 * Precondition: arg can be safely casted into (Thread *).
 	 *
 	 * Returns: arg
 	 */
@@ -147,4 +140,13 @@
 	 */
 	EXTERN void cleanup_alarm_handler(void *arg);
 
+	/*
+	 * The alarm handler thread cleanup routine used while it is
+	 * waiting on its conditional variable which unlocks its partition's mutex.
+	 *
+	 * Precondition: arg can be safely casted into (pthread_mutex_t *)
+	 * which points to a mutex that is locked by the caller.
+	 */
+	EXTERN void cleanup_alarm_handler_mutex(void *arg);
+
 #endif
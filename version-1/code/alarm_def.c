@@ -74,7 +74,7 @@ int is_valid_cmd(const char *line, const size_t len,
 /* Singly Linked List Functions */
 
 /*
- * Get the next Alarm after node in the global alarms list.
+ * Get the next Alarm after node in its partition's alarms list.
  *
  * Precondition: node != NULL
  *
@@ -276,6 +276,70 @@ void insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 	(*insert_after)(curr_alarm, new_alarm);
 }
 
+/*
+ * Find the partition of the given message type(msg_type) in the given
+ * partitions singly-linked-list. The list is accessed and/or modified
+ * through *head_ptr which points to the head of the list.
+ *
+ * If there is no such partition and create is true, then a new empty
+ * partition with an initialized mutex is created and inserted as the
+ * new first element of the list.
+ *
+ * The result is stored in *partition_ptr which is set to NULL if there
+ * is no such partition and create is false.
+ *
+ * Preconditions:
+ * 		1. head_ptr != NULL
+ * 		2. partition_ptr != NULL
+ *
+ * Returns:
+ * 		1. ALLOC_PARTITION_ERR
+ * 										if the memory allocation fails
+ * 		2. MUTEX_INIT_ERR
+ * 										if the mutex cannot be initialized
+ * 		3. 0
+ * 										on success
+ */
+int find_partition(Partition **head_ptr, const uint_fast32_t msg_type,
+			const bool create, Partition **partition_ptr) {
+
+	/* Partition pointer used for iterating over the partitions list. */
+	Partition *curr_partition = NULL;
+
+
+
+	/* Search the list for the partition of the given message type. */
+	for (curr_partition = *head_ptr; curr_partition != NULL; curr_partition = curr_partition->link) {
+		if (curr_partition->msg_type == msg_type) { break; }
+	}
+	*partition_ptr = curr_partition;
+	if ((curr_partition != NULL) || (!create)) { return 0; }
+
+
+
+	/* Allocate memory for the new partition node. */
+	curr_partition = MALLOC(Partition);
+	if (curr_partition == NULL) { return ALLOC_PARTITION_ERR; }
+
+	/* Initialize the new partition node's attributes. */
+	curr_partition->link = NULL;
+	curr_partition->msg_type = msg_type;
+	curr_partition->alarm_list_head = NULL;
+	curr_partition->thread_list_head = NULL;
+	if (pthread_mutex_init(&(curr_partition->mutex), NULL) != 0) {
+		free(curr_partition); /* Free memory allocated to curr_partition. */
+		return MUTEX_INIT_ERR;
+	}
+
+	/* Add the new partition to the beginning of the partitions list in O(1). */
+	curr_partition->link = *head_ptr;
+	*partition_ptr = *head_ptr = curr_partition;
+
+
+
+	return 0;
+}
+
 
 
 /* Thread Functions */
@@ -325,5 +389,43 @@ int cancel_thread(pthread_t id) {
 
 
 
+	return 0;
+}
+
+/*
+ * Initialize the conditional variable pointed to by cond_var
+ * so that its timed waits are measured on the monotonic clock.
+ *
+ * Precondition: cond_var != NULL
+ *
+ * Returns:
+ * 		1. COND_VAR_INIT_ERR
+ * 										if it cannot be initialized
+ * 		2. 0
+ * 										on success
+ */
+int init_monotonic_cond_var(pthread_cond_t *cond_var) {
+	/* The attributes that the conditional variable is initialized with. */
+	pthread_condattr_t attr;
+
+
+
+	if (pthread_condattr_init(&attr) != 0) { return COND_VAR_INIT_ERR; }
+
+	/*
+	 * Timeouts on the monotonic clock are not affected by changes
+	 * to the system time, so that the thread still wakes up every
+	 * second when the system time is changed.
+	 */
+	if ((pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) != 0) ||
+		(pthread_cond_init(cond_var, &attr) != 0)) {
+
+		pthread_condattr_destroy(&attr);
+		return COND_VAR_INIT_ERR;
+	}
+	pthread_condattr_destroy(&attr);
+
+
+
 	return 0;
 }
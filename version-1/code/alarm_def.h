@@ -35,12 +35,6 @@
 	 */
 	#define MAX_MSG_LEN 50
 
-	/*
-	 * Alarm threads wait the following number of seconds between
-	 * two consecutive updates of their local alarms list.
-	 */
-	#define ALARM_THREAD_UPDATE_PERIOD 10
-
 	/*
 	 * The following consists of possible errors that
 	 * can occur during the application execution.
@@ -92,6 +86,14 @@
 	#define SEM_DESTROY_ERR -11
 	#define SEM_DESTROY_ERR_MSG "Semaphore destroy error"
 
+	/* Clock reading error. */
+	#define CLOCK_ERR -12
+	#define CLOCK_ERR_MSG "Clock reading error"
+
+	/* Partition memory allocation error. */
+	#define ALLOC_PARTITION_ERR -13
+	#define ALLOC_PARTITION_ERR_MSG "Partition memory allocation error"
+
 	/* Positive values imply that errno is NOT set. */
 
 	/* Mutex lock error. */
@@ -154,17 +156,25 @@
 	#define STREAM_ERR 15
 	#define STREAM_ERR_MSG "Stream error"
 
+	/* Conditional variable initialization error. */
+	#define COND_VAR_INIT_ERR 16
+	#define COND_VAR_INIT_ERR_MSG "Conditional variable initialization error"
+
+	/* Mutex initialization error. */
+	#define MUTEX_INIT_ERR 17
+	#define MUTEX_INIT_ERR_MSG "Mutex initialization error"
+
 
 
 	/* Type Definitions */
 
 	/* Structure encapsulating each alarm as a node in a singly-linked-list. */
 	typedef struct AlarmNode {
-		/* Pointer to the next alarm node in the global alarms list. */
+		/* Pointer to the next alarm node in its partition's alarms list. */
 		struct AlarmNode		*link;
 		/*
 		 * Pointer to the next alarm node in the local alarms list
-		 * being handled by some handling thread.
+		 * being handled by some handling thread(or in its inbox).
 		 */
 		struct AlarmNode		*link_handle;
 
@@ -192,15 +202,61 @@
 
 	/* Structure encapsulating each pthread as a node in a singly-linked-list. */
 	typedef struct ThreadNode {
-		/* Pointer to the next thread node in the threads list. */
+		/* Pointer to the next thread node in its partition's threads list. */
 		struct ThreadNode		*link;
 
 		/* The alarm message type that the thread is handling. */
 		uint_fast32_t			msg_type;
 		/* The thread's identifier(ID) returned by pthread_create(). */
 		pthread_t				id;
+
+		/* The partition of the alarm message type that the thread is handling. */
+		struct PartitionNode	*partition;
+
+		/*
+		 * The conditional variable that only the thread waits on(with its
+		 * partition's mutex locked) until its next print or until the main
+		 * thread posts new alarms to its inbox. It waits on the monotonic clock.
+		 */
+		pthread_cond_t			wakeup_cond_var;
+		/*
+		 * Pointer to the head of the thread's inbox, i.e., the list(through
+		 * the link_handle attribute) of the alarms of its message type that
+		 * the main thread has inserted and assigned to it since it last woke
+		 * up. It is only accessed while its partition's mutex is locked.
+		 */
+		Alarm					*inbox_head;
 	} Thread;
 
+	/*
+	 * Structure encapsulating the partition of the alarms table which
+	 * holds all of the alarms and alarm handler threads of a single
+	 * message type as a node in a singly-linked-list.
+	 *
+	 * Each partition has its own mutex so that alarm handler threads
+	 * of different message types never contend with each other, and
+	 * commands of a given message type only lock its own partition.
+	 */
+	typedef struct PartitionNode {
+		/* Pointer to the next partition node in the partitions list. */
+		struct PartitionNode	*link;
+
+		/* The alarm message type of all of the alarms and threads in the partition. */
+		uint_fast32_t			msg_type;
+
+		/* The mutex used to lock access to the partition's alarms list. */
+		pthread_mutex_t			mutex;
+
+		/* Pointer to the head of the partition's alarms singly-linked-list. */
+		Alarm					*alarm_list_head;
+
+		/*
+		 * Pointer to the head of the partition's threads singly-linked-list
+		 * which is only accessed and/or modified by the main thread.
+		 */
+		Thread					*thread_list_head;
+	} Partition;
+
 
 
 	/* Function Prototypes */
@@ -231,7 +287,7 @@
 	/* Singly Linked List Functions */
 
 	/*
-	 * Get the next Alarm after node in the global alarms list.
+	 * Get the next Alarm after node in its partition's alarms list.
 	 *
 	 * Precondition: node != NULL
 	 *
@@ -345,6 +401,33 @@
 				void (*insert_first)(Alarm **, Alarm *),
 				void (*insert_after)(Alarm *, Alarm *));
 
+	/*
+	 * Find the partition of the given message type(msg_type) in the given
+	 * partitions singly-linked-list. The list is accessed and/or modified
+	 * through *head_ptr which points to the head of the list.
+	 *
+	 * If there is no such partition and create is true, then a new empty
+	 * partition with an initialized mutex is created and inserted as the
+	 * new first element of the list.
+	 *
+	 * The result is stored in *partition_ptr which is set to NULL if there
+	 * is no such partition and create is false.
+	 *
+	 * Preconditions:
+	 * 		1. head_ptr != NULL
+	 * 		2. partition_ptr != NULL
+	 *
+	 * Returns:
+	 * 		1. ALLOC_PARTITION_ERR
+	 * 										if the memory allocation fails
+	 * 		2. MUTEX_INIT_ERR
+	 * 										if the mutex cannot be initialized
+	 * 		3. 0
+	 * 										on success
+	 */
+	int find_partition(Partition **head_ptr, const uint_fast32_t msg_type,
+				const bool create, Partition **partition_ptr);
+
 
 
 	/* Thread Functions */
@@ -367,4 +450,18 @@
 	 */
 	int cancel_thread(pthread_t id);
 
+	/*
+	 * Initialize the conditional variable pointed to by cond_var
+	 * so that its timed waits are measured on the monotonic clock.
+	 *
+	 * Precondition: cond_var != NULL
+	 *
+	 * Returns:
+	 * 		1. COND_VAR_INIT_ERR
+	 * 										if it cannot be initialized
+	 * 		2. 0
+	 * 										on success
+	 */
+	int init_monotonic_cond_var(pthread_cond_t *cond_var);
+
 #endif
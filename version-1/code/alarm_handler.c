@@ -20,7 +20,7 @@
 /*
  * The alarm handler thread routine.
  *
- * Precondition: arg can be safely casted into (uint_fast32_t *).
+ * Precondition: arg can be safely casted into (Thread *).
  *
  * Returns: arg
  */
@@ -30,8 +30,12 @@ void * alarm_handler(void *arg) {
 
 
 
+	/* The thread node which the main thread has created this thread for. */
+	Thread *thread = (Thread *) arg;
 	/* The message type that this thread should handle. */
-	const uint_fast32_t msg_type = *((uint_fast32_t *) arg);
+	const uint_fast32_t msg_type = thread->msg_type;
+	/* The partition of the message type that this thread should handle. */
+	Partition *partition = thread->partition;
 
 	/*
 	 * Pointer to the head of the local alarms list
@@ -44,12 +48,11 @@ void * alarm_handler(void *arg) {
 
 
 	/*
-	 * Stores the current amount of time passed since
-	 * the last time the thread updated its own local
-	 * alarms list. Each thread will update its list
-	 * after ALARM_THREAD_UPDATE_PERIOD many seconds.
+	 * The absolute time(on the monotonic clock) of the next second of
+	 * this thread's clock(time_since_create) at which it prints its due
+	 * alarms, which is the timeout of waiting on its wakeup_cond_var.
 	 */
-	uint_fast64_t time_since_update = 0;
+	struct timespec timeout;
 	/*
 	 * Stores the current amount of time passed from the thread's
 	 * creation since it is incremented by 1 every second. It is
@@ -83,6 +86,11 @@ void * alarm_handler(void *arg) {
 
 
 
+	/* Stores the return status of functions. */
+	int status = 0;
+
+
+
 	/* Dummy variable used when setting the cancel state of this thread. */
 	int old_state = 0;
 
@@ -96,6 +104,55 @@ void * alarm_handler(void *arg) {
 
 
 
+	/* Disable cancellation. */
+	if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+		EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+	}
+
+	/* Lock the partition's mutex. */
+	if (pthread_mutex_lock(&(partition->mutex)) != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+
+	/*
+	 * Critical Section:
+	 * Read the partition's alarms list once and update the local
+	 * alarms list which this thread is going to handle(i.e. print)
+	 * with the alarms that have been inserted before it was created.
+	 * The alarms inserted afterwards are posted to its inbox by
+	 * the main thread instead.
+	 *
+	 * All of the alarms in the partition have the message type
+	 * that this thread handles.
+	 */
+	for (curr_alarm = partition->alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+		if (!curr_alarm->is_assigned) {
+
+			/* Set the alarm's state to ASSIGNED. */
+			curr_alarm->is_assigned = true;
+
+			/*
+			 * Insert the alarm pointed to by curr_alarm into the local
+			 * alarms list in sorted order using the insert_alarm method.
+			 */
+			insert_alarm(&handle_list_head, curr_alarm, next_handled_alarm,
+						insert_first_handled_alarm, insert_after_handled_alarm);
+
+			/* Print status message informing the user of the internal state. */
+			fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
+						" has been assigned to Alarm thread with ID = %" \
+						PRIuFAST64 " at %" PRIuFAST64 ".\n", msg_type, id, now());
+		}
+	}
+
+	/* The first print is a second from now. */
+	if (clock_gettime(CLOCK_MONOTONIC, &timeout) != 0) {
+		EXIT_ERR(CLOCK_ERR_MSG, CLOCK_ERR);
+	}
+	++(timeout.tv_sec);
+
+
+
 	/*
 	 * Infinite loop to update the alarms handling list,
 	 * then actually handling(printing) the alarms.
@@ -103,108 +160,130 @@ void * alarm_handler(void *arg) {
 	 * The thread will terminate when it is cancelled by
 	 * the main thread on an appropriate type C command
 	 * or at the termination of the main thread itself.
+	 *
+	 * The partition's mutex is locked at the start of every iteration.
+	 * The thread sleeps on its wakeup_cond_var until the next second of
+	 * its clock, or without a timeout while it has no alarms, and the
+	 * main thread signals it as soon as it posts a new alarm to its inbox,
+	 * so that new alarms are assigned right away without rescanning the
+	 * partition's alarms list. The thread can only be cancelled while it
+	 * is waiting.
 	 */
 	while (true) {
-		/* Disable cancellation. */
-		if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
-			EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+		/*
+		 * Critical Section:
+		 * Move the alarms posted to this thread's inbox
+		 * to its local alarms list in sorted order.
+		 */
+		while (thread->inbox_head != NULL) {
+			/* Save the current first element. */
+			curr_alarm = thread->inbox_head;
+			/* Move to the next element. */
+			thread->inbox_head = thread->inbox_head->link_handle;
+			/* Detach the element saved in curr_alarm. */
+			curr_alarm->link_handle = NULL;
+
+			/* The alarm has already been set to ASSIGNED by the main thread. */
+			insert_alarm(&handle_list_head, curr_alarm, next_handled_alarm,
+						insert_first_handled_alarm, insert_after_handled_alarm);
+
+			/* Print status message informing the user of the internal state. */
+			fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
+						" has been assigned to Alarm thread with ID = %" \
+						PRIuFAST64 " at %" PRIuFAST64 ".\n", msg_type, id, now());
 		}
 
-		/* Lock the mutex. */
-		if (pthread_mutex_lock(&mutex) != 0) {
-			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		/*
+		 * The thread may be cancelled by the main thread while it is
+		 * waiting on its wakeup_cond_var, in which case it re-acquires
+		 * the partition's mutex before its cleanup routines are executed.
+		 * Therefore, set up a cleanup routine which unlocks it again.
+		 */
+		pthread_cleanup_push(cleanup_alarm_handler_mutex, (void *) (&(partition->mutex)));
+
+		/* Enable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
 		}
 
 		/*
 		 * Critical Section:
-		 * Read the global alarms list and update
-		 * the local alarms list which this thread
-		 * is going to handle(i.e. print).
+		 * Sleep until the next second or until new alarms are posted.
+		 *
+		 * Mesa-style implies while loop. Hoare-style implies if statement.
 		 */
-		for (curr_alarm = alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
-			if ((!curr_alarm->is_assigned) &&
-				(curr_alarm->msg_type == msg_type)) {
-
-				/* Set the alarm's state to ASSIGNED. */
-				curr_alarm->is_assigned = true;
-
-				/*
-				 * Insert the alarm pointed to by curr_alarm into the local
-				 * alarms list in sorted order using the insert_alarm method.
-				 */
-				insert_alarm(&handle_list_head, curr_alarm, next_handled_alarm,
-							insert_first_handled_alarm, insert_after_handled_alarm);
+		status = 0;
+		if (handle_list_head == NULL) {
+			while (thread->inbox_head == NULL) {
+				status = pthread_cond_wait(&(thread->wakeup_cond_var), &(partition->mutex));
+				if (status != 0) {
+					EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
+				}
+			} /* (thread->inbox_head != NULL) */
 
-				/* Print status message informing the user of the internal state. */
-				fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
-							" has been assigned to Alarm thread with ID = %" \
-							PRIuFAST64 " at %" PRIuFAST64 ".\n", msg_type, id, now());
-			} else if (curr_alarm->msg_type > msg_type) {
-				/*
-				 * The alarms list is sorted by message types first
-				 * therefore if the current alarm that we are looking at,
-				 * has a larger message type than the one we are looking
-				 * for, then it is simply not possible to find any more
-				 * alarms that we have to handle.
-				 */
-				break;
+			/* The first print of the new alarms is a second from now. */
+			if (clock_gettime(CLOCK_MONOTONIC, &timeout) != 0) {
+				EXIT_ERR(CLOCK_ERR_MSG, CLOCK_ERR);
 			}
+			++(timeout.tv_sec);
+		} else { /* (handle_list_head != NULL) */
+			while ((thread->inbox_head == NULL) && (status != ETIMEDOUT)) {
+				status = pthread_cond_timedwait(&(thread->wakeup_cond_var), &(partition->mutex), &timeout);
+				if ((status != 0) && (status != ETIMEDOUT)) {
+					EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
+				}
+			} /* (thread->inbox_head != NULL) || (status == ETIMEDOUT) */
 		}
 
-		/* Unlock the mutex. */
-		if (pthread_mutex_unlock(&mutex) != 0) {
-			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		/* Disable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
 		}
 
-		/* Enable cancellation. */
-		if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
-			EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
-		}
+		/* The partition's mutex remains locked. */
+		pthread_cleanup_pop(0);
+
+		/* Assign the posted alarms if the next second has not been reached. */
+		if (status != ETIMEDOUT) { continue; }
 
-		/* Check if there are any pending cancellation requests. */
-		pthread_testcancel(); /* pthread_testcancel() never fails. */
 
 
+		/* Advance this thread's clock by a second. */
+		++time_since_create; ++(timeout.tv_sec);
+
+		/* Unlock the partition's mutex. */
+		if (pthread_mutex_unlock(&(partition->mutex)) != 0) {
+			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
 
 		/*
-		 * If no alarms have been selected then just yield the CPU
-		 * to another thread that has been readied for execution.
+		 * Loop over all assigned alarms and print the appropriate ones.
 		 *
-		 * If any alarms have been selected then loop to print all
-		 * of the assigned alarms' messages until the printing period
-		 * is reached and then yield the CPU to another thread that
-		 * has been readied for execution.
+		 * The local alarms list is only modified by this thread and its
+		 * alarms are only freed by the main thread after it has cancelled
+		 * this thread, so the partition's mutex is not needed for printing them.
 		 */
-		if (handle_list_head != NULL) {
-			/* (handle_list_head != NULL) implies that the list is NOT empty. */
-			for (time_since_update = 0; time_since_update != ALARM_THREAD_UPDATE_PERIOD; /* Update inside. */) {
-				sleep(1); /* Sleep for 1 second. */
-				++time_since_create; ++time_since_update;
-
-				/* Loop over all assigned alarms and print the appropriate ones. */
-				for (curr_alarm = handle_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link_handle) {
-					/*
-					 * If the current alarm that we are looking at, has a wait time
-					 * that is a divisor of time_since_create, then it means that it
-					 * should be printed. The reason is that time_since_create is
-					 * incremented by 1 every second therefore in the given situation,
-					 * it means that the proper amount of time(the alarm's wait_time
-					 * seconds) has passed since the last time the alarm's message was
-					 * printed.
-					 */
-					if ((time_since_create % curr_alarm->wait_time) == 0) {
-						fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
-									" being printed by Alarm thread with ID = %" PRIuFAST64 \
-									" at %" PRIuFAST64 ".\nAlarm message: |%s|\n",
-									msg_type, id, now(), curr_alarm->msg);
-					}
-				}
+		for (curr_alarm = handle_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link_handle) {
+			/*
+			 * If the current alarm that we are looking at, has a wait time
+			 * that is a divisor of time_since_create, then it means that it
+			 * should be printed. The reason is that time_since_create is
+			 * incremented by 1 every second therefore in the given situation,
+			 * it means that the proper amount of time(the alarm's wait_time
+			 * seconds) has passed since the last time the alarm's message was
+			 * printed.
+			 */
+			if ((time_since_create % curr_alarm->wait_time) == 0) {
+				fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
+							" being printed by Alarm thread with ID = %" PRIuFAST64 \
+							" at %" PRIuFAST64 ".\nAlarm message: |%s|\n",
+							msg_type, id, now(), curr_alarm->msg);
 			}
 		}
 
-		/* In the Linux implementation, sched_yield() always succeeds. */
-		if (sched_yield() != 0) {
-			EXIT_ERR(CPU_YIELD_ERR_MSG, CPU_YIELD_ERR);
+		/* Lock the partition's mutex. */
+		if (pthread_mutex_lock(&(partition->mutex)) != 0) {
+			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
 		}
 	}
 
@@ -248,10 +327,11 @@ void cleanup_alarm_handler(void *arg) {
 	Alarm *curr_alarm = NULL;
 
 	/*
-	 * No need to lock mutex since the link_handle attribute
-	 * is indeed part of the global shared data and so different
-	 * alarm handler threads can access it but based on the
-	 * implementation, they will never access it. This means that
+	 * No need to lock the partition's mutex since the link_handle
+	 * attribute is indeed part of the partition's shared data and
+	 * so other alarm handler threads of the same message type can
+	 * access it but based on the implementation, they will never
+	 * access it. This means that
 	 * the shared data is disjoint and as such it is unnecessary
 	 * to lock it.
 	 *
@@ -275,3 +355,17 @@ void cleanup_alarm_handler(void *arg) {
 		curr_alarm->link_handle = NULL;
 	}
 }
+
+/*
+ * The alarm handler thread cleanup routine used while it is
+ * waiting on its conditional variable which unlocks its partition's mutex.
+ *
+ * Precondition: arg can be safely casted into (pthread_mutex_t *)
+ * which points to a mutex that is locked by the caller.
+ */
+void cleanup_alarm_handler_mutex(void *arg) {
+	/* Unlock the mutex. */
+	if (pthread_mutex_unlock((pthread_mutex_t *) arg) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+}
@@ -32,10 +32,12 @@ void cleanup_main(void *arg) {
 
 
 
-	/* Alarm pointer used for iterating over the alarms list. */
+	/* Alarm pointer used for iterating over the alarms lists. */
 	Alarm *curr_alarm = NULL;
-	/* Thread pointer used for iterating over the threads list. */
+	/* Thread pointer used for iterating over the threads lists. */
 	Thread *curr_thread = NULL;
+	/* Partition pointer used for iterating over the partitions list. */
+	Partition *curr_partition = NULL;
 
 
 
@@ -58,6 +60,8 @@ void cleanup_main(void *arg) {
 		(data.err.val == THREAD_CANCEL_ERR) ||
 		(data.err.val == THREAD_JOIN_ERR) ||
 		(data.err.val == THREAD_CANCEL_RETVAL_ERR) ||
+		(data.err.val == COND_VAR_SIGNAL_ERR) ||
+		(data.err.val == COND_VAR_DESTROY_ERR) ||
 		(data.err.val == CANCELLATION_ENABLE_ERR) ||
 		(data.err.val == CANCELLATION_DISABLE_ERR)) {
 
@@ -66,7 +70,7 @@ void cleanup_main(void *arg) {
 		 * the cleanup would not be possible since
 		 * it would require to perform some number
 		 * of the already failed operations such as:
-		 * cancelling threads
+		 * cancelling threads(or waking them up)
 		 */
 		data.err.linenum = __LINE__;
 		exit_main(data);
@@ -74,67 +78,85 @@ void cleanup_main(void *arg) {
 
 
 
-	/* Free memory allocated to the (local) threads list. */
-	while (data.thread_list_head != NULL) {
+	/* Free memory allocated to the partitions list. */
+	while (data.partition_list_head != NULL) {
 		/* Save the current first element. */
-		curr_thread = data.thread_list_head;
+		curr_partition = data.partition_list_head;
 		/* Move to the next element. */
-		data.thread_list_head = data.thread_list_head->link;
-
-		/* Attempt to cancel the thread. */
-		status = cancel_thread(curr_thread->id);
-		if (status != 0) {
-			data.err.linenum = __LINE__;
-			data.err.val = status;
-			if (status == THREAD_JOIN_ERR) {
-				data.err.msg = THREAD_JOIN_ERR_MSG;
-			} else if (status == THREAD_CANCEL_ERR) {
-				data.err.msg = THREAD_CANCEL_ERR_MSG;
-			} else { /* (status == THREAD_CANCEL_RETVAL_ERR) */
-				data.err.msg = THREAD_CANCEL_RETVAL_ERR_MSG;
+		data.partition_list_head = data.partition_list_head->link;
+
+		/* Free memory allocated to the partition's threads list. */
+		while (curr_partition->thread_list_head != NULL) {
+			/* Save the current first element. */
+			curr_thread = curr_partition->thread_list_head;
+			/* Move to the next element. */
+			curr_partition->thread_list_head = curr_partition->thread_list_head->link;
+
+			/* Attempt to cancel the thread. */
+			status = cancel_thread(curr_thread->id);
+			if (status != 0) {
+				data.err.linenum = __LINE__;
+				data.err.val = status;
+				if (status == THREAD_JOIN_ERR) {
+					data.err.msg = THREAD_JOIN_ERR_MSG;
+				} else if (status == THREAD_CANCEL_ERR) {
+					data.err.msg = THREAD_CANCEL_ERR_MSG;
+				} else { /* (status == THREAD_CANCEL_RETVAL_ERR) */
+					data.err.msg = THREAD_CANCEL_RETVAL_ERR_MSG;
+				}
+				exit_main(data);
 			}
-			exit_main(data);
-		}
 
-		/* Detach and free the element saved in curr_thread. */
-		curr_thread->link = NULL;
-		free(curr_thread);
-	}
-
-	/*
-	 * No need to lock the mutex since all other threads
-	 * have been cancelled and as such there is no need
-	 * to create synchronization.
-	 */
+			/* Destroy the thread's conditional variable. */
+			status = pthread_cond_destroy(&(curr_thread->wakeup_cond_var));
+			if (status != 0) {
+				data.err.linenum = __LINE__;
+				data.err.val = COND_VAR_DESTROY_ERR; data.err.msg = COND_VAR_DESTROY_ERR_MSG;
+				exit_main(data);
+			}
 
-	/* Free memory allocated to the (global) alarms list. */
-	while (alarm_list_head != NULL) {
-		/* Save the current first element. */
-		curr_alarm = alarm_list_head;
-		/* Move to the next element. */
-		alarm_list_head = alarm_list_head->link;
+			/* Detach and free the element saved in curr_thread. */
+			curr_thread->link = NULL;
+			free(curr_thread);
+		}
 
 		/*
-		 * link_handle attributes have been set to NULL
-		 * by the alarm handler thread cleanup routine
-		 * therefore we only have to worry about the link
-		 * attribute which connects nodes in the global
-		 * alarms list.
+		 * No need to lock the partition's mutex since all of
+		 * its alarm handler threads have been cancelled and
+		 * as such there is no need to create synchronization.
 		 */
 
-		/* Detach and free the element saved in curr_alarm. */
-		curr_alarm->link = NULL;
-		free(curr_alarm);
-	}
-
+		/* Free memory allocated to the partition's alarms list. */
+		while (curr_partition->alarm_list_head != NULL) {
+			/* Save the current first element. */
+			curr_alarm = curr_partition->alarm_list_head;
+			/* Move to the next element. */
+			curr_partition->alarm_list_head = curr_partition->alarm_list_head->link;
+
+			/*
+			 * link_handle attributes connect the local alarms
+			 * lists and inboxes of the cancelled alarm handler
+			 * threads which no longer exist therefore we only
+			 * have to worry about the link attribute which
+			 * connects nodes in the partition's alarms list.
+			 */
+
+			/* Detach and free the element saved in curr_alarm. */
+			curr_alarm->link = NULL;
+			free(curr_alarm);
+		}
 
+		/* Destroy the partition's mutex. */
+		status = pthread_mutex_destroy(&(curr_partition->mutex));
+		if (status != 0) {
+			data.err.linenum = __LINE__;
+			data.err.val = MUTEX_DESTROY_ERR; data.err.msg = MUTEX_DESTROY_ERR_MSG;
+			exit_main(data);
+		}
 
-	/* Destroy the mutex. */
-	status = pthread_mutex_destroy(&mutex);
-	if (status != 0) {
-		data.err.linenum = __LINE__;
-		data.err.val = MUTEX_DESTROY_ERR; data.err.msg = MUTEX_DESTROY_ERR_MSG;
-		exit_main(data);
+		/* Detach and free the element saved in curr_partition. */
+		curr_partition->link = NULL;
+		free(curr_partition);
 	}
 
 
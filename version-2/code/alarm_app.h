@@ -24,7 +24,12 @@
 
 	#include "alarm_def.h"
 	#include <semaphore.h>
-	#include <sched.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <fcntl.h>
+	#include <sys/resource.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 
 
 
@@ -64,6 +69,223 @@
 	 */
 	#define APP_LOG_FILE "App_Log.txt"
 
+	/*
+	 * Command server socket name. If the macro is defined, then other
+	 * processes can connect to this Unix domain socket and send commands
+	 * (one per line) in the same formats as the ones entered at the prompt.
+	 * Otherwise, commands are only accepted from the standard input
+	 * stream(stdin). To keep everything working perfectly, also make the
+	 * same change in the Makefile by changing the SOCK variable value.
+	 */
+	/* #define CMD_SERVER_SOCKET "Alarm_App.sock" */
+
+	/*
+	 * Shared alarm table name. If the macro is defined, then the alarms are
+	 * also stored in this named shared memory segment(see shm_open) as records
+	 * which are linked through their offsets from the start of the segment and
+	 * locked through a process shared semaphore, so that other processes(e.g.,
+	 * one firing the alarms) can map the segment and read the alarms without
+	 * copying them while the command handler threads keep it up to date. A
+	 * process which starts while the segment already exists attaches to it and
+	 * restores its alarms without parsing a single command. Only a single
+	 * instance of the application may use the segment at once(it is locked
+	 * through fcntl) and the records of a segment which has not been closed
+	 * cleanly(e.g., after a crash) are verified before it is attached to. To
+	 * keep everything working perfectly, also make the same change in the
+	 * Makefile by changing the TABLE variable value.
+	 *
+	 * The table has room for ALARM_TABLE_CAPACITY alarms(the alarms which do
+	 * not fit are only kept in this process) and its records are found by
+	 * their message numbers through ALARM_TABLE_BUCKETS hash chains. A segment
+	 * whose header does not match them(or the record layout) is reinitialized.
+	 */
+	/* #define ALARM_TABLE_SHM "/Alarm_App.table" */
+	#define ALARM_TABLE_CAPACITY 65536
+	#define ALARM_TABLE_BUCKETS 16384
+	#define ALARM_TABLE_MAGIC 0x414C524DUL
+	#define ALARM_TABLE_VERSION 2UL
+
+	/*
+	 * Persistent alarm store name. If the macro is defined(along with
+	 * ALARM_TABLE_SHM), then the shared alarm table is stored in this file
+	 * instead of the shared memory segment so that its alarms also survive
+	 * a reboot. Starting up only maps the file and validates its header, as
+	 * its records are only read(paged in) while its alarms are restored, and
+	 * it is locked and recovered exactly like the segment. To keep everything
+	 * working perfectly, also make the same change in the Makefile by changing
+	 * the STORE variable value.
+	 */
+	/* #define ALARM_TABLE_FILE "Alarm_App.store" */
+
+	/* The name of the shared alarm table's segment or file. */
+	#ifdef ALARM_TABLE_FILE
+		#define ALARM_TABLE_NAME ALARM_TABLE_FILE
+	#else
+		#define ALARM_TABLE_NAME ALARM_TABLE_SHM
+	#endif
+
+	/* Pointer to the record at the given offset(never 0) from the start of the shared alarm table. */
+	#define ALARM_RECORD(offset) ((AlarmRecord *) ((char *) alarm_table + (offset)))
+
+	/*
+	 * The maximum length of a command sent to the command server and the
+	 * size of the buffer of acknowledgements waiting to be sent to each
+	 * client. Clients sending longer commands are disconnected.
+	 */
+	#define CMD_SERVER_MAX_LINE 1024
+	#define CMD_SERVER_MAX_ACKS 1024
+
+	/* The maximum number of events handled per wakeup of the command server. */
+	#define CMD_SERVER_MAX_EVENTS 64
+
+	/*
+	 * The maximum length of the optional "Request(ID) " prefix of a
+	 * command and of a completion record sent to a client, which is
+	 * "DONE ID Completion Latency\n" where the two numbers have at
+	 * most 20 digits each.
+	 */
+	#define CMD_REQUEST_PREFIX_MAX_LEN 31
+	#define CMD_DONE_MAX_LEN 63
+
+	/*
+	 * The clock that the submission and completion times of commands are
+	 * read from. CLOCK_MONOTONIC keeps latencies exact when the system time
+	 * is changed; CLOCK_MONOTONIC_COARSE and CLOCK_REALTIME_COARSE only read
+	 * the time cached at the last kernel tick, which is cheaper but rounds
+	 * latencies to the tick(usually 1 to 4 milliseconds).
+	 */
+	#define CMD_LATENCY_CLOCK CLOCK_MONOTONIC
+
+	/*
+	 * The number of nanoseconds of CMD_LATENCY_CLOCK per unit of the
+	 * submission and completion times(and latencies) of commands, which
+	 * are in microseconds.
+	 */
+	#define CMD_LATENCY_UNIT 1000
+
+	/* Current time of CMD_LATENCY_CLOCK in units of CMD_LATENCY_UNIT(0 if it cannot be read). */
+	#define CMD_LATENCY_NOW() (now_nsec(CMD_LATENCY_CLOCK) / CMD_LATENCY_UNIT)
+
+	/*
+	 * Latency of a command from its submission time to its completion time,
+	 * which is reported as 0 if either of them could not be read.
+	 */
+	#define CMD_LATENCY(submit_time, done_time) \
+				((((submit_time) == 0) || ((done_time) < (submit_time))) ? 0 : \
+				((done_time) - (submit_time)))
+
+	/*
+	 * The clock thread(see clock_ticker) reads APP_CLOCK once every
+	 * APP_CLOCK_TICK nanoseconds and publishes its time, so that every
+	 * timestamp of the log messages(see now) is only a single atomic load
+	 * of the published time instead of a call into the C library. Timestamps
+	 * are thereby at most one tick old. Comment out APP_CLOCK_TICK to have
+	 * no clock thread, in which case now reads time(NULL) at every call.
+	 *
+	 * CLOCK_REALTIME_COARSE counts since the UNIX Epoch like time(NULL) and
+	 * only reads the time cached at the last kernel tick. CLOCK_REALTIME
+	 * reads it with nanosecond precision. CLOCK_MONOTONIC(_COARSE) is not
+	 * affected by changes to the system time but counts since an unspecified
+	 * point(usually the boot), so its timestamps cannot be compared with the
+	 * ones of the alarms restored from a persistent alarm table.
+	 */
+	#define APP_CLOCK CLOCK_REALTIME_COARSE
+	#define APP_CLOCK_TICK 10000000
+
+	/*
+	 * The number of independently locked partitions(shards) of the global
+	 * alarms list. Alarms are partitioned by their message types so that
+	 * every alarm handler thread only reads its own shard and a command
+	 * which affects a single message type only blocks the readers of that
+	 * shard.
+	 */
+	#define ALARM_SHARDS 8
+
+	/* The shard of the global alarms list which stores alarms of the given message type. */
+	#define ALARM_SHARD(msg_type) (&(alarm_shards[(msg_type) % ALARM_SHARDS]))
+
+	/*
+	 * The number of command handler threads(workers) which apply commands
+	 * in parallel. Every command has a key, which is the message number of
+	 * type A and C commands and the message type of type B and D commands,
+	 * and all commands with the same key are applied by the same worker in
+	 * the order in which they were inserted.
+	 */
+	#define CMD_WORKERS 4
+
+	/* The index of the command handler thread which applies commands with the given key. */
+	#define CMD_WORKER(key) ((size_t) ((key) % CMD_WORKERS))
+
+	/*
+	 * The attributes of the alarm handler threads and of the command
+	 * threads(command handler and command server threads), see init_thread_attr.
+	 *
+	 * The stack sizes are in bytes and 0 keeps the default stack size(usually
+	 * 8 MiB of reserved address space per thread). Alarm handler threads barely
+	 * use their stacks, so a small stack lets many more message types be handled.
+	 * The CPU masks have bit i set for every CPU i that the threads may run on
+	 * and 0 allows all of them. The scheduling policies(SCHED_OTHER, or else
+	 * SCHED_FIFO or SCHED_RR which require privileges) are explicitly set for
+	 * the threads(with the minimum priority of the policy) instead of being
+	 * inherited from the main thread.
+	 */
+	#define ALARM_THREAD_STACK_SIZE 65536
+	#define ALARM_THREAD_CPU_MASK 0UL
+	#define ALARM_THREAD_SCHED_POLICY SCHED_OTHER
+	#define CMD_THREAD_STACK_SIZE 262144
+	#define CMD_THREAD_CPU_MASK 0UL
+	#define CMD_THREAD_SCHED_POLICY SCHED_OTHER
+
+	/*
+	 * An alarm handler thread which has no alarms left lingers for
+	 * ALARM_HANDLER_LINGER seconds, during which the alarms of its message
+	 * type which are inserted are still posted to it, before it retires.
+	 * A retired thread is then parked in the pool of alarm handler threads
+	 * (unless there are already ALARM_HANDLER_POOL threads parked in it) and
+	 * reused for the next type B command instead of creating a new thread.
+	 * Otherwise, it terminates. Both can be set to 0 to disable them.
+	 */
+	#define ALARM_HANDLER_LINGER 5
+	#define ALARM_HANDLER_POOL 4
+
+	/*
+	 * The capacity of the global commands list, i.e., the maximum number of
+	 * commands(where every range of a type C command counts as one) which may
+	 * be waiting in it to be taken by the command handler threads, so that
+	 * the memory and the latency of the commands stay bounded when they are
+	 * submitted faster than they can be applied. 0 leaves the list unbounded.
+	 *
+	 * CMD_QUEUE_POLICY is what happens to a new command while the list is full:
+	 * 		1. CMD_QUEUE_BLOCK	the parser waits until the command handler
+	 * 							threads have taken commands from the list.
+	 * 		2. CMD_QUEUE_REJECT	the new command is rejected.
+	 * 		3. CMD_QUEUE_SHED	the oldest waiting type A commands(the lowest
+	 * 							priority since cancelling alarms frees resources
+	 * 							and type B commands are only applied to existing
+	 * 							alarms) are shed to make room for the new command,
+	 * 							which is only rejected if there are none left.
+	 */
+	#define CMD_QUEUE_CAPACITY 4096
+	#define CMD_QUEUE_BLOCK 0
+	#define CMD_QUEUE_REJECT 1
+	#define CMD_QUEUE_SHED 2
+	#define CMD_QUEUE_POLICY CMD_QUEUE_BLOCK
+
+	/*
+	 * Terminate the caller of process_cmd on a fatal error. The main thread
+	 * (data_ptr != NULL) is cleaned up while for any other thread, the process
+	 * is terminated instead.
+	 */
+	#define EXIT_CMD(data_ptr, err_msg, err_val) do { \
+			if ((data_ptr) != NULL) { \
+				(data_ptr)->err.filename = __FILE__; (data_ptr)->err.linenum = __LINE__; \
+				(data_ptr)->err.val = (err_val); (data_ptr)->err.msg = (err_msg); \
+				pthread_exit(data_ptr); \
+			} else { /* ((data_ptr) == NULL) */ \
+				EXIT_ERR(err_msg, err_val); \
+			} \
+		} while (false)
+
 
 
 	/* Type Definitions */
@@ -74,10 +296,50 @@
 		APP_LOG_FILE_OPEN_FAIL = 0,
 		ALARM_RW_BIN_SEM_INIT_FAIL = 1,
 		ALARM_R_BIN_SEM_INIT_FAIL = 2,
-		CMD_THREAD_CREATE_FAIL = 3,
-		STD_CLEANUP = 4
+		ALARM_HANDLER_MUTEX_INIT_FAIL = 3,
+		ALARM_TABLE_OPEN_FAIL = 4,
+		ALARM_THREAD_ATTR_INIT_FAIL = 5,
+		CMD_THREAD_ATTR_INIT_FAIL = 6,
+		CLOCK_THREAD_CREATE_FAIL = 7,
+		CMD_THREAD_CREATE_FAIL = 8,
+		CMD_SERVER_CREATE_FAIL = 9,
+		STD_CLEANUP = 10
 	} MCMode;
 
+	/* Enumeration of all possible results of processing a command. */
+	typedef enum CmdResult {
+		CMD_INVALID = 0,
+		CMD_ACCEPTED = 1,
+		CMD_IGNORED = 2,
+		CMD_REJECTED = 3
+	} CResult;
+
+	/* Enumeration of all possible completions of a command request. */
+	typedef enum CmdCompletion {
+		CMD_DONE_INVALID = 0,
+		CMD_DONE_APPLIED = 1,
+		CMD_DONE_IGNORED = 2,
+		CMD_DONE_REPLACED = 3,
+		CMD_DONE_REJECTED = 4
+	} CCompletion;
+
+	/*
+	 * Structure encapsulating each completion record of a request
+	 * submitted through the command server as a node in a
+	 * singly-linked-list.
+	 */
+	typedef struct CmdDoneNode {
+		/* Pointer to the next completion record node. */
+		struct CmdDoneNode		*link;
+
+		/* The completed request. */
+		CmdRequest				req;
+		/* How the request has been completed. */
+		CCompletion				completion;
+		/* The time of CMD_LATENCY_CLOCK(see CMD_LATENCY_NOW) when the request was completed. */
+		uint_fast64_t			done_time;
+	} CmdDone;
+
 	/*
 	 * Structure encapsulating all of the local variables that
 	 * the main thread has used which need to be freed on its
@@ -96,13 +358,215 @@
 		 */
 		bool					separate_log_file;
 
-		/* The ID of the command handler thread. */
-		pthread_t				cmd_thread_tid;
+		/*
+		 * The number of shards of the global alarms list
+		 * whose semaphores have both been initialized.
+		 */
+		size_t					shard_count;
+
+		/* The ID of the clock thread. */
+		pthread_t				clock_tid;
+		/* The number of command handler threads which have been created. */
+		size_t					worker_count;
+		/* The ID of the command server thread. */
+		pthread_t				cmd_server_tid;
 
 		/* Last read line of input. */
 		char					*line;
 	} MLData;
 
+	/*
+	 * Structure encapsulating each shard of the global alarms list
+	 * which is a separate alarms list(skip list) with its own
+	 * reader-writer lock.
+	 */
+	typedef struct AlarmShardStruct {
+		/* Reader-Writer Semaphore. */
+		sem_t					alarm_rw_bin_sem;
+		/* Reader Semaphore. */
+		sem_t					alarm_r_bin_sem;
+		/* The number of readers of the shard. */
+		uint_fast64_t			reader_count;
+
+		/* Pointer to the head of the shard's alarms list. */
+		Alarm					*alarm_list_head;
+		/* Pointers to the heads of the express lanes of the shard's alarms list. */
+		Alarm					*alarm_express_head[ALARM_SKIP_LIST_LANES - 1];
+
+		/*
+		 * Pointer to the head of the list(through the shard_link attribute)
+		 * of the type B command nodes of the live alarm handler threads of
+		 * the shard's message types, which the command handler threads post
+		 * new alarms to(see post_alarm). It is only accessed while
+		 * handler_mutex is locked.
+		 */
+		CmdB					*handler_list_head;
+		/*
+		 * The mutex used to lock access to handler_list_head. It is locked
+		 * before alarm_cancel_mutex whenever both of them are held.
+		 */
+		pthread_mutex_t			handler_mutex;
+	} AlarmShard;
+
+	/*
+	 * Structure encapsulating each command handler thread(worker)
+	 * and the commands that it has taken from the global commands
+	 * list but not yet applied.
+	 */
+	typedef struct CmdWorkerStruct {
+		/* The thread's identifier(ID) returned by pthread_create(). */
+		pthread_t				id;
+		/* The index of the worker in cmd_workers. */
+		size_t					index;
+
+		/*
+		 * The number of commands which have been inserted for the worker
+		 * since it last took its commands. It is only accessed while
+		 * new_cmd_insert_mutex is locked.
+		 */
+		uint_fast64_t			pending;
+		/*
+		 * The conditional variable that only this worker waits on(with
+		 * new_cmd_insert_mutex locked) until its pending counter is not 0.
+		 */
+		pthread_cond_t			new_cmd_insert_cond_var;
+
+		/*
+		 * Pointers to the heads and tails of the lists of the type A, C,
+		 * and D commands that the worker has taken. Its type A commands
+		 * are only removed while cmd_mutex is locked since other threads
+		 * also read them(see find_pending_cmda) until they are applied.
+		 */
+		CmdA					*cmda_list_head;
+		CmdA					*cmda_list_tail;
+		CmdC					*cmdc_list_head;
+		CmdC					*cmdc_list_tail;
+		CmdD					*cmdd_list_head;
+		CmdD					*cmdd_list_tail;
+
+		/*
+		 * The number of unprocessed type B commands of the worker that
+		 * it has taken, which are left in the global commands list.
+		 */
+		size_t					cmdb_count;
+
+		/* The number of commands which have been applied by the worker. */
+		uint_fast64_t			applied;
+	} CmdWorker;
+
+	/*
+	 * Structure encapsulating each client of the command server
+	 * as a node in a singly-linked-list.
+	 */
+	typedef struct CmdClientNode {
+		/* Pointer to the next client node in the command server's clients list. */
+		struct CmdClientNode	*link;
+
+		/* The client's connected socket. */
+		int						fd;
+		/* The number of the client's connection(starting from 1). */
+		uint_fast64_t			conn_num;
+		/* The events that the command server is waiting for on fd. */
+		uint32_t				events;
+		/* Has the client closed its connection(or been disconnected)? */
+		bool					is_closed;
+
+		/*
+		 * The commands that have been received from the client but not
+		 * yet processed(the last of which may be incomplete) and the
+		 * acknowledgements that have not yet been sent to the client.
+		 * The first in_size and out_size chars of each are in use.
+		 */
+		char					in[CMD_SERVER_MAX_LINE + 1];
+		size_t					in_size;
+		char					out[CMD_SERVER_MAX_ACKS];
+		size_t					out_size;
+
+		/*
+		 * Pointers to the head and tail of the client's completion
+		 * records which have not yet been moved into out.
+		 */
+		CmdDone					*done_list_head;
+		CmdDone					*done_list_tail;
+	} CmdClient;
+
+	/*
+	 * Structure encapsulating all of the resources that the
+	 * command server thread has acquired which need to be
+	 * released on its cancellation.
+	 */
+	typedef struct CmdServerData {
+		/* The name of the socket that the server listens on. */
+		const char				*path;
+
+		/* The listening socket and the epoll instance(-1 if not yet created). */
+		int						listen_fd;
+		int						epoll_fd;
+		/*
+		 * The read end of the pipe which is written to when new completion
+		 * records are inserted into an empty completion records list(-1 if
+		 * not yet created). Its write end is cmd_done_write_fd.
+		 */
+		int						done_fd;
+
+		/* The number of connections accepted so far. */
+		uint_fast64_t			conn_count;
+
+		/* Pointer to the head of the clients list. */
+		CmdClient				*client_list_head;
+	} CmdServer;
+
+	/*
+	 * Structure encapsulating each alarm stored in the shared alarm table
+	 * as a node in a singly-linked-list. Since the table is mapped at a
+	 * different address in every process, the nodes are linked through
+	 * their offsets from the start of the table instead of pointers and
+	 * all of the attributes have the same size in every process.
+	 */
+	typedef struct AlarmRecordStruct {
+		/*
+		 * Offset of the next record in the hash chain of the record's
+		 * message number or in the free records list and 0 if none.
+		 */
+		uint64_t				next;
+
+		/* The alarm's attributes(see Alarm). */
+		uint64_t				wait_time;
+		uint64_t				msg_type;
+		uint64_t				msg_num;
+		char					msg[MAX_MSG_LEN + 1];
+	} AlarmRecord;
+
+	/*
+	 * Structure encapsulating the header of the shared alarm table which
+	 * is followed by its capacity records. Every other attribute than the
+	 * ones describing the layout of the table(which are only written once
+	 * before magic is) is only accessed while its lock is held.
+	 */
+	typedef struct AlarmTableStruct {
+		/* ALARM_TABLE_MAGIC once the table has been initialized. */
+		uint64_t				magic;
+		/* The layout of the table which every process validates. */
+		uint64_t				version;
+		uint64_t				size;
+		uint64_t				capacity;
+		uint64_t				buckets;
+		uint64_t				record_size;
+
+		/* Process shared binary semaphore(mutex) locking the table. */
+		sem_t					lock;
+
+		/* Has the last process using the table closed it(1) or not(0)? */
+		uint64_t				is_clean;
+
+		/* The number of records in use. */
+		uint64_t				count;
+		/* Offset of the first record of the free records list and 0 if none. */
+		uint64_t				free_head;
+		/* Offsets of the first records of the hash chains and 0 if none. */
+		uint64_t				bucket[ALARM_TABLE_BUCKETS];
+	} AlarmTable;
+
 
 
 	/* Variable Definitions */
@@ -111,60 +575,100 @@
 	 * Shared data between threads:
 	 *
 	 * 1. The cmd_mutex used to lock access to the commands singly-linked-list.
-	 * 		Since there are only two writers to the list(the main and the command
-	 * 		handler threads), then a simple mutex is enough to create synchronization
-	 * 		between them.
+	 * 		Since there are only three kinds of writers to the list(the main, the
+	 * 		command server, and the command handler threads), then a simple mutex
+	 * 		is enough to create synchronization between them. The command handler
+	 * 		threads only lock it to take their commands from the list(and to
+	 * 		create or reuse alarm handler threads) and never while
+	 * 		applying type A, C or D commands.
 	 *
-	 * 2. The new_cmd_insert_mutex and new_cmd_insert_cond_var which are used when the command
+	 * 2. The new_cmd_insert_mutex and new_cmd_insert_cond_vars which are used when a command
 	 * 		handler thread needs to know when a new valid command has been entered by the user
 	 * 		and that the main thread has parsed, validated, and inserted it into the global
 	 * 		commands list. This only makes the application perform better since the command
-	 * 		handler thread will be blocked when there are no new commands to be executed since
-	 * 		it will be waiting on the new_cmd_insert_cond_var. The reason why it improves
-	 * 		performance is that the command handler thread will no longer attempt to obtain any
-	 * 		locks.
+	 * 		handler threads will be blocked when there are no new commands to be executed since
+	 * 		they will be waiting on their new_cmd_insert_cond_var. The reason why it improves
+	 * 		performance is that the command handler threads will no longer attempt to obtain any
+	 * 		locks. The pending counter of each command handler thread(worker) is incremented
+	 * 		(while new_cmd_insert_mutex is locked) whenever a command with one of its keys is
+	 * 		inserted and only its own new_cmd_insert_cond_var is then signalled, so that each
+	 * 		worker is only woken up when it has some commands of its own to apply(see
+	 * 		notify_cmd_worker).
 	 *
 	 * 3. Pointers to the head and tail of the commands singly-linked-list.
 	 * 		In the actual implementation, the list has been separated into
-	 * 		three sublists. Each sublist only stores commands of one type.
+	 * 		four sublists. Each sublist only stores commands of one type.
 	 * 		For the type B commands list, we also have an extra pointer to the
 	 * 		first unprocessed type B command to improve the command handler's
-	 * 		processing runtime.
+	 * 		processing runtime. The type A, C, and D commands that each command
+	 * 		handler thread takes are moved from these lists to its own lists.
 	 *
-	 * 4. The alarm_rw_bin_sem used to lock access to the alarms singly-linked-list.
-	 * 		This is used to lock access to the alarms list between readers and writers
-	 * 		of the list. There is only one writer which is the command handler thread
-	 * 		while all other threads are readers of the list. This includes the main and
-	 * 		all alarm handler threads.
+	 * 4. The alarm_rw_bin_sem of each shard of the alarms list used to lock access to
+	 * 		the shard between readers and writers of the shard. The writers are the
+	 * 		command handler threads, which also hold it while searching the shard since
+	 * 		there are many of them, while all other threads are readers of the shards.
+	 * 		This includes the main, the command server, and all alarm handler threads.
+	 * 		The alarms list is partitioned into ALARM_SHARDS shards by message types
+	 * 		so each alarm handler thread only ever reads its own shard and a command
+	 * 		handler thread only blocks the readers(and the other writers) of the shard
+	 * 		that it is writing to. A command handler thread never holds more than one
+	 * 		of them at once nor waits for one while holding alarm_cancel_mutex and it
+	 * 		never locks cmd_mutex while holding one of them(or alarm_cancel_mutex),
+	 * 		which is why they can never deadlock.
 	 *
-	 * 5. The alarm_r_bin_sem used to lock access to the alarms singly-linked-list.
-	 * 		This is used to lock access to the alarms list between readers of the list.
+	 * 5. The alarm_r_bin_sem of each shard used to lock access to the shard between
+	 * 		readers of the shard.
 	 *
-	 * 6. The reader_count which keeps track of how many readers are currently reading
-	 * 		the alarms singly-linked-list when the writer is inactive. If however, the
+	 * 6. The reader_count of each shard which keeps track of how many readers are
+	 * 		currently reading the shard when the writer is inactive. If however, the
 	 * 		writer is active, then the reader_count denotes the number of readers which
 	 * 		are waiting to be able to read.
 	 *
-	 * 7. Pointer to the head of the alarms singly-linked-list.
+	 * 7. Pointers to the heads of the alarms singly-linked-lists(skip lists) of the shards.
+	 * 		Message numbers are unique across all of the shards.
 	 *
-	 * 8. The alarm_cancel_mutex and alarm_cancel_cond_var which are used when the command
-	 * 		handler thread needs to know when an alarm handler thread has successfully detached
-	 * 		an alarm node from its own local list and potentially cancelled itself. This is
-	 * 		needed since the command handler thread should be able to safely perform any of
-	 * 		the following:
-	 * 			1. Replace or cancel an alarm in appropriate type A or C command.
+	 * 8. The alarm_cancel_mutex, alarm_cancel_cond_var, and wakeup eventfds which are
+	 * 		used when a command handler thread needs to know when an alarm handler thread
+	 * 		has successfully detached an alarm node from its own schedule. This is needed
+	 * 		since the command handler thread should be able to safely perform any of the
+	 * 		following:
+	 * 			1. Replace or cancel an alarm in appropriate type A, C or D command.
 	 * 			2. Free the allocated resources.
-	 * 			3. Join with the alarm handler thread if it self terminated.
+	 * 		Alarm handler threads sleep until their next due alarms by waiting on
+	 * 		their own timerfd and wakeup eventfd(without any locks held) which the
+	 * 		command handler threads write after making detach requests to them, so
+	 * 		that they can read the number of detach requests made to them(with
+	 * 		alarm_cancel_mutex locked) on every wakeup. Since the eventfd stays readable
+	 * 		until the thread reads it before reading the number of detach requests,
+	 * 		no wakeup can be lost. Only the alarm handler threads which have detach
+	 * 		requests are woken up.
+	 * 		They then detach all of their replaced or cancelled alarms and broadcast
+	 * 		alarm_cancel_cond_var before unlocking alarm_cancel_mutex. Since every
+	 * 		command handler thread holds the mutex from checking its predicate up
+	 * 		to waiting on the conditional variable, the broadcast can never be lost.
+	 * 		The detach requests which have not yet been ended are counted so that an
+	 * 		alarm handler thread never retires while a command handler thread may
+	 * 		still access its node(see end_detach_request).
+	 * 		The live alarm handler threads of each shard are instead protected by the
+	 * 		handler_mutex of the shard and alarms are posted to their inboxes without
+	 * 		any lock(see post_alarm), so a command handler thread which inserts an
+	 * 		alarm only locks alarm_cancel_mutex if it has to detach the alarm that it
+	 * 		replaces.
 	 *
 	 * 9. Application log file where all application messages are printed to.
+	 *
+	 * 10. The cmd_done_mutex used to lock access to the completion records
+	 * 		singly-linked-list and to cmd_done_write_fd. Records are inserted by
+	 * 		whichever thread completes a request of a command server client and
+	 * 		are removed by the command server thread which routes them to the
+	 * 		clients. The first record inserted into an empty list also writes to
+	 * 		cmd_done_write_fd which wakes the command server up.
 	 */
 	/* Initialize cmd_mutex. */
 	EXTERN pthread_mutex_t cmd_mutex SET(PTHREAD_MUTEX_INITIALIZER);
 
 	/* Initialize new_cmd_insert_mutex. */
 	EXTERN pthread_mutex_t new_cmd_insert_mutex SET(PTHREAD_MUTEX_INITIALIZER);
-	/* Initialize new_cmd_insert_cond_var. */
-	EXTERN pthread_cond_t new_cmd_insert_cond_var SET(PTHREAD_COND_INITIALIZER);
 
 	/* Initialize an empty type A commands list. */
 	EXTERN CmdA *cmda_list_head SET(NULL);
@@ -176,13 +680,72 @@
 	/* Initialize an empty type C commands list. */
 	EXTERN CmdC *cmdc_list_head SET(NULL);
 	EXTERN CmdC *cmdc_list_tail SET(NULL);
+	/* Initialize an empty type D commands list. */
+	EXTERN CmdD *cmdd_list_head SET(NULL);
+	EXTERN CmdD *cmdd_list_tail SET(NULL);
+
+	/*
+	 * The number of commands which have been eliminated while they were still
+	 * in the global commands list, i.e., the type A commands replaced in place
+	 * by a later type A command of the same message number, the type A commands
+	 * annihilated by a later type C command of their message numbers(see
+	 * annihilate_pending_cmda) and the ranges of type C commands which have
+	 * not been inserted since they were already requested or only cancelled
+	 * annihilated type A commands. They are only modified while cmd_mutex is
+	 * locked.
+	 */
+	EXTERN uint_fast64_t cmda_coalesced SET(0);
+	EXTERN uint_fast64_t cmda_annihilated SET(0);
+	EXTERN uint_fast64_t cmdc_coalesced SET(0);
+
+	/*
+	 * The number of commands(every range of a type C command counts as one)
+	 * waiting in the global commands list to be taken by the command handler
+	 * threads, its maximum so far(high-water mark) and the number of new
+	 * commands which have waited for room in the list, which have been rejected
+	 * and the number of commands which have been shed(see CMD_QUEUE_POLICY).
+	 * They are only accessed while cmd_mutex is locked. The parsers wait on
+	 * cmd_queue_cond_var(with cmd_mutex) which the command handler threads
+	 * broadcast after taking commands from the list.
+	 */
+	EXTERN uint_fast64_t cmd_queue_depth SET(0);
+	EXTERN uint_fast64_t cmd_queue_peak SET(0);
+	EXTERN uint_fast64_t cmd_queue_blocked SET(0);
+	EXTERN uint_fast64_t cmd_queue_rejected SET(0);
+	EXTERN uint_fast64_t cmd_queue_shed SET(0);
+	EXTERN pthread_cond_t cmd_queue_cond_var SET(PTHREAD_COND_INITIALIZER);
+
+	/*
+	 * The sequence number of the last type A, C or D command inserted
+	 * into the global commands list, which orders a type C(or D) command
+	 * after the type A commands of its ranges(or of its message type) that
+	 * other command handler threads apply(see find_prior_cmda). It is only
+	 * accessed while cmd_mutex is locked. The command handler threads
+	 * broadcast cmda_applied_cond_var(with cmd_mutex) after applying their
+	 * type A commands.
+	 */
+	EXTERN uint_fast64_t cmd_seq SET(0);
+	/*
+	 * The sequence number of the last type A command inserted(or replaced)
+	 * into the global commands list. A new type C command is only coalesced
+	 * into an existing one if no type A command has been inserted since then,
+	 * as it would otherwise skip their alarms(see cmda_seq of Alarm).
+	 */
+	EXTERN uint_fast64_t cmda_seq_last SET(0);
+	EXTERN pthread_cond_t cmda_applied_cond_var SET(PTHREAD_COND_INITIALIZER);
 
-	EXTERN sem_t alarm_rw_bin_sem; /* Reader-Writer Semaphore. */
-	EXTERN sem_t alarm_r_bin_sem; /* Reader Semaphore. */
-	EXTERN uint_fast64_t reader_count SET(0); /* Initialize reader_count. */
+	/*
+	 * The command handler threads(workers). Being zero initialized,
+	 * none of them has any pending or taken commands while their
+	 * conditional variables are initialized by main.
+	 */
+	EXTERN CmdWorker cmd_workers[CMD_WORKERS];
 
-	/* Initialize an empty alarms list. */
-	EXTERN Alarm *alarm_list_head SET(NULL);
+	/*
+	 * The shards of the alarms list. Being zero initialized, all of their
+	 * alarms lists are empty while their semaphores are initialized by main.
+	 */
+	EXTERN AlarmShard alarm_shards[ALARM_SHARDS];
 
 	/* Initialize alarm_cancel_mutex. */
 	EXTERN pthread_mutex_t alarm_cancel_mutex SET(PTHREAD_MUTEX_INITIALIZER);
@@ -192,6 +755,86 @@
 	/* Initialize the application log file. */
 	EXTERN FILE *app_log SET(NULL);
 
+	/*
+	 * The attributes that the alarm handler threads and the command threads
+	 * are created with, which are initialized by main(see init_thread_attr).
+	 */
+	EXTERN pthread_attr_t alarm_thread_attr;
+	EXTERN pthread_attr_t cmd_thread_attr;
+
+	/*
+	 * The number of alarm handler threads which have been created, the
+	 * number of them which are handling a message type(i.e., have not
+	 * retired yet) and the maximum number of them that have been doing
+	 * so at once. They are only modified while cmd_mutex is locked(see
+	 * cmd_handler and alarm_handler_retire).
+	 */
+	EXTERN uint_fast64_t alarm_threads_created SET(0);
+	EXTERN uint_fast64_t alarm_threads_running SET(0);
+	EXTERN uint_fast64_t alarm_threads_peak SET(0);
+
+	/*
+	 * The pool of parked alarm handler threads, i.e., the list(through the
+	 * link attribute) of the type B command nodes that they handled last,
+	 * and its size which is at most ALARM_HANDLER_POOL. The number of type B
+	 * commands which have reused a parked thread is alarm_threads_reused.
+	 * They are only accessed while cmd_mutex is locked. alarm_threads_cancelled
+	 * is set(while cmd_mutex is locked) once the main thread starts cancelling
+	 * the alarm handler threads, after which none of them retires anymore.
+	 */
+	EXTERN CmdB *alarm_pool_head SET(NULL);
+	EXTERN size_t alarm_pool_size SET(0);
+	EXTERN uint_fast64_t alarm_threads_reused SET(0);
+	EXTERN bool alarm_threads_cancelled SET(false);
+
+	/*
+	 * The number of times that a lingering alarm handler thread has resumed
+	 * handling the alarms posted to it, each of which has saved retiring the
+	 * thread and then creating(or reusing) another one. It is only modified
+	 * while alarm_cancel_mutex is locked(see alarm_handler).
+	 */
+	EXTERN uint_fast64_t alarm_threads_resumed SET(0);
+
+	/*
+	 * The number of assigned alarms which have been replaced in place by
+	 * alarms of the same message type, each of which has saved a detach
+	 * request and the wait for it(see replace_alarm). It is only modified
+	 * atomically since the command handler threads which replace alarms
+	 * in place hold the writer locks of different shards and no other lock.
+	 * It is only read by the main thread once every thread has terminated.
+	 */
+	EXTERN uint_fast64_t alarms_replaced_in_place SET(0);
+
+	/*
+	 * The number of alarms which have been replaced by alarms of another
+	 * message type and then posted straight to the inbox of the live alarm
+	 * handler thread of their new message type, i.e., migrated from one
+	 * alarm handler thread(if any) to another without ever waiting in the
+	 * alarms list for a new thread to search it. It is only modified
+	 * atomically(see cmd_handler).
+	 */
+	EXTERN uint_fast64_t alarms_migrated SET(0);
+
+	/*
+	 * The shared alarm table mapped into this process(see ALARM_TABLE_SHM),
+	 * the number of alarms restored from it when this process attached to it
+	 * and the number of alarms which did not fit into it. alarm_table_overflows
+	 * is only modified while the table is locked.
+	 */
+	EXTERN AlarmTable *alarm_table SET(NULL);
+	/* The locked file descriptor of the shared alarm table's segment(or file). */
+	EXTERN int alarm_table_fd SET(-1);
+	EXTERN uint_fast64_t alarm_table_restored SET(0);
+	EXTERN uint_fast64_t alarm_table_overflows SET(0);
+
+	/* Initialize cmd_done_mutex. */
+	EXTERN pthread_mutex_t cmd_done_mutex SET(PTHREAD_MUTEX_INITIALIZER);
+	/* Initialize an empty completion records list. */
+	EXTERN CmdDone *cmd_done_list_head SET(NULL);
+	EXTERN CmdDone *cmd_done_list_tail SET(NULL);
+	/* Initialize the write end of the command server's completion pipe. */
+	EXTERN int cmd_done_write_fd SET(-1);
+
 
 
 	/* Function Prototypes */
@@ -213,28 +856,236 @@
 
 
 	/*
-	 * Obtain a reader lock on the global
-	 * alarms list for the calling thread.
+	 * Process the command stored in line(of length len) on behalf of the
+	 * thread with the given name(thread_name) and ID. The command may start
+	 * with an optional "Request(ID) " prefix which is stripped before the
+	 * command is inserted(see insert_cmd). A completion record is emitted
+	 * for the request of every command with such a prefix: right away if
+	 * the command is not accepted, or else by the command handler thread
+	 * once it has applied the command. The records are printed to app_log
+	 * for the main thread(client == 0) or else sent to the command server's
+	 * client whose connection number is client.
+	 *
+	 * Preconditions:
+	 * 		1. line != NULL
+	 * 		2. strlen(line) == len
+	 * 		3. thread_name != NULL
+	 *
+	 * Returns: The result of insert_cmd or CMD_INVALID if the prefix is invalid
+	 */
+	EXTERN CResult process_cmd(const char *line, const size_t len, const char *thread_name,
+				const uint_fast64_t id, const uint_fast64_t client, MLData *data_ptr);
+
+	/*
+	 * Parse and validate the command stored in line(of length len) and then
+	 * insert it into the global commands list on behalf of the thread with
+	 * the given name(thread_name) and ID. Status messages are printed for the
+	 * user exactly as if the command had been entered at the prompt. The
+	 * given request(req) is attached to the inserted command so that the
+	 * command handler thread can complete it.
+	 *
+	 * The main thread passes its local data(data_ptr) so that it is cleaned
+	 * up on fatal errors while every other caller passes NULL in which case
+	 * the process is terminated instead.
+	 *
+	 * Preconditions:
+	 * 		1. line != NULL
+	 * 		2. strlen(line) == len
+	 * 		3. thread_name != NULL
+	 * 		4. req != NULL
+	 *
+	 * Returns:
+	 * 		1. CMD_INVALID
+	 * 									if the command does not conform
+	 * 									to any of the specified formats
+	 * 		2. CMD_ACCEPTED
+	 * 									if the command(or at least one
+	 * 									of its ranges) has been inserted
+	 * 									into the global commands list or
+	 * 									if it has already been applied by
+	 * 									annihilating type A commands(see
+	 * 									annihilate_pending_cmda)
+	 * 		3. CMD_IGNORED
+	 * 									if the command is valid but it
+	 * 									would have no effect
+	 * 		4. CMD_REJECTED
+	 * 									if the command is valid but the
+	 * 									global commands list is full(see
+	 * 									CMD_QUEUE_POLICY)
+	 */
+	EXTERN CResult insert_cmd(const char *line, const size_t len, const char *thread_name,
+				const uint_fast64_t id, const CmdRequest *req, MLData *data_ptr);
+
+	/*
+	 * Emit the completion record of the given request(req) if it has
+	 * a request ID, or else do nothing. data_ptr is used exactly as
+	 * in insert_cmd.
+	 *
+	 * Precondition: req != NULL
+	 */
+	EXTERN void complete_cmd_request(const CmdRequest *req, const CCompletion completion,
+				MLData *data_ptr);
+
+	/*
+	 * Search every shard of the global alarms list(through its express lanes)
+	 * while holding a reader lock on it, to determine if there is at least one
+	 * alarm with a message number in [msg_num, msg_num_last] or not. Alarms are
+	 * partitioned by their message types so any of the shards may store them.
+	 * data_ptr is used exactly as in insert_cmd.
+	 *
+	 * Precondition: msg_num <= msg_num_last
+	 *
+	 * Returns: true if and only if such an alarm exists
+	 */
+	EXTERN bool alarm_range_exists(const uint_fast32_t msg_num, const uint_fast32_t msg_num_last,
+				MLData *data_ptr);
+
+	/*
+	 * Search the type A commands which have not yet been applied, i.e.,
+	 * the ones in the global commands list and the ones which have been
+	 * taken by the command handler threads, for a command with the given
+	 * message type if msg_type != 0 or else for a command with a message
+	 * number in [msg_num, msg_num_last].
+	 *
+	 * Precondition: cmd_mutex is locked by the caller
+	 *
+	 * Returns: Pointer to the first such command or NULL if none exists
+	 */
+	EXTERN const CmdA * find_pending_cmda(const uint_fast32_t msg_type,
+				const uint_fast32_t msg_num, const uint_fast32_t msg_num_last);
+
+	/*
+	 * Search the type A commands which have been taken by the command handler
+	 * threads but not yet applied for a command with a message number in
+	 * [msg_num, msg_num_last].
+	 *
+	 * Precondition: cmd_mutex is locked by the caller
+	 *
+	 * Returns: Pointer to the first such command or NULL if none exists
+	 */
+	EXTERN const CmdA * find_taken_cmda(const uint_fast32_t msg_num, const uint_fast32_t msg_num_last);
+
+	/*
+	 * Remove the type A commands with a message number in [msg_num, msg_num_last]
+	 * from the global commands list(the ones which have not yet been taken by
+	 * their command handler threads) since a type C command of the range is
+	 * going to cancel their alarms anyway. This saves inserting each of their
+	 * alarms only to remove it again(along with a handshake with its alarm
+	 * handler thread). Their requests are completed as replaced. data_ptr is
+	 * used exactly as in insert_cmd.
+	 *
+	 * Precondition: cmd_mutex is locked by the caller
+	 *
+	 * Returns: The number of removed type A commands
+	 */
+	EXTERN uint_fast64_t annihilate_pending_cmda(const uint_fast32_t msg_num,
+				const uint_fast32_t msg_num_last, MLData *data_ptr);
+
+	/*
+	 * Search the type A commands which have not yet been applied exactly like
+	 * find_pending_cmda, but only for the ones inserted before the command
+	 * with the given sequence number(seq). A type C command is applied by the
+	 * worker of the first message number of its first range and a type D
+	 * command by the worker of its message type while type A commands are
+	 * applied by the workers of their own message numbers, so they have to
+	 * wait until such commands have been applied(see cmd_handler).
+	 *
+	 * Precondition: cmd_mutex is locked by the caller
+	 *
+	 * Returns: Pointer to the first such command or NULL if none exists
+	 */
+	EXTERN const CmdA * find_prior_cmda(const uint_fast64_t seq, const uint_fast32_t msg_type,
+				const uint_fast32_t msg_num, const uint_fast32_t msg_num_last);
+
+	/*
+	 * Wait(on cmd_queue_cond_var) until there is room for count new commands
+	 * in the global commands list if CMD_QUEUE_POLICY is CMD_QUEUE_BLOCK and
+	 * count is not larger than the capacity of the list, or else return right
+	 * away. It is called before the global commands list is searched since
+	 * cmd_mutex is unlocked while waiting. data_ptr is used exactly as in
+	 * insert_cmd.
+	 *
+	 * The command server thread may also wait since its cancellation is
+	 * disabled while it is processing commands and the command handler
+	 * threads are only cancelled after it has terminated.
+	 *
+	 * Precondition: cmd_mutex is locked by the caller
+	 */
+	EXTERN void wait_cmd_queue(const uint_fast64_t count, MLData *data_ptr);
+
+	/*
+	 * Make room for count new commands in the global commands list according
+	 * to CMD_QUEUE_POLICY(see wait_cmd_queue) and count them as waiting in it.
+	 * The requests of the shed type A commands are completed as rejected.
+	 * data_ptr is used exactly as in insert_cmd.
+	 *
+	 * Precondition: cmd_mutex is locked by the caller
+	 *
+	 * Returns: false if the new commands are rejected and true otherwise
+	 */
+	EXTERN bool admit_cmd(const uint_fast64_t count, MLData *data_ptr);
+
+	/*
+	 * Tell the command handler thread with the given index(worker) that
+	 * a command which it applies has been inserted into the global commands
+	 * list, by incrementing its pending counter and signalling its own
+	 * new_cmd_insert_cond_var. data_ptr is used exactly as in insert_cmd.
+	 *
+	 * The command server thread(data_ptr == NULL) only increments the pending
+	 * counter and signals the workers once it has processed all of the commands
+	 * that it has received from a client(see signal_cmd_workers).
+	 *
+	 * Precondition: worker < CMD_WORKERS
+	 */
+	EXTERN void notify_cmd_worker(const size_t worker, MLData *data_ptr);
+
+	/*
+	 * The only invocations of this function should be from the command server thread.
+	 *
+	 * Signal the new_cmd_insert_cond_var of every command handler thread(worker)
+	 * which has pending commands.
+	 */
+	EXTERN void signal_cmd_workers(void);
+
+
+
+	/*
+	 * Obtain a reader lock on the given shard of
+	 * the alarms list for the calling thread.
+	 */
+	EXTERN void obtain_alarm_read_lock(AlarmShard *shard, MLData *data_ptr);
+
+	/*
+	 * Release previously obtained reader lock on the given
+	 * shard of the alarms list by the calling thread.
+	 */
+	EXTERN void release_alarm_read_lock(AlarmShard *shard, MLData *data_ptr);
+
+	/*
+	 * The only invocations of this function should be from the command handler threads.
+	 *
+	 * Obtain a writer lock on the given shard of the alarms list.
 	 */
-	EXTERN void obtain_alarm_read_lock(MLData *data_ptr);
+	EXTERN void obtain_alarm_write_lock(AlarmShard *shard);
 
 	/*
-	 * Release previously obtained reader lock on
-	 * the global alarms list by the calling thread.
+	 * The only invocations of this function should be from the command handler threads.
+	 *
+	 * Release previously obtained writer lock on the given shard of the alarms list.
 	 */
-	EXTERN void release_alarm_read_lock(MLData *data_ptr);
+	EXTERN void release_alarm_write_lock(AlarmShard *shard);
 
 
 
 	/*
-	 * The only invocations of this function should be from the command handler thread.
+	 * The only invocations of this function should be from the command handler threads.
 	 *
 	 * Disable cancellation for the caller and then obtain all necessary locks.
 	 */
 	EXTERN void cmd_handler_obtain_locks(int *old_state_ptr);
 
 	/*
-	 * The only invocations of this function should be from the command handler thread.
+	 * The only invocations of this function should be from the command handler threads.
 	 *
 	 * Release all necessary locks in the opposite order of obtaining them when
 	 * invoking cmd_handler_obtain_locks and then enable cancellation for the
@@ -247,36 +1098,138 @@
 	/*
 	 * The command handler thread routine.
 	 *
-	 * Precondition: arg can be safely casted into (pthread_t *).
+	 * Precondition: arg can be safely casted into (CmdWorker *).
 	 *
 	 * Returns: arg
 	 */
 	EXTERN void * cmd_handler(void *arg);
 
 	/*
-	 * The only invocations of this function should be from the command handler thread.
+	 * The only invocations of this function should be from the command handler threads.
+	 *
+	 * Alarms are partitioned into the shards of the alarms list by their message
+	 * types while message numbers are unique across all of the shards. Therefore,
+	 * if there is an alarm with the given message number in a shard other than
+	 * the one of the given message type, then it has to be removed from that shard
+	 * before an alarm of the given message type can replace it. The removal is
+	 * exactly like its cancellation, i.e., the responsible alarm handler thread(if
+	 * any) is woken up and waited on until it has detached the alarm.
+	 *
+	 * Each of the other shards is locked(as a writer) while it is searched
+	 * and modified. alarm_cancel_mutex is then locked for the detach request.
+	 *
+	 * Precondition: alarm_cancel_mutex is not locked by the caller
+	 *
+	 * Returns: The removed(and detached) alarm, which the caller reuses for
+	 * the new alarm, or NULL if there is no such alarm in the other shards
+	 */
+	EXTERN Alarm * cmd_handler_move_alarm(const uint_fast32_t msg_num, const uint_fast32_t msg_type);
+
+	/*
+	 * The only invocations of this function should be from the command handler threads.
+	 *
+	 * Cancel all of the alarms of the given list(chained through their link
+	 * attributes) which have already been removed from the alarms list. The
+	 * alarm handler threads which are handling any of them are woken up and
+	 * waited on until they have detached them. Each alarm handler thread
+	 * detaches all of its cancelled alarms in the same wakeup which means
+	 * that there is only a single handshake per alarm handler thread
+	 * regardless of the size of the list.
 	 *
-	 * If handler_id is NULL then do nothing and just return 0 to the caller.
+	 * Precondition: alarm_cancel_mutex is not locked by the caller
 	 *
-	 * If handler_id is not NULL then join with the alarm handler thread with
-	 * ID *handler_id and release all allocated resources and return the alarm
-	 * handler thread's message type which is guaranteed to be non-zero.
+	 * Returns: The number of alarms in the list
 	 */
-	EXTERN uint_fast32_t cmd_handler_join_with_alarm_handler(pthread_t *handler_id);
+	EXTERN uint_fast64_t cmd_handler_detach_alarms(Alarm *cancel_list_head);
 
 	/*
-	 * The command handler thread cleanup routine.
+	 * The only invocations of this function should be from the command handler threads.
 	 *
-	 * Precondition: arg can be safely casted into (pthread_t *).
+	 * Free the entire list of alarms which have been detached by
+	 * cmd_handler_detach_alarms.
+	 */
+	EXTERN void cmd_handler_free_alarms(Alarm *cancel_list_head);
+
+	/*
+	 * The command handler thread cleanup routine used while it is
+	 * waiting on its new_cmd_insert_cond_var which unlocks the mutex.
+	 *
+	 * Precondition: arg can be safely casted into (pthread_mutex_t *)
+	 * which points to a mutex that is locked by the caller.
 	 */
 	EXTERN void cleanup_cmd_handler(void *arg);
 
 
 
+	/*
+	 * Map the shared alarm table with the given name(see ALARM_TABLE_NAME)
+	 * into this process(see alarm_table). A table which already exists and
+	 * is valid is attached to(*is_attached is set) while a new or invalid
+	 * one is initialized.
+	 *
+	 * Precondition: name != NULL
+	 *
+	 * Returns: 0 on success or ALARM_TABLE_ERR otherwise
+	 */
+	EXTERN int open_alarm_table(const char *name, bool *is_attached);
+
+	/*
+	 * Verify every hash chain and the free records list of the mapped
+	 * alarm table, i.e., that all of their offsets point to records of the
+	 * table, that every record is in exactly one of them and that the
+	 * records of each hash chain have message numbers of the chain.
+	 *
+	 * Returns: true if and only if the table is consistent
+	 */
+	EXTERN bool is_valid_alarm_table(void);
+
+	/*
+	 * The only invocations of this function should be from the main thread.
+	 *
+	 * Insert an alarm into the alarms list for every record of the shared
+	 * alarm table, exactly as if a type A command had been applied for it,
+	 * before any other thread has been created. data_ptr is used exactly as
+	 * in insert_cmd.
+	 *
+	 * Returns: The number of inserted alarms
+	 */
+	EXTERN uint_fast64_t restore_alarm_table(MLData *data_ptr);
+
+	/*
+	 * The only invocations of this function should be from the command handler threads.
+	 *
+	 * Store the given alarm in the shared alarm table, replacing the record
+	 * with the same message number(if any). The alarm is only counted in
+	 * alarm_table_overflows if the table is full.
+	 *
+	 * Precondition: alarm != NULL
+	 */
+	EXTERN void put_alarm_record(const Alarm *alarm);
+
+	/*
+	 * The only invocations of this function should be from the command handler threads.
+	 *
+	 * Remove the record with the given message number(if any) from the
+	 * shared alarm table.
+	 */
+	EXTERN void remove_alarm_record(const uint_fast32_t msg_num);
+
+	/*
+	 * Mark the shared alarm table as closed cleanly(once the persistent alarm
+	 * store has been written back) and unmap it from this process, which also
+	 * releases its lock. The segment(or the store) itself is kept so that the
+	 * next process attaches to it.
+	 *
+	 * Returns: 0 on success or ALARM_TABLE_ERR otherwise
+	 */
+	EXTERN int close_alarm_table(void);
+
+
+
 	/*
 	 * The alarm handler thread routine.
 	 *
-	 * Precondition: arg can be safely casted into (uint_fast32_t *).
+	 * Precondition: arg can be safely casted into (CmdB *).
 	 *
 	 * Returns: arg
 	 */
@@ -285,8 +1238,121 @@
 	/*
 	 * The alarm handler thread cleanup routine.
 	 *
-	 * Precondition: arg can be safely casted into (Alarm *).
+	 * Precondition: arg can be safely casted into (AlarmSchedule *).
 	 */
 	EXTERN void cleanup_alarm_handler(void *arg);
 
+	/*
+	 * The alarm handler thread output block cleanup routine.
+	 *
+	 * Precondition: arg can be safely casted into (AlarmOutput *).
+	 */
+	EXTERN void cleanup_alarm_output(void *arg);
+
+	/*
+	 * The only invocations of this function should be from the alarm handler threads.
+	 *
+	 * Retire the alarm handler thread of the given type B command node(handler)
+	 * which has no alarms left, unless alarms have been posted to it or detach
+	 * requests made to it in the meantime, which are detected through the given
+	 * number of detach requests that it has already processed(detach_seen).
+	 *
+	 * The thread is removed from the live alarm handler threads of its shard and
+	 * its node from the commands list. The node is then either parked in the pool
+	 * of alarm handler threads or freed, in which case the thread is detached so
+	 * that it terminates on its own. The caller's cancellation must be disabled.
+	 *
+	 * Returns:
+	 * 		1. -1	if the thread has retired and has to terminate
+	 * 		2.  0	if the thread has not retired
+	 * 		3.  1	if the thread has retired and has been parked
+	 */
+	EXTERN int alarm_handler_retire(CmdB *handler, const uint_fast64_t detach_seen);
+
+	/*
+	 * The only invocations of this function should be from the alarm handler threads.
+	 *
+	 * Wait until the parked alarm handler thread of the given type B command node
+	 * (handler) is reused for a new type B command and then free the node. The
+	 * caller's cancellation must be disabled and it is only enabled while waiting.
+	 *
+	 * Returns: Pointer to the type B command node that the thread is reused for
+	 */
+	EXTERN CmdB * alarm_handler_park(CmdB *handler);
+
+	/*
+	 * The parked alarm handler thread cleanup routine, which frees its previous
+	 * type B command node once it has been taken out of the pool.
+	 *
+	 * Precondition: arg can be safely casted into (CmdB *).
+	 */
+	EXTERN void cleanup_alarm_park(void *arg);
+
+
+
+	/*
+	 * The clock thread routine, which publishes the time of APP_CLOCK(see
+	 * publish_now) once every APP_CLOCK_TICK nanoseconds until it is cancelled.
+	 *
+	 * Precondition: arg can be safely casted into (const struct timespec *)
+	 * which points to the tick(APP_CLOCK_TICK) of the clock thread.
+	 *
+	 * Returns: arg
+	 */
+	EXTERN void * clock_ticker(void *arg);
+
+
+
+	/*
+	 * The command server thread routine.
+	 *
+	 * Precondition: arg can be safely casted into (char *) which
+	 * points to the name of the socket that the server listens on.
+	 *
+	 * Returns: arg
+	 */
+	EXTERN void * cmd_server(void *arg);
+
+	/*
+	 * Serve the given client of the command server thread with the
+	 * given ID by sending its pending acknowledgements and processing
+	 * its complete commands until it either has to wait for the client
+	 * or the client has closed its connection.
+	 *
+	 * When it returns, client->events denotes the events that the command
+	 * server should wait for on client->fd unless client->is_closed.
+	 *
+	 * Precondition: client != NULL
+	 */
+	EXTERN void serve_cmd_client(CmdClient *client, const uint_fast64_t id);
+
+	/*
+	 * Update the command server's epoll instance after the given client
+	 * has been served. A closed client is removed from the clients list
+	 * and freed, or else the events that the command server waits for
+	 * are modified if they differ from old_events.
+	 *
+	 * Preconditions:
+	 * 		1. server != NULL
+	 * 		2. client is in the clients list of server
+	 */
+	EXTERN void update_cmd_client(CmdServer *server, CmdClient *client, const uint32_t old_events);
+
+	/*
+	 * Move the completion records of the command server's clients from the
+	 * global completion records list to their own lists and serve each
+	 * client which can be sent its records right away. Records of clients
+	 * which have already disconnected are freed.
+	 *
+	 * Precondition: server != NULL
+	 */
+	EXTERN void route_cmd_done(CmdServer *server, const uint_fast64_t id);
+
+	/*
+	 * The command server thread cleanup routine.
+	 *
+	 * Precondition: arg can be safely casted into (CmdServer *).
+	 */
+	EXTERN void cleanup_cmd_server(void *arg);
+
 #endif
@@ -14,7 +14,11 @@
  *
  *************************************************************************/
 
+/* Expose the CPU affinity functions of the GNU C Library(see init_thread_attr). */
+#define _GNU_SOURCE
+
 #include "alarm_def.h"
+#include <sched.h>
 
 /* Command Validation Functions */
 
@@ -26,7 +30,7 @@
  * 		1. line != NULL
  * 		2. line is a valid C string(i.e., null-terminated)
  * 		3. strlen(line) == len
- * 		4. (cmd_type == 'B') || (cmd_type == 'C')
+ * 		4. (cmd_type == 'B') || (cmd_type == 'D')
  * 		5. n != 0
  *
  * Returns:
@@ -51,8 +55,8 @@ int is_valid_cmd(const char *line, const size_t len,
 
 	if (cmd_type == 'B') {
 		sprintf(expected, "Create_Thread: MessageType(%" PRIuFAST32 ")", n);
-	} else { /* (cmd_type == 'C') */
-		sprintf(expected, "Cancel: Message(%" PRIuFAST32 ")", n);
+	} else { /* (cmd_type == 'D') */
+		sprintf(expected, "Cancel: MessageType(%" PRIuFAST32 ")", n);
 	}
 
 	/* Validate the command and set result if invalid. */
@@ -66,6 +70,180 @@ int is_valid_cmd(const char *line, const size_t len,
 
 
 
+	return result;
+}
+
+/*
+ * Parse the type C command stored in the given string(line) of the
+ * given length(len) into a new singly-linked-list of type C command
+ * nodes, one node per message number range in the order in which
+ * they were given. The head of the new list is stored in *head_ptr
+ * only if the command is valid, otherwise *head_ptr is set to NULL.
+ *
+ * A valid type C command has the following format:
+ * 		Cancel: Message(Range, Range, ..., Range)
+ *
+ * Where each Range is either a single Number or two Numbers
+ * separated by a dash(e.g., 7-12) denoting all of the message
+ * numbers between the two Numbers inclusive.
+ *
+ * Preconditions:
+ * 		1. line != NULL
+ * 		2. line is a valid C string(i.e., null-terminated)
+ * 		3. strlen(line) == len
+ * 		4. head_ptr != NULL
+ *
+ * Returns:
+ * 		1. -1	if there is a memory allocation error
+ * 		2.  0	if it does not conform to the specified format
+ * 		3.  1	if it is valid
+ * 		4.  2	if one of the Numbers is 0 or not a valid unsigned number
+ * 		5.  3	if one of the Ranges has a first Number larger than its last
+ */
+int parse_cmdc_ranges(const char *line, const size_t len, CmdC **head_ptr) {
+	/* Stores the return value of the current method. */
+	int result = 1; /* Assume its validity. */
+
+	/*
+	 * Stores the expected command string which is rebuilt from the
+	 * parsed numbers so that the command can be validated in the same
+	 * way as is_valid_cmd does(i.e., by comparing the two strings).
+	 */
+	char *expected = NULL;
+	/* Stores the current length of the expected command string. */
+	size_t expected_len = 0;
+	/* Points to the first unparsed character of line. */
+	const char *curr = NULL;
+	/* Stores the number of characters consumed by sscanf. */
+	int consumed = 0;
+
+	/* Parsed numbers of the current range before validation. */
+	int_fast64_t l_first = 0, l_last = 0;
+	/* Validated numbers of the current range. */
+	uint_fast32_t first = 0, last = 0;
+
+	/* Command type C pointers used for building the new list. */
+	CmdC *new_cmdc = NULL, *tail = NULL;
+
+
+
+	/* Reset the head of the new list. */
+	*head_ptr = NULL;
+
+	/*
+	 * Allocate memory for expected.
+	 *
+	 * Every character of line is rebuilt into at most two characters
+	 * of expected since the only separator that can grow is the comma
+	 * which is always rebuilt as a comma followed by a single space.
+	 */
+	expected = MALLOC_ARRAY(char, 2 * len + 1);
+	if (expected == NULL) { return -1; }
+
+	/* Make sure that line starts with the reserved keywords. */
+	strcpy(expected, "Cancel: Message(");
+	expected_len = strlen(expected);
+	if (strncmp(line, expected, expected_len) != 0) { result = 0; }
+	curr = line + expected_len;
+
+	while (result == 1) {
+		/* Parse the first number of the current range. */
+		if (sscanf(curr, "%" SCNdFAST64 "%n", &l_first, &consumed) != 1) {
+			result = 0;
+			break;
+		}
+		curr += consumed;
+
+		/* Parse the last number of the current range(if any). */
+		l_last = l_first;
+		if (*curr == '-') {
+			++curr;
+			if (sscanf(curr, "%" SCNdFAST64 "%n", &l_last, &consumed) != 1) {
+				result = 0;
+				break;
+			}
+			curr += consumed;
+		}
+
+		/* Parse l_first and l_last as uint_fast32_t numbers. */
+		errno = 0;
+		first = f64_to_uf32(l_first);
+		if (errno == 0) { last = f64_to_uf32(l_last); }
+		if ((errno != 0) || (first == 0) || (last == 0)) {
+			/* Message numbers should be valid positive numbers. */
+			errno = 0;
+			result = 2;
+			break;
+		} else if (first > last) {
+			/* The range should not be empty. */
+			result = 3;
+			break;
+		}
+
+		/* Allocate memory for the new command C node. */
+		new_cmdc = MALLOC(CmdC);
+		if (new_cmdc == NULL) {
+			result = -1;
+			break;
+		}
+
+		/* Initialize the new command C node's attributes. */
+		new_cmdc->link = NULL;
+		new_cmdc->msg_num = first;
+		new_cmdc->msg_num_last = last;
+		new_cmdc->req.req_id = 0;
+
+		/* Insert the new type C command at the end of the new list in O(1). */
+		insert_last_cmdc(head_ptr, &tail, new_cmdc);
+
+		/* Rebuild the current range. */
+		if (first == last) {
+			expected_len += (size_t) sprintf(expected + expected_len, "%" PRIuFAST32, first);
+		} else { /* (first != last) */
+			expected_len += (size_t) sprintf(expected + expected_len,
+									"%" PRIuFAST32 "-%" PRIuFAST32, first, last);
+		}
+
+		/* Parse the separator following the current range. */
+		if (*curr == ',') {
+			++curr;
+			expected_len += (size_t) sprintf(expected + expected_len, ", ");
+		} else if (*curr == ')') {
+			strcpy(expected + expected_len, ")");
+
+			/* Terminate the parsing while loop. */
+			break;
+		} else { /* (*curr != ',') && (*curr != ')') */
+			result = 0;
+			break;
+		}
+	}
+
+	/* Validate the command and set result if invalid. */
+	if ((result == 1) && (strcmp(line, expected) != 0)) {
+		/* line and expected are NOT equal. */
+		result = 0;
+	}
+
+	/* Free memory allocated to expected. */
+	free(expected);
+
+	/* Free memory allocated to the new list if the command is not valid. */
+	if (result != 1) {
+		while (*head_ptr != NULL) {
+			/* Save the current first element. */
+			new_cmdc = *head_ptr;
+			/* Move to the next element. */
+			*head_ptr = (*head_ptr)->link;
+
+			/* Detach and free the element saved in new_cmdc. */
+			new_cmdc->link = NULL;
+			free(new_cmdc);
+		}
+	}
+
+
+
 	return result;
 }
 
@@ -84,17 +262,6 @@ Alarm * next_alarm(const Alarm *node) {
 	return node->link;
 }
 
-/*
- * Get the next Alarm after node in the local alarms list.
- *
- * Precondition: node != NULL
- *
- * Returns: node->link_handle
- */
-Alarm * next_handled_alarm(const Alarm *node) {
-	return node->link_handle;
-}
-
 /*
  * Insert the Alarm structure pointed to by new_alarm as the
  * new first element of the given singly-linked-list. The list is
@@ -108,32 +275,12 @@ Alarm * next_handled_alarm(const Alarm *node) {
  * 		2. new_alarm != NULL
  * 		3. *head_ptr != new_alarm
  * 		4. new_alarm->link == NULL
- * 		5. new_alarm->link_handle == NULL
  */
 void insert_first_alarm(Alarm **head_ptr, Alarm *new_alarm) {
 	new_alarm->link = *head_ptr;
 	*head_ptr = new_alarm;
 }
 
-/*
- * Insert the Alarm structure pointed to by new_alarm as the
- * new first element of the given singly-linked-list. The list is
- * accessed and/or modified through *head_ptr which points to the
- * head of the list.
- *
- * Attaching is done by setting the link_handle attribute.
- *
- * Preconditions:
- * 		1. head_ptr != NULL
- * 		2. new_alarm != NULL
- * 		3. *head_ptr != new_alarm
- * 		4. new_alarm->link_handle == NULL
- */
-void insert_first_handled_alarm(Alarm **head_ptr, Alarm *new_alarm) {
-	new_alarm->link_handle = *head_ptr;
-	*head_ptr = new_alarm;
-}
-
 /*
  * Insert the Alarm structure pointed to by new_alarm after node
  * by attaching them through setting the link attribute.
@@ -142,7 +289,6 @@ void insert_first_handled_alarm(Alarm **head_ptr, Alarm *new_alarm) {
  * 		1. node != NULL
  * 		2. new_alarm != NULL
  * 		3. new_alarm->link == NULL
- * 		4. new_alarm->link_handle == NULL
  */
 void insert_after_alarm(Alarm *node, Alarm *new_alarm) {
 	new_alarm->link = node->link;
@@ -150,17 +296,25 @@ void insert_after_alarm(Alarm *node, Alarm *new_alarm) {
 }
 
 /*
- * Insert the Alarm structure pointed to by new_alarm after node
- * by attaching them through setting the link_handle attribute.
+ * Insert the type C command node pointed to by new_cmdc as the new
+ * last element of the given singly-linked-list. The list is accessed
+ * and/or modified through *head_ptr and *tail_ptr which point to the
+ * head and the tail of the list respectively.
  *
  * Preconditions:
- * 		1. node != NULL
- * 		2. new_alarm != NULL
- * 		3. new_alarm->link_handle == NULL
+ * 		1. head_ptr != NULL
+ * 		2. tail_ptr != NULL
+ * 		3. (*head_ptr == NULL) == (*tail_ptr == NULL)
+ * 		4. new_cmdc != NULL
+ * 		5. new_cmdc->link == NULL
  */
-void insert_after_handled_alarm(Alarm *node, Alarm *new_alarm) {
-	new_alarm->link_handle = node->link_handle;
-	node->link_handle = new_alarm;
+void insert_last_cmdc(CmdC **head_ptr, CmdC **tail_ptr, CmdC *new_cmdc) {
+	if (*head_ptr == NULL) {
+		*head_ptr = new_cmdc;
+	} else { /* (*head_ptr != NULL) */
+		(*tail_ptr)->link = new_cmdc;
+	}
+	*tail_ptr = new_cmdc;
 }
 
 /*
@@ -233,55 +387,60 @@ bool is_equal_alarm(const Alarm *a, const Alarm *b) {
  * list pointed to by existing_alarm. It will then free the memory allocated
  * to the Alarm structure pointed to by new_alarm by calling void free(void *ptr).
  *
+ * The information is published under the sequence lock of existing_alarm
+ * so an assigned alarm whose message type is unchanged stays assigned and
+ * its alarm handler thread prints the new message(and period) from its
+ * next firing on. Only an assigned alarm whose message type changes has
+ * to be detached by its thread.
+ *
  * Preconditions:
  * 		1. existing_alarm != NULL
  * 		2. new_alarm != NULL
  * 		3. new_alarm->link == NULL
- * 		4. new_alarm->link_handle == NULL
- * 		5. existing_alarm != new_alarm
- * 		6. is_equal_alarm(existing_alarm, new_alarm)
- * 		7. new_alarm can be safely freed by using free(new_alarm)
+ * 		4. existing_alarm != new_alarm
+ * 		5. is_equal_alarm(existing_alarm, new_alarm)
+ * 		6. new_alarm can be safely freed by using free(new_alarm)
  *
  * Returns:
- * 		Pointer to the thread ID of the alarm handling thread that
- * 		was handling the Alarm structure pointed to by existing_alarm
- * 		only if the thread ended up cancelling itself. If no such
- * 		thread exists then the function will return NULL.
+ * 		Pointer to the type B command node of the alarm handling thread
+ * 		that has to detach the Alarm structure pointed to by existing_alarm.
+ * 		If no such thread exists then the function will return NULL.
  */
-pthread_t * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm) {
+CmdB * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm) {
 	/* Stores the return value of the current method. */
-	pthread_t *result = NULL;
+	CmdB *result = NULL;
 
 
 
-	if (existing_alarm->is_assigned) {
+	if ((existing_alarm->is_assigned) && (existing_alarm->msg_type != new_alarm->msg_type)) {
 		/*
-		 * We only have to worry about the
-		 * replacement of an assigned alarm.
+		 * We only have to worry about the replacement of an assigned
+		 * alarm by one of another message type, which its alarm
+		 * handler thread is no longer going to handle.
 		 */
 		existing_alarm->is_replaced = true;
+		++(existing_alarm->handler->detach_requests);
+		++(existing_alarm->handler->detach_waiters);
 
-		if (existing_alarm->link_handle == NULL) {
-			/*
-			 * We know that the alarm handler thread is
-			 * going to cancel itself since the current
-			 * alarm is being handled(is_assigned) and no
-			 * other alarm is being handled(link_handle == NULL)
-			 * by this alarm handler thread.
-			 */
-			result = existing_alarm->handler_id;
-		}
+		/*
+		 * Whether the alarm handler thread is going to cancel
+		 * itself or not can only be known after it has detached
+		 * the alarm since it may be handling other alarms which
+		 * are not necessarily after this alarm in its local list.
+		 */
+		result = existing_alarm->handler;
 	}
 
 
 
-	/* Copy necessary information from new_alarm into existing_alarm. */
-
 	/*
-	 * link needs to remain unchanged.
-	 *
-	 * link_handle will be reset by handling thread if needed.
+	 * Copy necessary information from new_alarm into existing_alarm
+	 * while its sequence lock is odd(see read_alarm).
 	 */
+	++(existing_alarm->seq);
+	ALARM_SEQ_BARRIER();
+
+	/* link, express, and lanes need to remain unchanged. */
 	existing_alarm->wait_time = new_alarm->wait_time;
 	existing_alarm->msg_type = new_alarm->msg_type;
 	/*
@@ -290,8 +449,15 @@ pthread_t * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm) {
 	 * returning true.
 	 */
 	strcpy(existing_alarm->msg, new_alarm->msg); /* Set existing_alarm's message. */
+
+	ALARM_SEQ_BARRIER();
+	++(existing_alarm->seq);
+	/* The alarm has now been inserted by the type A command of new_alarm. */
+	existing_alarm->cmda_seq = new_alarm->cmda_seq;
+
 	/*
-	 * is_assigned and handler_id will be reset by handling thread if needed.
+	 * is_assigned will be reset by the handling thread if needed and
+	 * handler by the caller once it has waited for that(see end_detach_request).
 	 *
 	 * is_replaced has been set in the above if needed.
 	 *
@@ -308,6 +474,91 @@ pthread_t * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm) {
 	return result;
 }
 
+/*
+ * Copy the wait time, message type, message number and message of the
+ * Alarm structure pointed to by alarm into the one pointed to by snapshot,
+ * consistently with respect to the replacements of the alarm in place.
+ *
+ * The message is copied char by char up to MAX_MSG_LEN chars since it may
+ * be overwritten while it is being copied, in which case it is copied again.
+ *
+ * Preconditions:
+ * 		1. alarm != NULL
+ * 		2. snapshot != NULL
+ * 		3. alarm != snapshot
+ */
+void read_alarm(const Alarm *alarm, Alarm *snapshot) {
+	/* The value of the alarm's sequence lock before copying. */
+	uint_fast32_t seq = 0;
+	/* Index used for copying the message. */
+	size_t i = 0;
+
+
+
+	do {
+		/* Wait until the alarm is not being replaced. */
+		while (((seq = alarm->seq) & 1) != 0) {
+			/* Spin since a replacement only copies a few fields. */
+		}
+		ALARM_SEQ_BARRIER();
+
+		snapshot->wait_time = alarm->wait_time;
+		snapshot->msg_type = alarm->msg_type;
+		for (i = 0; (i < MAX_MSG_LEN) && (alarm->msg[i] != '\0'); ++i) {
+			snapshot->msg[i] = alarm->msg[i];
+		}
+		snapshot->msg[i] = '\0'; /* Null terminate snapshot's message. */
+
+		ALARM_SEQ_BARRIER();
+	} while (alarm->seq != seq);
+
+	/* msg_num is never replaced. */
+	snapshot->msg_num = alarm->msg_num;
+}
+
+/*
+ * End a detach request that the caller has made to the alarm handler
+ * thread of the given type B command node(handler) for the given alarm,
+ * once the caller has waited until the thread has detached the alarm.
+ * The alarm's handler pointer is reset and handler->detach_waiters is
+ * decremented.
+ *
+ * Many command handler threads may have made detach requests to the
+ * same thread at once and the thread only retires once all of them have
+ * ended their requests, so that no other thread accesses the node after
+ * it has been parked or freed(see alarm_handler_retire). Therefore, the
+ * last one of them wakes the thread up if it has no alarms left.
+ *
+ * Preconditions:
+ * 		1. alarm != NULL
+ * 		2. alarm->handler != NULL
+ * 		3. !alarm->is_assigned
+ * 		4. The mutex which protects the detach requests is locked by caller
+ *
+ * Returns:
+ * 		1. -1	if the thread's eventfd cannot be written
+ * 		2.  0	on success
+ */
+int end_detach_request(Alarm *alarm) {
+	/* The type B command node of the alarm handling thread. */
+	CmdB *handler = alarm->handler;
+
+
+
+	/* Reset the alarm's handler pointer. */
+	alarm->handler = NULL;
+
+	/*
+	 * The alarm handling thread may retire when it is no longer handling
+	 * any alarms after the detachment, which it has only checked before
+	 * the detach requests were ended.
+	 */
+	if ((--(handler->detach_waiters) == 0) && (handler->alarm_count == 0)) {
+		return wake_alarm_handler(handler);
+	}
+	return 0;
+}
+
 /*
  * insert_alarm, inserts a new Alarm structure pointed to by new_alarm
  * into the given alarms singly-linked-list. The list is accessed and/or
@@ -328,56 +579,68 @@ pthread_t * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm) {
  * new alarm's message number using the replace_alarm function.
  *
  * When the command thread calls this function, it is possible for an
- * alarm to be replaced. In this case, it will wait on the given conditional
- * variable and mutex which gives the responsible alarm handler thread
- * the chance to safely detach the old alarm from its own handled list and
- * then send a signal signifying that it has performed this action so that
- * the replacement can proceed as required.
+ * assigned alarm to be replaced by one of another message type. In this
+ * case, it will wake up the responsible
+ * alarm handler thread by writing to its own wakeup eventfd
+ * and then wait on the given conditional variable and mutex which gives the
+ * responsible alarm handler thread the chance to safely detach the old
+ * alarm from its own schedule and then send a signal signifying that it
+ * has performed this action so that the replacement can proceed as required.
+ * The detach request is then ended(see end_detach_request).
  *
- * However, when an alarm handler thread calls this function, only link_handle
- * attributes are being modified which means that the alarm is not a new
- * structure as a whole, it is just being added to that thread's local list
- * which has been embedded into the global list.
+ * The alarms list is also a skip list whose express lanes are accessed
+ * and/or modified through express_head. The position of new_alarm is
+ * therefore found through the express lanes in logarithmic time and the
+ * list is only iterated from there on.
+ *
+ * Only the command thread calls this function since alarm handler threads
+ * keep the alarms that they are handling in their own schedules instead.
  *
  * Preconditions:
  * 		1.  head_ptr != NULL
- * 		2.  new_alarm != NULL
- * 		3.  new_alarm->link == NULL
- * 		4.  new_alarm->link_handle == NULL
+ * 		2.  express_head != NULL
+ * 		3.  new_alarm != NULL
+ * 		4.  new_alarm->link == NULL
  * 		5.  new_alarm does not point to any of the alarms already in the list
  * 		6.  new_alarm can be safely freed by using free(new_alarm)
- * 		7.  global_list  == (command thread calling)
- * 		8.  !global_list == (alarm handler thread calling)
- * 		9.  global_list  == (cond_var_ptr != NULL)
- * 		10. global_list  == (mutex_ptr != NULL)
- * 		11. (mutex_ptr != NULL) implies (*mutex_ptr is locked by caller)
+ * 		7.  cond_var_ptr != NULL
+ * 		8.  mutex_ptr != NULL
+ * 		9.  *mutex_ptr is locked by caller if new_alarm replaces an
+ * 			assigned alarm of another message type
  *
- * Returns: replace_alarm's return when appropriate and NULL otherwise.
+ * Returns:
+ * 		Pointer to the alarm in the list with new_alarm's message number,
+ * 		i.e., new_alarm itself unless it has replaced an existing alarm
+ * 		in which case new_alarm has been freed.
  */
-pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
+Alarm * insert_alarm(Alarm **head_ptr, Alarm **express_head, Alarm *new_alarm,
 			Alarm * (*after)(const Alarm *),
 			void (*insert_first)(Alarm **, Alarm *),
 			void (*insert_after)(Alarm *, Alarm *),
-			bool global_list, pthread_cond_t *cond_var_ptr,
-			pthread_mutex_t *mutex_ptr) {
-
-	/* Stores the return value of the current method. */
-	pthread_t *result = NULL;
-
-
+			pthread_cond_t *cond_var_ptr, pthread_mutex_t *mutex_ptr) {
 
 	/* Alarm pointers used for iterating over the alarms list. */
 	Alarm *curr_alarm = NULL, *next_alarm = NULL;
 
+	/*
+	 * The last alarm in each lane of the global alarms list
+	 * with a smaller message number than the new alarm's.
+	 */
+	Alarm *preds[ALARM_SKIP_LIST_LANES];
 
 
+
+	/* Find the position of new_alarm in every lane of the alarms list. */
+	find_alarm_preds(head_ptr, express_head, new_alarm->msg_num, preds);
+
 	/*
 	 * Special Case 1:
 	 * Check to see if the alarms list is empty.
 	 */
 	if (*head_ptr == NULL) {
 		*head_ptr = new_alarm;
-		return NULL;
+		link_express_alarm(express_head, preds, new_alarm);
+		return new_alarm;
 	}
 
 	/*
@@ -386,9 +649,9 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 	 * current first element in the list which means
 	 * that it has to replace the current first element.
 	 */
-	if (global_list && is_equal_alarm(new_alarm, *head_ptr)) {
+	if (is_equal_alarm(new_alarm, *head_ptr)) {
 		/* (*new_alarm == **head_ptr) */
-		result = replace_alarm(*head_ptr, new_alarm);
+		replace_alarm(*head_ptr, new_alarm);
 		/*
 		 * Check if is_replaced flag has been set denoting
 		 * that the alarm needs to be reset by the handling
@@ -409,7 +672,13 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 			 * predicate should be re-evaluated upon such return.
 			 *
 			 * Mesa-style implies while loop. Hoare-style implies if statement.
+			 *
+			 * The responsible alarm handler thread is first woken up so
+			 * that it does not keep sleeping until its next due alarms.
 			 */
+			if (wake_alarm_handler((*head_ptr)->handler) != 0) {
+				EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+			}
 			while ((*head_ptr)->is_assigned) {
 				errno = pthread_cond_wait(cond_var_ptr, mutex_ptr);
 				if (errno != 0) {
@@ -417,8 +686,13 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 				}
 			} /* (!(*head_ptr)->is_assigned) */
 			(*head_ptr)->is_replaced = false;
+
+			/* End the detach request(see end_detach_request). */
+			if (end_detach_request(*head_ptr) != 0) {
+				EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+			}
 		}
-		return result;
+		return *head_ptr;
 	}
 
 	/*
@@ -430,16 +704,23 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 	if (is_less_alarm(new_alarm, *head_ptr)) {
 		/* (*new_alarm < **head_ptr) */
 		(*insert_first)(head_ptr, new_alarm);
-		return NULL;
+		link_express_alarm(express_head, preds, new_alarm);
+		return new_alarm;
 	}
 
 
 
-	/* General Case: */
-	for (curr_alarm = *head_ptr; (next_alarm = (*after)(curr_alarm)) != NULL; /* Update inside. */) {
-		if (global_list && is_equal_alarm(new_alarm, next_alarm)) {
+	/*
+	 * General Case:
+	 * Start from the last alarm with a smaller message number than the
+	 * new alarm's(found through the express lanes) which means that
+	 * the following loop only iterates once.
+	 */
+	curr_alarm = (preds[0] != NULL) ? preds[0] : *head_ptr;
+	for (/* curr_alarm is already set. */; (next_alarm = (*after)(curr_alarm)) != NULL; /* Update inside. */) {
+		if (is_equal_alarm(new_alarm, next_alarm)) {
 			/* (*new_alarm == *next_alarm) */
-			result = replace_alarm(next_alarm, new_alarm);
+			replace_alarm(next_alarm, new_alarm);
 			/*
 			 * Check if is_replaced flag has been set denoting
 			 * that the alarm needs to be reset by the handling
@@ -460,7 +741,13 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 				 * predicate should be re-evaluated upon such return.
 				 *
 				 * Mesa-style implies while loop. Hoare-style implies if statement.
+				 *
+				 * The responsible alarm handler thread is first woken up so
+				 * that it does not keep sleeping until its next due alarms.
 				 */
+				if (wake_alarm_handler(next_alarm->handler) != 0) {
+					EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+				}
 				while (next_alarm->is_assigned) {
 					errno = pthread_cond_wait(cond_var_ptr, mutex_ptr);
 					if (errno != 0) {
@@ -468,8 +755,13 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 					}
 				} /* (!next_alarm->is_assigned) */
 				next_alarm->is_replaced = false;
+
+				/* End the detach request(see end_detach_request). */
+				if (end_detach_request(next_alarm) != 0) {
+					EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+				}
 			}
-			return result;
+			return next_alarm;
 		} else if (is_less_alarm(new_alarm, next_alarm)) {
 			/* (*new_alarm < *next_alarm) */
 			break;
@@ -485,7 +777,463 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 	 * as inserting it after curr_alarm.
 	 */
 	(*insert_after)(curr_alarm, new_alarm);
-	return NULL;
+	link_express_alarm(express_head, preds, new_alarm);
+
+	return new_alarm;
+}
+
+
+
+/* Skip List Functions */
+
+/*
+ * Get the number of lanes(including lane 0) of the global alarms list
+ * that an alarm with the given message number should be part of.
+ *
+ * The message number is hashed so that the lanes are distributed
+ * geometrically(with ratio 1/4) regardless of the pattern of the
+ * message numbers being used, e.g., blocks of consecutive numbers.
+ *
+ * Returns: A number in [1, ALARM_SKIP_LIST_LANES]
+ */
+uint_fast8_t alarm_lanes(const uint_fast32_t msg_num) {
+	/* Stores the return value of the current method. */
+	uint_fast8_t result = 1;
+
+	/* Stores the (32 bit) hash of the given message number. */
+	uint_fast32_t hash = msg_num & 0xFFFFFFFFUL;
+
+
+
+	/*
+	 * Mix the bits of the message number(MurmurHash3 finalizer) so
+	 * that every pair of bits of the hash is equally likely to be 0.
+	 */
+	hash ^= hash >> 16;
+	hash = (hash * 0x85EBCA6BUL) & 0xFFFFFFFFUL;
+	hash ^= hash >> 13;
+	hash = (hash * 0xC2B2AE35UL) & 0xFFFFFFFFUL;
+	hash ^= hash >> 16;
+
+	/* Each pair of zero bits promotes the alarm to the next lane. */
+	while ((result < ALARM_SKIP_LIST_LANES) && ((hash & 3) == 0)) {
+		result = (uint_fast8_t) (result + 1);
+		hash >>= 2;
+	}
+
+
+
+	return result;
+}
+
+/*
+ * Get a pointer to the link attribute of the given lane of node.
+ * A NULL node denotes the heads of the global alarms list which
+ * are accessed and/or modified through head_ptr(lane 0) and
+ * express_head(the remaining lanes).
+ *
+ * Preconditions:
+ * 		1. ((node == NULL) && (lane == 0)) implies (head_ptr != NULL)
+ * 		2. express_head != NULL
+ * 		3. lane < ALARM_SKIP_LIST_LANES
+ * 		4. (node != NULL) implies (lane < node->lanes)
+ */
+Alarm ** alarm_lane(Alarm **head_ptr, Alarm **express_head,
+			Alarm *node, const size_t lane) {
+
+	if (node == NULL) {
+		return ((lane == 0) ? head_ptr : &(express_head[lane - 1]));
+	} else { /* (node != NULL) */
+		return ((lane == 0) ? &(node->link) : &(node->express[lane - 1]));
+	}
+}
+
+/*
+ * Find, in every lane of the global alarms list, the last alarm with a
+ * message number smaller than msg_num and store it in preds[lane]. A
+ * NULL predecessor denotes the head of the lane. In particular, the
+ * first alarm with a message number not smaller than msg_num is the
+ * one after preds[0] in lane 0.
+ *
+ * Preconditions:
+ * 		1. head_ptr != NULL
+ * 		2. express_head != NULL
+ * 		3. preds can store ALARM_SKIP_LIST_LANES pointers
+ */
+void find_alarm_preds(Alarm **head_ptr, Alarm **express_head,
+			const uint_fast32_t msg_num, Alarm **preds) {
+
+	/* Alarm pointers used for iterating over the lanes. */
+	Alarm *curr_alarm = NULL, *next_alarm = NULL;
+	/* The current lane. */
+	size_t lane = ALARM_SKIP_LIST_LANES;
+
+
+
+	/*
+	 * Start from the heads of the lanes(curr_alarm == NULL) and move
+	 * forward in the highest lane for as long as possible and then drop
+	 * down to the next lane. An alarm that is part of a given lane is
+	 * also part of all of the lanes below it.
+	 */
+	while (lane-- > 0) {
+		while (((next_alarm = *alarm_lane(head_ptr, express_head, curr_alarm, lane)) != NULL) &&
+				(next_alarm->msg_num < msg_num)) {
+			curr_alarm = next_alarm;
+		}
+
+		preds[lane] = curr_alarm;
+	}
+}
+
+/*
+ * Insert the Alarm structure pointed to by new_alarm into the express
+ * lanes of the global alarms list right after the given predecessors.
+ * It also sets the number of lanes of the alarm. Inserting the alarm
+ * into lane 0 is left to the caller.
+ *
+ * Preconditions:
+ * 		1. express_head != NULL
+ * 		2. new_alarm != NULL
+ * 		3. preds have been found by find_alarm_preds for new_alarm->msg_num
+ * 		4. new_alarm is not in any of the express lanes
+ */
+void link_express_alarm(Alarm **express_head, Alarm **preds, Alarm *new_alarm) {
+	/* Pointer to the link attribute of the predecessor in the current lane. */
+	Alarm **link_ptr = NULL;
+	/* The current lane. */
+	size_t lane = 0;
+
+
+
+	new_alarm->lanes = alarm_lanes(new_alarm->msg_num);
+
+	for (lane = 1; lane < new_alarm->lanes; ++lane) {
+		/*
+		 * The head_ptr argument is never accessed for
+		 * lanes other than lane 0 so just pass NULL.
+		 */
+		link_ptr = alarm_lane(NULL, express_head, preds[lane], lane);
+		new_alarm->express[lane - 1] = *link_ptr;
+		*link_ptr = new_alarm;
+	}
+}
+
+/*
+ * Remove all alarms with message numbers in [preds[0]'s successor,
+ * msg_num_last] from every lane of the global alarms list. The removed
+ * alarms remain chained together in lane 0 through their link attributes
+ * and the link attribute of the last removed alarm is set to NULL.
+ *
+ * The given predecessors remain valid for the alarm after the removed
+ * ones which means that consecutive ranges can be removed using the
+ * same predecessors.
+ *
+ * Preconditions:
+ * 		1. head_ptr != NULL
+ * 		2. express_head != NULL
+ * 		3. preds[lane] is the last alarm in lane before the range for all lanes
+ *
+ * Returns:
+ * 		Pointer to the first removed alarm and NULL if no alarms were removed.
+ */
+Alarm * unlink_alarm_range(Alarm **head_ptr, Alarm **express_head,
+			Alarm **preds, const uint_fast32_t msg_num_last) {
+
+	/* Stores the return value of the current method. */
+	Alarm *result = *alarm_lane(head_ptr, express_head, preds[0], 0);
+
+	/* Pointer to the link attribute of the predecessor in the current lane. */
+	Alarm **link_ptr = NULL;
+	/* Alarm pointers used for iterating over the lanes. */
+	Alarm *curr_alarm = NULL, *last_alarm = NULL;
+	/* The current lane. */
+	size_t lane = 0;
+
+
+
+	/*
+	 * In every lane, skip over all alarms in the range and then
+	 * make the predecessor point to the first alarm after them.
+	 */
+	for (lane = 0; lane < ALARM_SKIP_LIST_LANES; ++lane) {
+		link_ptr = alarm_lane(head_ptr, express_head, preds[lane], lane);
+		for (curr_alarm = *link_ptr; curr_alarm != NULL; curr_alarm = *alarm_lane(head_ptr, express_head, curr_alarm, lane)) {
+			if (curr_alarm->msg_num > msg_num_last) {
+				/* Terminate the range for loop. */
+				break;
+			}
+
+			if (lane == 0) { last_alarm = curr_alarm; }
+		}
+		*link_ptr = curr_alarm;
+	}
+
+	/* No alarms were removed if none were removed from lane 0. */
+	if (last_alarm == NULL) { return NULL; }
+
+	/* Terminate the chain of removed alarms. */
+	last_alarm->link = NULL;
+
+
+
+	return result;
+}
+
+
+
+/* Alarm Schedule Functions */
+
+/*
+ * Insert the Alarm structure pointed to by new_alarm as the new last
+ * alarm of the bucket of the given schedule with the same period as
+ * new_alarm's wait time which is going to be printed next
+ * new_alarm->wait_time seconds after the given time(now). If there is
+ * no such bucket, then a new one is created.
+ *
+ * The arrays of the schedule grow geometrically when they are full.
+ *
+ * Preconditions:
+ * 		1. schedule != NULL
+ * 		2. new_alarm != NULL
+ * 		3. new_alarm->wait_time != 0
+ *
+ * Returns:
+ * 		1. -1	if there is a memory allocation error
+ * 		2.  0	on success
+ */
+int insert_last_scheduled_alarm(AlarmSchedule *schedule, Alarm *new_alarm,
+			const uint_fast64_t now) {
+
+	/* The new capacity of the bucket arrays or of the alarm array if full. */
+	size_t capacity = 0;
+	/* Index of the bucket with the same period as new_alarm's wait time. */
+	size_t i = 0, j = 0;
+	/* The time at which new_alarm is going to be printed next. */
+	const uint_fast64_t next_due = now + new_alarm->wait_time;
+
+	/* Pointers to the reallocated arrays. */
+	uint_fast64_t *due = NULL;
+	uint_fast32_t *period = NULL;
+	AlarmBucket *bucket = NULL;
+	Alarm **alarm = NULL;
+
+
+
+	/*
+	 * Find the first bucket whose period is not less than the wait time
+	 * and then the bucket with the same period which is next due at the
+	 * same time(if any). Alarms assigned at different times only share
+	 * their buckets with the ones which are next due at the same time.
+	 */
+	for (i = 0; (i < schedule->size) && (schedule->period[i] < new_alarm->wait_time); ++i) {
+		/* Do nothing. */
+	}
+	for (; (i < schedule->size) && (schedule->period[i] == new_alarm->wait_time) &&
+		(schedule->next_due[i] != next_due); ++i) {
+		/* Do nothing. */
+	}
+
+	/* Create a new bucket at index i if there is no bucket with the same period and due time. */
+	if ((i == schedule->size) || (schedule->period[i] != new_alarm->wait_time)) {
+		if (schedule->size == schedule->capacity) {
+			capacity = (schedule->capacity == 0) ? 4 : 2 * schedule->capacity;
+
+			/*
+			 * Every reallocated array is saved right away since the
+			 * schedule stays valid with its old capacity if the
+			 * reallocation of another one fails.
+			 */
+			due = REALLOC_ARRAY(uint_fast64_t, schedule->next_due, capacity);
+			if (due == NULL) { return -1; }
+			schedule->next_due = due;
+			period = REALLOC_ARRAY(uint_fast32_t, schedule->period, capacity);
+			if (period == NULL) { return -1; }
+			schedule->period = period;
+			bucket = REALLOC_ARRAY(AlarmBucket, schedule->bucket, capacity);
+			if (bucket == NULL) { return -1; }
+			schedule->bucket = bucket;
+			schedule->capacity = capacity;
+		}
+
+		/* Shift the buckets with greater periods one index to the right. */
+		for (j = schedule->size; j > i; --j) {
+			schedule->next_due[j] = schedule->next_due[j - 1];
+			schedule->period[j] = schedule->period[j - 1];
+			schedule->bucket[j] = schedule->bucket[j - 1];
+		}
+		++(schedule->size);
+
+		schedule->next_due[i] = next_due;
+		schedule->period[i] = new_alarm->wait_time;
+		schedule->bucket[i].alarm = NULL;
+		schedule->bucket[i].size = 0;
+		schedule->bucket[i].capacity = 0;
+	}
+
+	/* Grow the alarm array of the bucket if it is full. */
+	bucket = &(schedule->bucket[i]);
+	if (bucket->size == bucket->capacity) {
+		capacity = (bucket->capacity == 0) ? 8 : 2 * bucket->capacity;
+
+		alarm = REALLOC_ARRAY(Alarm *, bucket->alarm, capacity);
+		if (alarm == NULL) { return -1; }
+		bucket->alarm = alarm;
+		bucket->capacity = capacity;
+	}
+
+	/* Insert the alarm at the end of the bucket in O(1)(amortized). */
+	bucket->alarm[bucket->size] = new_alarm;
+	++(bucket->size);
+
+	return 0;
+}
+
+/*
+ * Remove the empty buckets of the given schedule(keeping the
+ * remaining buckets in the same relative order).
+ *
+ * Precondition: schedule != NULL
+ */
+void remove_empty_alarm_buckets(AlarmSchedule *schedule) {
+	/* Indices used for compacting the bucket arrays. */
+	size_t i = 0, j = 0;
+
+
+
+	for (i = 0, j = 0; i < schedule->size; ++i) {
+		if (schedule->bucket[i].size == 0) {
+			/* Free the memory allocated to the alarm array of the empty bucket. */
+			free(schedule->bucket[i].alarm);
+			schedule->bucket[i].alarm = NULL;
+		} else { /* (schedule->bucket[i].size != 0) */
+			/* Keep the bucket by moving it to index j. */
+			schedule->next_due[j] = schedule->next_due[i];
+			schedule->period[j] = schedule->period[i];
+			schedule->bucket[j] = schedule->bucket[i];
+			++j;
+		}
+	}
+	schedule->size = j;
+}
+
+/*
+ * Get the earliest time at which a bucket of the given schedule is
+ * due, which is when the alarm handler thread has to wake up next.
+ *
+ * Only the dense next_due array is scanned, whose length is the
+ * number of distinct due times rather than alarms.
+ *
+ * Precondition: schedule != NULL
+ *
+ * Returns: The minimum of schedule->next_due or 0 if the schedule is empty
+ */
+uint_fast64_t next_scheduled_due(const AlarmSchedule *schedule) {
+	/* Stores the return value of the current method. */
+	uint_fast64_t result = 0;
+	/* Index used for iterating over the buckets. */
+	size_t i = 0;
+
+
+
+	for (i = 0; i < schedule->size; ++i) {
+		if ((i == 0) || (schedule->next_due[i] < result)) {
+			result = schedule->next_due[i];
+		}
+	}
+
+	return result;
+}
+
+/*
+ * Free the memory allocated to the arrays of the given schedule and
+ * reset it to an empty schedule. The alarms themselves are not freed.
+ *
+ * Precondition: schedule != NULL
+ */
+void free_alarm_schedule(AlarmSchedule *schedule) {
+	/* Index used for iterating over the buckets. */
+	size_t i = 0;
+
+
+
+	for (i = 0; i < schedule->size; ++i) {
+		free(schedule->bucket[i].alarm);
+	}
+	free(schedule->next_due); schedule->next_due = NULL;
+	free(schedule->period); schedule->period = NULL;
+	free(schedule->bucket); schedule->bucket = NULL;
+
+	schedule->size = 0;
+	schedule->capacity = 0;
+}
+
+
+
+/* Alarm Output Functions */
+
+/*
+ * Append the record of the Alarm structure pointed to by alarm which
+ * is being printed by the alarm handler thread with the given ID at
+ * the given time(timestamp) to the given output block.
+ *
+ * The text of the output block grows geometrically when it is full.
+ *
+ * Preconditions:
+ * 		1. output != NULL
+ * 		2. alarm != NULL
+ *
+ * Returns:
+ * 		1. -1	if there is a memory allocation error
+ * 		2.  0	on success
+ */
+int append_alarm_record(AlarmOutput *output, const Alarm *alarm,
+			const uint_fast64_t id, const uint_fast64_t timestamp) {
+
+	/* The new capacity of the output block if it is (nearly) full. */
+	size_t capacity = 0;
+	/* Pointer to the reallocated text. */
+	char *text = NULL;
+
+
+
+	/*
+	 * Make sure that there is room for another record of maximum
+	 * length(including its nullchar('\0')) before printing it.
+	 */
+	if (output->capacity - output->size < ALARM_RECORD_MAX_LEN) {
+		capacity = (output->capacity == 0) ? 16 * ALARM_RECORD_MAX_LEN : 2 * output->capacity;
+
+		text = REALLOC_ARRAY(char, output->text, capacity);
+		if (text == NULL) { return -1; }
+		output->text = text;
+		output->capacity = capacity;
+	}
+
+	/* Append the record which overwrites the nullchar('\0') of the previous one. */
+	output->size += (size_t) sprintf(output->text + output->size,
+				"Alarm with message type = %" PRIuFAST32 \
+				" and message number = %" PRIuFAST32 \
+				" being printed by Alarm thread with ID = %" \
+				PRIuFAST64 " at %" PRIuFAST64 ".\nAlarm message: |%s|\n",
+				alarm->msg_type, alarm->msg_num, id, timestamp, alarm->msg);
+	++(output->records);
+
+	return 0;
+}
+
+/*
+ * Free the memory allocated to the text of the given
+ * output block and reset it to an empty output block.
+ *
+ * Precondition: output != NULL
+ */
+void free_alarm_output(AlarmOutput *output) {
+	free(output->text); output->text = NULL;
+
+	output->size = 0;
+	output->capacity = 0;
+	output->records = 0;
 }
 
 
@@ -511,8 +1259,6 @@ pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
 int cancel_thread(pthread_t id) {
 	/* Stores the return status of functions. */
 	int status = 0;
-	/* Stores the return value of the thread. */
-	void *retval = NULL;
 
 
 
@@ -520,6 +1266,33 @@ int cancel_thread(pthread_t id) {
 	status = pthread_cancel(id);
 	if (status != 0) { return THREAD_CANCEL_ERR; }
 
+
+
+	return join_cancelled_thread(id);
+}
+
+/*
+ * Join with the thread with the given ID which has already been
+ * issued a cancellation request. Cancelling many threads first and
+ * only then joining with them lets all of them terminate in parallel.
+ *
+ * Precondition: id is a valid thread ID which has been cancelled.
+ *
+ * Returns:
+ * 		1. THREAD_JOIN_ERR
+ * 										if pthread_join fails
+ * 		2. THREAD_CANCEL_RETVAL_ERR
+ * 										if PTHREAD_CANCELED is NOT
+ * 										returned by the thread
+ * 		3. 0
+ * 										on success
+ */
+int join_cancelled_thread(pthread_t id) {
+	/* Stores the return value of the thread. */
+	void *retval = NULL;
+
+
+
 	/*
 	 * Join with the thread to check if the
 	 * cancellation completed. Joining is the
@@ -527,8 +1300,7 @@ int cancel_thread(pthread_t id) {
 	 * completed or not through checking the
 	 * thread's return value stored in retval.
 	 */
-	status = pthread_join(id, &retval);
-	if (status != 0) { return THREAD_JOIN_ERR; }
+	if (pthread_join(id, &retval) != 0) { return THREAD_JOIN_ERR; }
 
 	/* Check return value against PTHREAD_CANCELED. */
 	if (retval != PTHREAD_CANCELED) {
@@ -539,3 +1311,274 @@ int cancel_thread(pthread_t id) {
 
 	return 0;
 }
+
+
+/*
+ * Initialize the given thread attributes with the given stack size(0
+ * keeps the default), CPU mask(bit i for CPU i where 0 keeps all of
+ * them) and scheduling policy, which is set explicitly with the minimum
+ * priority of the policy instead of being inherited from the creator.
+ *
+ * Precondition: attr != NULL
+ *
+ * Returns:
+ * 		1. THREAD_ATTR_ERR	if any of the attributes cannot be set(attr is
+ * 							destroyed in this case)
+ * 		2. 0				on success
+ */
+int init_thread_attr(pthread_attr_t *attr, const size_t stack_size,
+			const unsigned long cpu_mask, const int sched_policy) {
+	/* The minimum stack size of a thread. */
+	const size_t min_stack_size = (size_t) PTHREAD_STACK_MIN;
+	/* The CPUs that the threads may run on. */
+	cpu_set_t cpus;
+	/* The scheduling priority of the threads. */
+	struct sched_param param;
+	/* Index used for iterating over the bits of cpu_mask. */
+	size_t cpu = 0;
+
+
+
+	if (pthread_attr_init(attr) != 0) { return THREAD_ATTR_ERR; }
+
+	/*
+	 * The stack size is rounded up to the minimum stack size since
+	 * smaller ones are rejected by pthread_attr_setstacksize.
+	 */
+	if ((stack_size != 0) && (pthread_attr_setstacksize(attr,
+		(stack_size < min_stack_size) ? min_stack_size : stack_size) != 0)) {
+
+		pthread_attr_destroy(attr);
+		return THREAD_ATTR_ERR;
+	}
+
+	if (cpu_mask != 0) {
+		CPU_ZERO(&cpus);
+		for (cpu = 0; cpu < sizeof(cpu_mask) * CHAR_BIT; ++cpu) {
+			if ((cpu_mask >> cpu) & 1UL) {
+				CPU_SET(cpu, &cpus);
+			}
+		}
+		if (pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus) != 0) {
+			pthread_attr_destroy(attr);
+			return THREAD_ATTR_ERR;
+		}
+	}
+
+	param.sched_priority = sched_get_priority_min(sched_policy);
+	if ((param.sched_priority == -1) ||
+		(pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED) != 0) ||
+		(pthread_attr_setschedpolicy(attr, sched_policy) != 0) ||
+		(pthread_attr_setschedparam(attr, &param) != 0)) {
+
+		pthread_attr_destroy(attr);
+		return THREAD_ATTR_ERR;
+	}
+
+
+
+	return 0;
+}
+
+/*
+ * Returns: The number of bytes of address space that every thread
+ * created with the given attributes reserves for its stack including
+ * its guard area, or 0 if they cannot be read.
+ *
+ * Precondition: attr points to initialized thread attributes.
+ */
+size_t thread_attr_footprint(const pthread_attr_t *attr) {
+	/* The stack and guard sizes of the threads. */
+	size_t stack_size = 0, guard_size = 0;
+
+
+
+	if ((pthread_attr_getstacksize(attr, &stack_size) != 0) ||
+		(pthread_attr_getguardsize(attr, &guard_size) != 0)) {
+
+		return 0;
+	}
+
+
+
+	return stack_size + guard_size;
+}
+
+/*
+ * Create the eventfd(wakeup_fd), the timerfd(timer_fd) and the epoll
+ * instance(epoll_fd) of the given type B command node, which is
+ * waiting for both of them, before its alarm handler thread is created.
+ * All three are non blocking and closed on exec.
+ *
+ * Precondition: handler != NULL
+ *
+ * Returns:
+ * 		1. -1	if any of them cannot be created(none of them are left open)
+ * 		2.  0	on success
+ */
+int open_alarm_wakeup(CmdB *handler) {
+	/* The event registered for each of the file descriptors. */
+	struct epoll_event event;
+
+
+
+	handler->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	handler->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	handler->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if ((handler->wakeup_fd == -1) || (handler->timer_fd == -1) || (handler->epoll_fd == -1)) {
+		close_alarm_wakeup(handler);
+		return -1;
+	}
+
+	/* Both descriptors are told apart through event.data.fd. */
+	event.events = EPOLLIN;
+	event.data.fd = handler->wakeup_fd;
+	if (epoll_ctl(handler->epoll_fd, EPOLL_CTL_ADD, handler->wakeup_fd, &event) != 0) {
+		close_alarm_wakeup(handler);
+		return -1;
+	}
+	event.data.fd = handler->timer_fd;
+	if (epoll_ctl(handler->epoll_fd, EPOLL_CTL_ADD, handler->timer_fd, &event) != 0) {
+		close_alarm_wakeup(handler);
+		return -1;
+	}
+
+
+
+	return 0;
+}
+
+/*
+ * Close the file descriptors created by open_alarm_wakeup for the
+ * given type B command node once its alarm handler thread has terminated.
+ *
+ * Precondition: handler != NULL
+ */
+void close_alarm_wakeup(CmdB *handler) {
+	if (handler->epoll_fd != -1) { close(handler->epoll_fd); handler->epoll_fd = -1; }
+	if (handler->timer_fd != -1) { close(handler->timer_fd); handler->timer_fd = -1; }
+	if (handler->wakeup_fd != -1) { close(handler->wakeup_fd); handler->wakeup_fd = -1; }
+}
+
+/*
+ * Wake up the alarm handler thread of the given type B command node
+ * by writing to its wakeup_fd. Multiple writes before the thread wakes
+ * up are added up by the eventfd and so they only wake it up once.
+ *
+ * Precondition: handler != NULL
+ *
+ * Returns:
+ * 		1. -1	if the eventfd cannot be written
+ * 		2.  0	on success
+ */
+int wake_alarm_handler(const CmdB *handler) {
+	/* The value added to the counter of the eventfd. */
+	const uint64_t one = 1;
+
+
+
+	while (write(handler->wakeup_fd, &one, sizeof(one)) != (ssize_t) sizeof(one)) {
+		if (errno == EINTR) { continue; }
+		/*
+		 * The counter can only be full(EAGAIN) if the thread has not
+		 * read it yet in which case it is still going to wake up.
+		 */
+		if (errno == EAGAIN) { break; }
+
+		return -1;
+	}
+
+
+
+	return 0;
+}
+
+/*
+ * Returns: Pointer to the type B command node of the live alarm handler
+ * thread of the given message type in the given list(through the
+ * shard_link attribute) of live alarm handler threads and NULL if there
+ * is no such thread.
+ */
+CmdB * find_alarm_handler(CmdB *handler_list_head, const uint_fast32_t msg_type) {
+	/* Type B command pointer used for iterating over the list. */
+	CmdB *curr_cmdb = NULL;
+
+
+
+	for (curr_cmdb = handler_list_head; curr_cmdb != NULL; curr_cmdb = curr_cmdb->shard_link) {
+		if (curr_cmdb->msg_type == msg_type) { break; }
+	}
+
+
+
+	return curr_cmdb;
+}
+
+/*
+ * Remove the given type B command node from the given list(through
+ * the shard_link attribute) of live alarm handler threads if present.
+ *
+ * Precondition: handler_list_head != NULL
+ */
+void remove_alarm_handler(CmdB **handler_list_head, const CmdB *handler) {
+	/* Pointer to the link which points to the current type B command node. */
+	CmdB **curr_link = NULL;
+
+
+
+	for (curr_link = handler_list_head; *curr_link != NULL; curr_link = &((*curr_link)->shard_link)) {
+		if (*curr_link == handler) {
+			*curr_link = handler->shard_link;
+			break;
+		}
+	}
+}
+
+/*
+ * Assign the unassigned Alarm structure pointed to by alarm to the live
+ * alarm handler thread of the given type B command node by pushing it
+ * onto the thread's inbox in O(1) and then waking it up, so that it
+ * starts handling the alarm right away without searching the global
+ * alarms list for it.
+ *
+ * The alarm is pushed with a compare-and-swap on the head of the inbox
+ * rather than under a lock, since the thread may take the whole inbox
+ * at the same time(see alarm_handler). The thread's alarm_count is
+ * updated atomically for the same reason.
+ *
+ * Preconditions:
+ * 		1. handler != NULL
+ * 		2. alarm != NULL
+ * 		3. !alarm->is_assigned
+ * 		4. alarm->msg_type == handler->msg_type
+ * 		5. The writer lock and the handler_mutex of the alarm's shard are held.
+ *
+ * Returns:
+ * 		1. -1	if the thread's eventfd cannot be written
+ * 		2.  0	on success
+ */
+int post_alarm(CmdB *handler, Alarm *alarm) {
+	/* The head of the thread's inbox that the alarm is pushed onto. */
+	Alarm *head = NULL;
+
+
+
+	/*
+	 * The alarm counts as one of the thread's alarms from now on, so the
+	 * thread does not retire before it has moved the alarm from
+	 * its inbox to its schedule.
+	 */
+	alarm->is_assigned = true;
+	alarm->handler = handler;
+	(void) __sync_fetch_and_add(&(handler->alarm_count), 1);
+
+	/* Push the alarm onto the thread's inbox(retry if the thread has taken it meanwhile). */
+	do {
+		head = handler->inbox_head;
+		alarm->inbox_link = head;
+	} while (!__sync_bool_compare_and_swap(&(handler->inbox_head), head, alarm));
+
+
+
+	return wake_alarm_handler(handler);
+}
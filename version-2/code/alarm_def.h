@@ -23,6 +23,9 @@
 	/* Headers */
 
 	#include <pthread.h>
+	#include <sys/epoll.h>
+	#include <sys/eventfd.h>
+	#include <sys/timerfd.h>
 	#include "std_utilities.h"
 
 
@@ -41,6 +44,46 @@
 	 */
 	#define ALARM_THREAD_UPDATE_PERIOD 10
 
+	/*
+	 * The number of lanes of the global alarms list which is a skip
+	 * list ordered by message numbers. Lane 0 is formed by the link
+	 * attributes(i.e., every alarm) and each of the remaining express
+	 * lanes holds about a quarter of the alarms of the lane below it.
+	 * Therefore 16 lanes keep searches logarithmic up to about 4^16
+	 * alarms per shard, which covers every 32 bit message number(see
+	 * alarm_lanes) and thereby any number of alarms the application
+	 * can hold. Every alarm node only has room for the lanes it is part
+	 * of(see ALARM_SIZE) so the unused upper lanes cost no memory.
+	 */
+	#define ALARM_SKIP_LIST_LANES 16
+
+	/*
+	 * The size of an alarm node which is part of the given number of lanes
+	 * of the global alarms list, whose express array(see Alarm) is extended
+	 * past the end of the structure to hold the links of its lanes - 1 express
+	 * lanes. Alarm nodes must only be allocated with MALLOC_ALARM.
+	 */
+	#define ALARM_SIZE(lanes) (sizeof(Alarm) + \
+				(((lanes) > 2) ? ((size_t) (lanes) - 2) : 0) * sizeof(Alarm *))
+
+	/* Allocate memory for an alarm node with the given message number. */
+	#define MALLOC_ALARM(msg_num) ((Alarm *) malloc(ALARM_SIZE(alarm_lanes(msg_num))))
+
+	/*
+	 * An upper bound on the length of the record printed every time
+	 * an alarm fires(including the nullchar('\0') at the end). The
+	 * fixed text is 113 chars long and there are 4 unsigned numbers of
+	 * at most 20 digits each and a message of at most MAX_MSG_LEN chars.
+	 */
+	#define ALARM_RECORD_MAX_LEN 256
+
+	/*
+	 * A full memory barrier which orders the accesses to the fields of an
+	 * alarm with respect to the accesses to its sequence lock(see seq).
+	 * Neither the compiler nor the processor moves any access across it.
+	 */
+	#define ALARM_SEQ_BARRIER() __sync_synchronize()
+
 	/*
 	 * The following consists of possible errors that
 	 * can occur during the application execution.
@@ -104,6 +147,46 @@
 	#define ALLOC_CMDC_ERR -14
 	#define ALLOC_CMDC_ERR_MSG "Type C command memory allocation error"
 
+	/* Type D command memory allocation error. */
+	#define ALLOC_CMDD_ERR -15
+	#define ALLOC_CMDD_ERR_MSG "Type D command memory allocation error"
+
+	/* Alarm schedule memory allocation error. */
+	#define ALLOC_SCHEDULE_ERR -16
+	#define ALLOC_SCHEDULE_ERR_MSG "Alarm schedule memory allocation error"
+
+	/* Alarm output block memory allocation error. */
+	#define ALLOC_OUTPUT_ERR -17
+	#define ALLOC_OUTPUT_ERR_MSG "Alarm output block memory allocation error"
+
+	/* Command server socket error. */
+	#define SOCKET_ERR -18
+	#define SOCKET_ERR_MSG "Command server socket error"
+
+	/* Command server epoll error. */
+	#define EPOLL_ERR -19
+	#define EPOLL_ERR_MSG "Command server epoll error"
+
+	/* Command server client memory allocation error. */
+	#define ALLOC_CLIENT_ERR -20
+	#define ALLOC_CLIENT_ERR_MSG "Command server client memory allocation error"
+
+	/* Completion record memory allocation error. */
+	#define ALLOC_DONE_ERR -21
+	#define ALLOC_DONE_ERR_MSG "Completion record memory allocation error"
+
+	/* Command server completion pipe error. */
+	#define PIPE_ERR -22
+	#define PIPE_ERR_MSG "Command server completion pipe error"
+
+	/* Alarm thread wakeup(eventfd, timerfd or epoll) error. */
+	#define WAKEUP_FD_ERR -23
+	#define WAKEUP_FD_ERR_MSG "Alarm thread wakeup error"
+
+	/* Shared alarm table(shm_open, ftruncate or mmap) error. */
+	#define ALARM_TABLE_ERR -24
+	#define ALARM_TABLE_ERR_MSG "Shared alarm table error"
+
 	/* Positive values imply that errno is NOT set. */
 
 	/* Mutex lock error. */
@@ -166,6 +249,26 @@
 	#define STREAM_ERR 15
 	#define STREAM_ERR_MSG "Stream error"
 
+	/* Conditional variable broadcast error. */
+	#define COND_VAR_BROADCAST_ERR 16
+	#define COND_VAR_BROADCAST_ERR_MSG "Conditional variable broadcast error"
+
+	/* Conditional variable initialization error. */
+	#define COND_VAR_INIT_ERR 17
+	#define COND_VAR_INIT_ERR_MSG "Conditional variable initialization error"
+
+	/* Thread attributes error. */
+	#define THREAD_ATTR_ERR 18
+	#define THREAD_ATTR_ERR_MSG "Thread attributes error"
+
+	/* Thread detach error. */
+	#define THREAD_DETACH_ERR 19
+	#define THREAD_DETACH_ERR_MSG "Thread detach error"
+
+	/* Mutex initialization error. */
+	#define MUTEX_INIT_ERR 20
+	#define MUTEX_INIT_ERR_MSG "Mutex initialization error"
+
 
 
 	/* Type Definitions */
@@ -174,11 +277,6 @@
 	typedef struct AlarmNode {
 		/* Pointer to the next alarm node in the global alarms list. */
 		struct AlarmNode		*link;
-		/*
-		 * Pointer to the next alarm node in the local alarms list
-		 * being handled by some handling thread.
-		 */
-		struct AlarmNode		*link_handle;
 
 		/*
 		 * The amount of time to wait in seconds between two
@@ -203,21 +301,126 @@
 		/* The state of the alarm either ASSIGNED(true) or UNASSIGNED(false). */
 		bool					is_assigned;
 		/*
-		 * Pointer to the thread ID of the alarm_handler thread which
-		 * is handling this alarm and NULL if no such thread exists.
+		 * Pointer to the type B command node of the alarm_handler thread
+		 * which is handling this alarm and NULL if no such thread exists.
 		 *
 		 * Threads are responsible to maintain the following invariants:
-		 * 		1. is_assigned == (handler_id != NULL)
-		 * 		2. (handler_id != NULL) implies (*handler_id is a valid thread ID)
+		 * 		1. is_assigned implies (handler != NULL)
+		 * 		2. (handler != NULL) implies (handler->id is a valid thread ID)
+		 *
+		 * When a replaced or cancelled alarm is detached, handler is only
+		 * reset by the command handler thread which has made the detach
+		 * request after it has waited for the detachment(see end_detach_request).
 		 */
-		pthread_t				*handler_id;
+		struct CmdNodeB			*handler;
+
+		/*
+		 * The sequence lock of wait_time, msg_type and msg, which may be
+		 * replaced in place(see replace_alarm) while the alarm handler thread
+		 * of the alarm is printing it without holding any locks. It is odd
+		 * while they are being written and it is advanced twice by every
+		 * replacement, so that the thread retries reading them until it has
+		 * read the same even value before and after(see read_alarm). The
+		 * writers are serialized by the writer lock on the alarm's shard.
+		 */
+		volatile uint_fast32_t	seq;
 
 		/* Is the current alarm being replaced or not? */
 		bool					is_replaced;
 		/* Is the current alarm being cancelled or not? */
 		bool					is_cancelled;
+
+		/*
+		 * The sequence number of the type A command which has inserted(or
+		 * last replaced) the alarm and 0 if it has been restored(see cmd_seq).
+		 * The type C and D commands inserted before that command skip the
+		 * alarm since they may be applied after it by another command handler
+		 * thread. It is only accessed while the alarm's shard is write locked.
+		 */
+		uint_fast64_t			cmda_seq;
+
+		/*
+		 * Pointer to the next alarm node in the inbox of the alarm handler
+		 * thread that the alarm has been posted to(see post_alarm). Once the
+		 * thread has moved the alarm to its schedule, it also uses it to
+		 * collect the alarms whose wait time has been replaced in place.
+		 */
+		struct AlarmNode		*inbox_link;
+
+		/*
+		 * The number of lanes that the alarm is part of(including lane 0),
+		 * which is set when the alarm is inserted into the global alarms
+		 * list and only depends on its message number(see alarm_lanes).
+		 *
+		 * Pointers to the next alarm node in each of the express lanes of
+		 * the global alarms list, i.e., express[i] is the link attribute
+		 * of lane i + 1. The array must stay the last attribute since it is
+		 * extended past the end of the node to hold lanes - 1 pointers(see
+		 * ALARM_SIZE), and only those are meaningful.
+		 */
+		uint_fast8_t			lanes;
+		struct AlarmNode		*express[1];
 	} Alarm;
 
+	/*
+	 * Structure encapsulating the alarms of a bucket of the schedule of
+	 * an alarm handler thread(see AlarmSchedule).
+	 *
+	 * The alarm array has room for capacity alarms, of which the first
+	 * size are in use, and they are kept in increasing message number order.
+	 */
+	typedef struct AlarmBucketStruct {
+		Alarm					**alarm;
+		size_t					size;
+		size_t					capacity;
+	} AlarmBucket;
+
+	/*
+	 * Structure encapsulating the schedule of the alarms being handled by
+	 * an alarm handler thread as a struct of arrays of buckets, one per
+	 * distinct period and due time, in increasing period order. The alarms
+	 * of bucket[i] all have the same period(wait time) and have been
+	 * assigned to the thread at the same time, so they are always printed
+	 * together, every period[i] seconds, next when the thread's clock
+	 * reaches next_due[i].
+	 *
+	 * The thread only ever scans the dense next_due and period arrays in
+	 * order to find its next wakeup(the earliest due time, which its
+	 * timerfd is armed for) and the buckets that are due. The alarm arrays
+	 * of the buckets(and the alarm nodes themselves) are only accessed
+	 * when they are due, so both the number of wakeups and the work done
+	 * per wakeup depend on the number of distinct due times rather than
+	 * alarms.
+	 *
+	 * All three arrays have room for capacity buckets, of which the
+	 * first size are in use.
+	 */
+	typedef struct AlarmScheduleStruct {
+		uint_fast64_t			*next_due;
+		uint_fast32_t			*period;
+		AlarmBucket				*bucket;
+
+		size_t					size;
+		size_t					capacity;
+	} AlarmSchedule;
+
+	/*
+	 * Structure encapsulating the block of text that an alarm handler
+	 * thread prints in a single write every time that it wakes up. The
+	 * records of all of the alarms which fire in the same wakeup are
+	 * appended to text(of which the first size chars are in use) and the
+	 * block is then written at once and emptied, keeping its memory for
+	 * the next wakeup. The records attribute counts the records that are
+	 * currently in the block.
+	 */
+	typedef struct AlarmOutputStruct {
+		char					*text;
+
+		size_t					size;
+		size_t					capacity;
+		size_t					records;
+	} AlarmOutput;
+
 	/* Structure encapsulating each pthread as a node in a singly-linked-list. */
 	typedef struct ThreadNode {
 		/* Pointer to the next thread node in the threads list. */
@@ -229,6 +432,23 @@
 		pthread_t				id;
 	} Thread;
 
+	/*
+	 * Structure encapsulating the request that a command was submitted
+	 * with, so that a completion record can be emitted for it once the
+	 * command handler thread has applied it(or it has been rejected).
+	 */
+	typedef struct CmdRequestStruct {
+		/* The request ID given by the client(0 if none was given). */
+		uint_fast32_t			req_id;
+		/*
+		 * The command server's number for the client's connection which
+		 * the completion record is sent to(0 for the main thread).
+		 */
+		uint_fast64_t			client;
+		/* The time of CMD_LATENCY_CLOCK(see CMD_LATENCY_NOW) when the command was submitted. */
+		uint_fast64_t			submit_time;
+	} CmdRequest;
+
 	/* Structure encapsulating each type A command as a node in a singly-linked-list. */
 	typedef struct CmdNodeA {
 		/* Pointer to the next type A command node in the global commands list. */
@@ -253,6 +473,13 @@
 		 * at the end to terminate the string.
 		 */
 		char					msg[MAX_MSG_LEN + 1];
+
+		/* The client's request that the command was submitted with. */
+		CmdRequest				req;
+		/* The index of the command handler thread which applies the command. */
+		size_t					worker;
+		/* The order in which the command has been inserted(see cmd_seq). */
+		uint_fast64_t			seq;
 	} CmdA;
 
 	/* Structure encapsulating each type B command as a node in a singly-linked-list. */
@@ -267,6 +494,90 @@
 
 		/* The state of the command either PROCESSED(true) or UNPROCESSED(false). */
 		bool					is_processed;
+
+		/* The client's request that the command was submitted with. */
+		CmdRequest				req;
+		/* The index of the command handler thread which applies the command. */
+		size_t					worker;
+
+		/*
+		 * The number of alarms in the local alarms list(and inbox) of the thread.
+		 *
+		 * It is modified by the thread itself, while assigning alarms
+		 * (reader lock held) and while detaching replaced or cancelled alarms
+		 * (alarm_cancel_mutex locked), and by the command handler threads
+		 * while posting alarms to its inbox(writer lock held and the
+		 * handler_mutex of the shard locked), which is why the latter two
+		 * update it atomically. The thread lingers once it is 0 and only
+		 * retires if it is still 0 when its linger period has passed(see
+		 * alarm_handler_retire).
+		 */
+		uint_fast64_t			alarm_count;
+
+		/*
+		 * The number of times that the command handler thread has set the
+		 * is_replaced or is_cancelled flag of an alarm which is handled by
+		 * the thread. It is only modified and read while alarm_cancel_mutex
+		 * is locked and a change tells the thread that it should look for
+		 * alarms to detach, without having to check the flags of each of
+		 * its alarms every second.
+		 */
+		uint_fast64_t			detach_requests;
+		/*
+		 * The file descriptors that only this thread waits on(through its
+		 * epoll instance epoll_fd) until its next due alarms. wakeup_fd is
+		 * an eventfd which is written after every detach request so that
+		 * only the thread which has to detach alarms is woken up and
+		 * timer_fd is a timerfd which expires at its next wakeup.
+		 */
+		int						wakeup_fd;
+		int						timer_fd;
+		int						epoll_fd;
+		/*
+		 * The number of detach requests made to the thread that the command
+		 * handler threads which have made them have not yet ended(see
+		 * end_detach_request). It is only modified and read while
+		 * alarm_cancel_mutex is locked. The thread never retires while it is
+		 * not 0 since the command handler threads access the node after
+		 * waiting for the detachment.
+		 */
+		uint_fast64_t			detach_waiters;
+
+		/*
+		 * Pointer to the head of the thread's inbox, i.e., the stack
+		 * (through the inbox_link attribute) of the alarms which have been
+		 * assigned to it by the command handler threads after it has been
+		 * created. They push alarms onto it with a compare-and-swap(see
+		 * post_alarm) and the thread takes all of them at once by swapping
+		 * it with NULL every time that it wakes up, without any lock.
+		 */
+		Alarm * volatile		inbox_head;
+		/*
+		 * Pointer to the next type B command node in the list of the live
+		 * alarm handler threads of the same shard of the alarms list, which
+		 * the thread is part of from its creation until it retires(including
+		 * while it lingers). It is only accessed while the handler_mutex of
+		 * the shard is locked.
+		 */
+		struct CmdNodeB			*shard_link;
+		/*
+		 * Pointer to the type B command node that the thread is reused for
+		 * after it has retired and been parked in the pool of alarm handler
+		 * threads with this node(NULL until then). It is only accessed while
+		 * cmd_mutex is locked.
+		 */
+		struct CmdNodeB			*next_handler;
+
+		/*
+		 * The number of alarm records that the thread has printed and the
+		 * number of writes that it has used to print them, i.e., the thread
+		 * prints fired_records / fired_writes records per write on average.
+		 * They are only modified by the thread itself and are only read by
+		 * other threads after they have joined with it(or by the thread
+		 * itself when it retires).
+		 */
+		uint_fast64_t			fired_records;
+		uint_fast64_t			fired_writes;
 	} CmdB;
 
 	/* Structure encapsulating each type C command as a node in a singly-linked-list. */
@@ -274,10 +585,40 @@
 		/* Pointer to the next type C command node in the global commands list. */
 		struct CmdNodeC			*link;
 
-		/* The alarm's message number used to uniquely identify different alarms. */
+		/*
+		 * The range of message numbers of the alarms that should be
+		 * cancelled, i.e., [msg_num, msg_num_last]. A single alarm is
+		 * cancelled by setting both attributes to its message number.
+		 *
+		 * Invariant: msg_num <= msg_num_last
+		 */
 		uint_fast32_t			msg_num;
+		uint_fast32_t			msg_num_last;
+
+		/* The client's request that the command was submitted with. */
+		CmdRequest				req;
+		/* The index of the command handler thread which applies the command. */
+		size_t					worker;
+		/* The order in which the command has been inserted(see cmd_seq). */
+		uint_fast64_t			seq;
 	} CmdC;
 
+	/* Structure encapsulating each type D command as a node in a singly-linked-list. */
+	typedef struct CmdNodeD {
+		/* Pointer to the next type D command node in the global commands list. */
+		struct CmdNodeD			*link;
+
+		/* The message type of all of the alarms to be cancelled. */
+		uint_fast32_t			msg_type;
+
+		/* The client's request that the command was submitted with. */
+		CmdRequest				req;
+		/* The index of the command handler thread which applies the command. */
+		size_t					worker;
+		/* The order in which the command has been inserted(see cmd_seq). */
+		uint_fast64_t			seq;
+	} CmdD;
+
 
 
 	/* Function Prototypes */
@@ -292,7 +633,7 @@
 	 * 		1. line != NULL
 	 * 		2. line is a valid C string(i.e., null-terminated)
 	 * 		3. strlen(line) == len
-	 * 		4. (cmd_type == 'B') || (cmd_type == 'C')
+	 * 		4. (cmd_type == 'B') || (cmd_type == 'D')
 	 * 		5. n != 0
 	 *
 	 * Returns:
@@ -303,6 +644,35 @@
 	int is_valid_cmd(const char *line, const size_t len,
 				const char cmd_type, const uint_fast32_t n);
 
+	/*
+	 * Parse the type C command stored in the given string(line) of the
+	 * given length(len) into a new singly-linked-list of type C command
+	 * nodes, one node per message number range in the order in which
+	 * they were given. The head of the new list is stored in *head_ptr
+	 * only if the command is valid, otherwise *head_ptr is set to NULL.
+	 *
+	 * A valid type C command has the following format:
+	 * 		Cancel: Message(Range, Range, ..., Range)
+	 *
+	 * Where each Range is either a single Number or two Numbers
+	 * separated by a dash(e.g., 7-12) denoting all of the message
+	 * numbers between the two Numbers inclusive.
+	 *
+	 * Preconditions:
+	 * 		1. line != NULL
+	 * 		2. line is a valid C string(i.e., null-terminated)
+	 * 		3. strlen(line) == len
+	 * 		4. head_ptr != NULL
+	 *
+	 * Returns:
+	 * 		1. -1	if there is a memory allocation error
+	 * 		2.  0	if it does not conform to the specified format
+	 * 		3.  1	if it is valid
+	 * 		4.  2	if one of the Numbers is 0 or not a valid unsigned number
+	 * 		5.  3	if one of the Ranges has a first Number larger than its last
+	 */
+	int parse_cmdc_ranges(const char *line, const size_t len, CmdC **head_ptr);
+
 
 
 	/* Singly Linked List Functions */
@@ -316,15 +686,6 @@
 	 */
 	Alarm * next_alarm(const Alarm *node);
 
-	/*
-	 * Get the next Alarm after node in the local alarms list.
-	 *
-	 * Precondition: node != NULL
-	 *
-	 * Returns: node->link_handle
-	 */
-	Alarm * next_handled_alarm(const Alarm *node);
-
 	/*
 	 * Insert the Alarm structure pointed to by new_alarm as the
 	 * new first element of the given singly-linked-list. The list is
@@ -338,26 +699,9 @@
 	 * 		2. new_alarm != NULL
 	 * 		3. *head_ptr != new_alarm
 	 * 		4. new_alarm->link == NULL
-	 * 		5. new_alarm->link_handle == NULL
 	 */
 	void insert_first_alarm(Alarm **head_ptr, Alarm *new_alarm);
 
-	/*
-	 * Insert the Alarm structure pointed to by new_alarm as the
-	 * new first element of the given singly-linked-list. The list is
-	 * accessed and/or modified through *head_ptr which points to the
-	 * head of the list.
-	 *
-	 * Attaching is done by setting the link_handle attribute.
-	 *
-	 * Preconditions:
-	 * 		1. head_ptr != NULL
-	 * 		2. new_alarm != NULL
-	 * 		3. *head_ptr != new_alarm
-	 * 		4. new_alarm->link_handle == NULL
-	 */
-	void insert_first_handled_alarm(Alarm **head_ptr, Alarm *new_alarm);
-
 	/*
 	 * Insert the Alarm structure pointed to by new_alarm after node
 	 * by attaching them through setting the link attribute.
@@ -366,20 +710,23 @@
 	 * 		1. node != NULL
 	 * 		2. new_alarm != NULL
 	 * 		3. new_alarm->link == NULL
-	 * 		4. new_alarm->link_handle == NULL
 	 */
 	void insert_after_alarm(Alarm *node, Alarm *new_alarm);
 
 	/*
-	 * Insert the Alarm structure pointed to by new_alarm after node
-	 * by attaching them through setting the link_handle attribute.
+	 * Insert the type C command node pointed to by new_cmdc as the new
+	 * last element of the given singly-linked-list. The list is accessed
+	 * and/or modified through *head_ptr and *tail_ptr which point to the
+	 * head and the tail of the list respectively.
 	 *
 	 * Preconditions:
-	 * 		1. node != NULL
-	 * 		2. new_alarm != NULL
-	 * 		3. new_alarm->link_handle == NULL
+	 * 		1. head_ptr != NULL
+	 * 		2. tail_ptr != NULL
+	 * 		3. (*head_ptr == NULL) == (*tail_ptr == NULL)
+	 * 		4. new_cmdc != NULL
+	 * 		5. new_cmdc->link == NULL
 	 */
-	void insert_after_handled_alarm(Alarm *node, Alarm *new_alarm);
+	void insert_last_cmdc(CmdC **head_ptr, CmdC **tail_ptr, CmdC *new_cmdc);
 
 	/*
 	 * Compare the Alarm structure pointed to by a
@@ -421,22 +768,65 @@
 	 * list pointed to by existing_alarm. It will then free the memory allocated
 	 * to the Alarm structure pointed to by new_alarm by calling void free(void *ptr).
 	 *
+	 * The information is published under the sequence lock of existing_alarm
+	 * so an assigned alarm whose message type is unchanged stays assigned and
+	 * its alarm handler thread prints the new message(and period) from its
+	 * next firing on. Only an assigned alarm whose message type changes has
+	 * to be detached by its thread.
+	 *
 	 * Preconditions:
 	 * 		1. existing_alarm != NULL
 	 * 		2. new_alarm != NULL
 	 * 		3. new_alarm->link == NULL
-	 * 		4. new_alarm->link_handle == NULL
-	 * 		5. existing_alarm != new_alarm
-	 * 		6. is_equal_alarm(existing_alarm, new_alarm)
-	 * 		7. new_alarm can be safely freed by using free(new_alarm)
+	 * 		4. existing_alarm != new_alarm
+	 * 		5. is_equal_alarm(existing_alarm, new_alarm)
+	 * 		6. new_alarm can be safely freed by using free(new_alarm)
 	 *
 	 * Returns:
-	 * 		Pointer to the thread ID of the alarm handling thread that
-	 * 		was handling the Alarm structure pointed to by existing_alarm
-	 * 		only if the thread ended up cancelling itself. If no such
-	 * 		thread exists then the function will return NULL.
+	 * 		Pointer to the type B command node of the alarm handling thread
+	 * 		that has to detach the Alarm structure pointed to by existing_alarm.
+	 * 		If no such thread exists then the function will return NULL.
+	 */
+	CmdB * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm);
+
+	/*
+	 * Copy the wait time, message type, message number and message of the
+	 * Alarm structure pointed to by alarm into the one pointed to by snapshot,
+	 * consistently with respect to the replacements of the alarm in place,
+	 * by retrying until the alarm's sequence lock has been the same even
+	 * value before and after copying them. The rest of snapshot is unchanged.
+	 *
+	 * Preconditions:
+	 * 		1. alarm != NULL
+	 * 		2. snapshot != NULL
+	 * 		3. alarm != snapshot
 	 */
-	pthread_t * replace_alarm(Alarm *existing_alarm, Alarm *new_alarm);
+	void read_alarm(const Alarm *alarm, Alarm *snapshot);
+
+	/*
+	 * End a detach request that the caller has made to the alarm handler
+	 * thread of the given type B command node(handler) for the given alarm,
+	 * once the caller has waited until the thread has detached the alarm.
+	 * The alarm's handler pointer is reset and handler->detach_waiters is
+	 * decremented.
+	 *
+	 * Many command handler threads may have made detach requests to the
+	 * same thread at once and the thread only retires once all of them have
+	 * ended their requests, so that no other thread accesses the node after
+	 * it has been parked or freed(see alarm_handler_retire). Therefore, the
+	 * last one of them wakes the thread up if it has no alarms left.
+	 *
+	 * Preconditions:
+	 * 		1. alarm != NULL
+	 * 		2. alarm->handler != NULL
+	 * 		3. !alarm->is_assigned
+	 * 		4. The mutex which protects the detach requests is locked by caller
+	 *
+	 * Returns:
+	 * 		1. -1	if the thread's eventfd cannot be written
+	 * 		2.  0	on success
+	 */
+	int end_detach_request(Alarm *alarm);
 
 	/*
 	 * insert_alarm, inserts a new Alarm structure pointed to by new_alarm
@@ -458,38 +848,206 @@
 	 * new alarm's message number using the replace_alarm function.
 	 *
 	 * When the command thread calls this function, it is possible for an
-	 * alarm to be replaced. In this case, it will wait on the given conditional
-	 * variable and mutex which gives the responsible alarm handler thread
-	 * the chance to safely detach the old alarm from its own handled list and
-	 * then send a signal signifying that it has performed this action so that
-	 * the replacement can proceed as required.
+	 * assigned alarm to be replaced by one of another message type. In this
+	 * case, it will wake up the responsible
+	 * alarm handler thread by writing to its own wakeup eventfd
+	 * and then wait on the given conditional variable and mutex which gives the
+	 * responsible alarm handler thread the chance to safely detach the old
+	 * alarm from its own schedule and then send a signal signifying that it
+	 * has performed this action so that the replacement can proceed as required.
+	 * The detach request is then ended(see end_detach_request).
+	 *
+	 * The alarms list is also a skip list whose express lanes are accessed
+	 * and/or modified through express_head. The position of new_alarm is
+	 * therefore found through the express lanes in logarithmic time and the
+	 * list is only iterated from there on.
 	 *
-	 * However, when an alarm handler thread calls this function, only link_handle
-	 * attributes are being modified which means that the alarm is not a new
-	 * structure as a whole, it is just being added to that thread's local list
-	 * which has been embedded into the global list.
+	 * Only the command thread calls this function since alarm handler threads
+	 * keep the alarms that they are handling in their own schedules instead.
 	 *
 	 * Preconditions:
 	 * 		1.  head_ptr != NULL
-	 * 		2.  new_alarm != NULL
-	 * 		3.  new_alarm->link == NULL
-	 * 		4.  new_alarm->link_handle == NULL
+	 * 		2.  express_head != NULL
+	 * 		3.  new_alarm != NULL
+	 * 		4.  new_alarm->link == NULL
 	 * 		5.  new_alarm does not point to any of the alarms already in the list
 	 * 		6.  new_alarm can be safely freed by using free(new_alarm)
-	 * 		7.  global_list  == (command thread calling)
-	 * 		8.  !global_list == (alarm handler thread calling)
-	 * 		9.  global_list  == (cond_var_ptr != NULL)
-	 * 		10. global_list  == (mutex_ptr != NULL)
-	 * 		11. (mutex_ptr != NULL) implies (*mutex_ptr is locked by caller)
+	 * 		7.  cond_var_ptr != NULL
+	 * 		8.  mutex_ptr != NULL
+	 * 		9.  *mutex_ptr is locked by caller
 	 *
-	 * Returns: replace_alarm's return when appropriate and NULL otherwise.
+	 * Returns:
+	 * 		Pointer to the alarm in the list with new_alarm's message number,
+	 * 		i.e., new_alarm itself unless it has replaced an existing alarm
+	 * 		in which case new_alarm has been freed.
 	 */
-	pthread_t * insert_alarm(Alarm **head_ptr, Alarm *new_alarm,
+	Alarm * insert_alarm(Alarm **head_ptr, Alarm **express_head, Alarm *new_alarm,
 				Alarm * (*after)(const Alarm *),
 				void (*insert_first)(Alarm **, Alarm *),
 				void (*insert_after)(Alarm *, Alarm *),
-				bool global_list, pthread_cond_t *cond_var_ptr,
-				pthread_mutex_t *mutex_ptr);
+				pthread_cond_t *cond_var_ptr, pthread_mutex_t *mutex_ptr);
+
+
+
+	/* Skip List Functions */
+
+	/*
+	 * Get the number of lanes(including lane 0) of the global alarms list
+	 * that an alarm with the given message number should be part of.
+	 *
+	 * The message number is hashed so that the lanes are distributed
+	 * geometrically(with ratio 1/4) regardless of the pattern of the
+	 * message numbers being used, e.g., blocks of consecutive numbers.
+	 *
+	 * Returns: A number in [1, ALARM_SKIP_LIST_LANES]
+	 */
+	uint_fast8_t alarm_lanes(const uint_fast32_t msg_num);
+
+	/*
+	 * Get a pointer to the link attribute of the given lane of node.
+	 * A NULL node denotes the heads of the global alarms list which
+	 * are accessed and/or modified through head_ptr(lane 0) and
+	 * express_head(the remaining lanes).
+	 *
+	 * Preconditions:
+	 * 		1. ((node == NULL) && (lane == 0)) implies (head_ptr != NULL)
+	 * 		2. express_head != NULL
+	 * 		3. lane < ALARM_SKIP_LIST_LANES
+	 * 		4. (node != NULL) implies (lane < node->lanes)
+	 */
+	Alarm ** alarm_lane(Alarm **head_ptr, Alarm **express_head,
+				Alarm *node, const size_t lane);
+
+	/*
+	 * Find, in every lane of the global alarms list, the last alarm with a
+	 * message number smaller than msg_num and store it in preds[lane]. A
+	 * NULL predecessor denotes the head of the lane. In particular, the
+	 * first alarm with a message number not smaller than msg_num is the
+	 * one after preds[0] in lane 0.
+	 *
+	 * Preconditions:
+	 * 		1. head_ptr != NULL
+	 * 		2. express_head != NULL
+	 * 		3. preds can store ALARM_SKIP_LIST_LANES pointers
+	 */
+	void find_alarm_preds(Alarm **head_ptr, Alarm **express_head,
+				const uint_fast32_t msg_num, Alarm **preds);
+
+	/*
+	 * Insert the Alarm structure pointed to by new_alarm into the express
+	 * lanes of the global alarms list right after the given predecessors.
+	 * It also sets the number of lanes of the alarm. Inserting the alarm
+	 * into lane 0 is left to the caller.
+	 *
+	 * Preconditions:
+	 * 		1. express_head != NULL
+	 * 		2. new_alarm != NULL
+	 * 		3. preds have been found by find_alarm_preds for new_alarm->msg_num
+	 * 		4. new_alarm is not in any of the express lanes
+	 */
+	void link_express_alarm(Alarm **express_head, Alarm **preds, Alarm *new_alarm);
+
+	/*
+	 * Remove all alarms with message numbers in [preds[0]'s successor,
+	 * msg_num_last] from every lane of the global alarms list. The removed
+	 * alarms remain chained together in lane 0 through their link attributes
+	 * and the link attribute of the last removed alarm is set to NULL.
+	 *
+	 * The given predecessors remain valid for the alarm after the removed
+	 * ones which means that consecutive ranges can be removed using the
+	 * same predecessors.
+	 *
+	 * Preconditions:
+	 * 		1. head_ptr != NULL
+	 * 		2. express_head != NULL
+	 * 		3. preds[lane] is the last alarm in lane before the range for all lanes
+	 *
+	 * Returns:
+	 * 		Pointer to the first removed alarm and NULL if no alarms were removed.
+	 */
+	Alarm * unlink_alarm_range(Alarm **head_ptr, Alarm **express_head,
+				Alarm **preds, const uint_fast32_t msg_num_last);
+
+
+
+	/* Alarm Schedule Functions */
+
+	/*
+	 * Insert the Alarm structure pointed to by new_alarm as the new last
+	 * alarm of the bucket of the given schedule with the same period as
+	 * new_alarm's wait time which is going to be printed next
+	 * new_alarm->wait_time seconds after the given time(now). If there is
+	 * no such bucket, then a new one is created.
+	 *
+	 * The arrays of the schedule grow geometrically when they are full.
+	 *
+	 * Preconditions:
+	 * 		1. schedule != NULL
+	 * 		2. new_alarm != NULL
+	 * 		3. new_alarm->wait_time != 0
+	 *
+	 * Returns:
+	 * 		1. -1	if there is a memory allocation error
+	 * 		2.  0	on success
+	 */
+	int insert_last_scheduled_alarm(AlarmSchedule *schedule, Alarm *new_alarm,
+				const uint_fast64_t now);
+
+	/*
+	 * Remove the empty buckets of the given schedule(keeping the
+	 * remaining buckets in the same relative order).
+	 *
+	 * Precondition: schedule != NULL
+	 */
+	void remove_empty_alarm_buckets(AlarmSchedule *schedule);
+
+	/*
+	 * Get the earliest time at which a bucket of the given schedule is
+	 * due, which is when the alarm handler thread has to wake up next.
+	 *
+	 * Precondition: schedule != NULL
+	 *
+	 * Returns: The minimum of schedule->next_due or 0 if the schedule is empty
+	 */
+	uint_fast64_t next_scheduled_due(const AlarmSchedule *schedule);
+
+	/*
+	 * Free the memory allocated to the arrays of the given schedule and
+	 * reset it to an empty schedule. The alarms themselves are not freed.
+	 *
+	 * Precondition: schedule != NULL
+	 */
+	void free_alarm_schedule(AlarmSchedule *schedule);
+
+
+
+	/* Alarm Output Functions */
+
+	/*
+	 * Append the record of the Alarm structure pointed to by alarm which
+	 * is being printed by the alarm handler thread with the given ID at
+	 * the given time(timestamp) to the given output block.
+	 *
+	 * The text of the output block grows geometrically when it is full.
+	 *
+	 * Preconditions:
+	 * 		1. output != NULL
+	 * 		2. alarm != NULL
+	 *
+	 * Returns:
+	 * 		1. -1	if there is a memory allocation error
+	 * 		2.  0	on success
+	 */
+	int append_alarm_record(AlarmOutput *output, const Alarm *alarm,
+				const uint_fast64_t id, const uint_fast64_t timestamp);
+
+	/*
+	 * Free the memory allocated to the text of the given
+	 * output block and reset it to an empty output block.
+	 *
+	 * Precondition: output != NULL
+	 */
+	void free_alarm_output(AlarmOutput *output);
 
 
 
@@ -513,4 +1071,118 @@
 	 */
 	int cancel_thread(pthread_t id);
 
+	/*
+	 * Join with the thread with the given ID which has already been
+	 * issued a cancellation request. Cancelling many threads first and
+	 * only then joining with them lets all of them terminate in parallel.
+	 *
+	 * Precondition: id is a valid thread ID which has been cancelled.
+	 *
+	 * Returns:
+	 * 		1. THREAD_JOIN_ERR
+	 * 										if pthread_join fails
+	 * 		2. THREAD_CANCEL_RETVAL_ERR
+	 * 										if PTHREAD_CANCELED is NOT
+	 * 										returned by the thread
+	 * 		3. 0
+	 * 										on success
+	 */
+	int join_cancelled_thread(pthread_t id);
+
+	/*
+	 * Initialize the given thread attributes with the given stack size(0
+	 * keeps the default), CPU mask(bit i for CPU i where 0 keeps all of
+	 * them) and scheduling policy, which is set explicitly with the minimum
+	 * priority of the policy instead of being inherited from the creator.
+	 *
+	 * Precondition: attr != NULL
+	 *
+	 * Returns:
+	 * 		1. THREAD_ATTR_ERR	if any of the attributes cannot be set(attr is
+	 * 							destroyed in this case)
+	 * 		2. 0				on success
+	 */
+	int init_thread_attr(pthread_attr_t *attr, const size_t stack_size,
+				const unsigned long cpu_mask, const int sched_policy);
+
+	/*
+	 * Returns: The number of bytes of address space that every thread
+	 * created with the given attributes reserves for its stack including
+	 * its guard area, or 0 if they cannot be read.
+	 *
+	 * Precondition: attr points to initialized thread attributes.
+	 */
+	size_t thread_attr_footprint(const pthread_attr_t *attr);
+
+	/*
+	 * Create the eventfd(wakeup_fd), the timerfd(timer_fd) and the epoll
+	 * instance(epoll_fd) of the given type B command node, which is
+	 * waiting for both of them, before its alarm handler thread is created.
+	 * All three are non blocking and closed on exec.
+	 *
+	 * Precondition: handler != NULL
+	 *
+	 * Returns:
+	 * 		1. -1	if any of them cannot be created(none of them are left open)
+	 * 		2.  0	on success
+	 */
+	int open_alarm_wakeup(CmdB *handler);
+
+	/*
+	 * Close the file descriptors created by open_alarm_wakeup for the
+	 * given type B command node once its alarm handler thread has terminated.
+	 *
+	 * Precondition: handler != NULL
+	 */
+	void close_alarm_wakeup(CmdB *handler);
+
+	/*
+	 * Wake up the alarm handler thread of the given type B command node
+	 * by writing to its wakeup_fd. Multiple writes before the thread wakes
+	 * up are added up by the eventfd and so they only wake it up once.
+	 *
+	 * Precondition: handler != NULL
+	 *
+	 * Returns:
+	 * 		1. -1	if the eventfd cannot be written
+	 * 		2.  0	on success
+	 */
+	int wake_alarm_handler(const CmdB *handler);
+
+	/*
+	 * Returns: Pointer to the type B command node of the live alarm handler
+	 * thread of the given message type in the given list(through the
+	 * shard_link attribute) of live alarm handler threads and NULL if there
+	 * is no such thread.
+	 */
+	CmdB * find_alarm_handler(CmdB *handler_list_head, const uint_fast32_t msg_type);
+
+	/*
+	 * Remove the given type B command node from the given list(through
+	 * the shard_link attribute) of live alarm handler threads if present.
+	 *
+	 * Precondition: handler_list_head != NULL
+	 */
+	void remove_alarm_handler(CmdB **handler_list_head, const CmdB *handler);
+
+	/*
+	 * Assign the unassigned Alarm structure pointed to by alarm to the live
+	 * alarm handler thread of the given type B command node by inserting it
+	 * at the end of the thread's inbox in O(1) and then waking it up, so that
+	 * it starts handling the alarm right away without searching the global
+	 * alarms list for it.
+	 *
+	 * Preconditions:
+	 * 		1. handler != NULL
+	 * 		2. alarm != NULL
+	 * 		3. !alarm->is_assigned
+	 * 		4. alarm->msg_type == handler->msg_type
+	 * 		5. alarm_cancel_mutex is locked.
+	 *
+	 * Returns:
+	 * 		1. -1	if the thread's eventfd cannot be written
+	 * 		2.  0	on success
+	 */
+	int post_alarm(CmdB *handler, Alarm *alarm);
+
 #endif
@@ -20,41 +20,102 @@
 /*
  * The alarm handler thread routine.
  *
- * Precondition: arg can be safely casted into (uint_fast32_t *).
+ * Precondition: arg can be safely casted into (CmdB *).
  *
- * Returns: arg
+ * Returns: NULL
  */
 void * alarm_handler(void *arg) {
 	/* Save the current thread(alarm handler)'s ID. */
-	pthread_t tid = pthread_self();
-	const uint_fast64_t id = (uint_fast64_t) tid;
+	const uint_fast64_t id = (uint_fast64_t) pthread_self();
 
 
 
+	/*
+	 * The type B command node which has created this thread or which
+	 * it has been reused for since then(see alarm_handler_park). It is
+	 * volatile since it is modified after pthread_cleanup_push.
+	 */
+	CmdB * volatile handler = (CmdB *) arg;
 	/* The message type that this thread should handle. */
-	const uint_fast32_t msg_type = *((uint_fast32_t *) arg);
+	uint_fast32_t msg_type = 0;
+	/* The shard of the alarms list which stores the alarms of msg_type. */
+	AlarmShard *shard = NULL;
 
 	/*
-	 * Pointer to the head of the local alarms list
-	 * which this thread is currently handling.
+	 * The schedule of the alarms which this thread is currently
+	 * handling(buckets of alarms with the same period).
 	 */
-	Alarm *handle_list_head = NULL;
+	AlarmSchedule schedule;
+	/* Pointer to the current bucket of the schedule. */
+	AlarmBucket *bucket = NULL;
+	/*
+	 * The block of text holding the records of all of the alarms
+	 * which are printed during the current wakeup of this thread.
+	 */
+	AlarmOutput output;
 	/* Alarm pointer used for iterating over the alarms list. */
 	Alarm *curr_alarm = NULL;
+	/*
+	 * The alarms taken from this thread's inbox(through the inbox_link
+	 * attribute) in the order of their posting, and the next one of them.
+	 */
+	Alarm *posted_head = NULL, *next_posted = NULL;
+	/*
+	 * The copy of the alarm being printed(see read_alarm) and the list
+	 * (through the inbox_link attribute) of the printed alarms whose wait
+	 * time no longer matches the period of their bucket.
+	 */
+	Alarm snapshot;
+	Alarm *moved_head = NULL;
+	/*
+	 * Indices used for iterating over the schedule and for
+	 * compacting it when removing replaced or cancelled alarms.
+	 */
+	size_t b = 0, i = 0, j = 0;
 
 	/*
-	 * Alarm pointer used to save the pointer to the previous
-	 * node in the local alarms list when removing replaced or
-	 * cancelled alarms from the list.
+	 * The time(in terms of time_since_create) of the next wakeup
+	 * of this thread, which is the earliest due time of the
+	 * schedule, the one that its timerfd is currently armed for and
+	 * the same time as an absolute time on the monotonic clock(timer).
+	 */
+	uint_fast64_t next_wakeup = 0, armed_wakeup = 0;
+	struct itimerspec timer;
+	/*
+	 * The time(on the monotonic clock) at which this thread's clock(time_since_create)
+	 * was 0 and the current time when alarms are moved from its inbox to its schedule.
+	 */
+	struct timespec start, current;
+	/* The number of whole seconds that have passed since start. */
+	uint_fast64_t elapsed = 0;
+	/* The events of the eventfd and the timerfd of this thread and their number. */
+	struct epoll_event events[2];
+	int event_count = 0, e = 0;
+	/* The counter of the eventfd or the number of expirations of the timerfd. */
+	uint64_t count = 0;
+	/* Whether the timerfd has expired which means that the next wakeup has been reached. */
+	bool is_due = false;
+	/*
+	 * The number of detach requests made by the command handler threads
+	 * that this thread has already processed and the current number.
+	 */
+	uint_fast64_t detach_seen = 0, detach_requests = 0;
+	/*
+	 * Whether this thread is lingering with no alarms left and the
+	 * time(in terms of time_since_create) at which it stops lingering.
 	 */
-	Alarm *prev_alarm = NULL;
+	bool is_lingering = false;
+	volatile uint_fast64_t linger_until = 0;
+	/* Whether this thread has retired(see alarm_handler_retire). */
+	int retired = 0;
 
 
 
 	/*
 	 * Stores the current amount of time passed from the thread's
-	 * creation since it is incremented by 1 every second. It is
-	 * used for determining which alarms to print.
+	 * creation(or reuse) since it is advanced to the time of every wakeup,
+	 * i.e., to the earliest due time of the schedule. It is used for
+	 * determining which alarms to print.
 	 *
 	 * Note that the value will eventually reach the maximum and
 	 * wrap around back to 0. We know this from the standard which
@@ -66,9 +127,8 @@ void * alarm_handler(void *arg) {
 	 *
 	 * However, this is not something that we need to be concerned
 	 * with since the maximum value for an unsigned integer represented
-	 * in 64-bits is: 2^64 - 1 and since we increment time_since_create
-	 * by 1 every second, it will need to be incremented 2^64 times for
-	 * it to wrap around back to 0 but this will take 2^64 seconds at the
+	 * in 64-bits is: 2^64 - 1 and since time_since_create is advanced
+	 * by 1 second per second, it will need 2^64 seconds at the
 	 * every least(the reason for at least 2^64 seconds is that the thread
 	 * is not necessarily running the entire time for one and secondly,
 	 * the uint_fast64_t guarantees at least 64-bits.)
@@ -84,6 +144,11 @@ void * alarm_handler(void *arg) {
 
 
 
+	/* The time at which the alarms of the current wakeup are printed. */
+	uint_fast64_t timestamp = 0;
+
+
+
 	/* Dummy variable used when setting the cancel state of this thread. */
 	int old_state = 0;
 
@@ -92,214 +157,551 @@ void * alarm_handler(void *arg) {
 	/*
 	 * Set up this thread's cleanup routines to be called
 	 * when it is cancelled by the main thread when it is
-	 * terminating or it self terminates in which case the
-	 * cleanup routine does nothing.
+	 * terminating or it retires and terminates in which case
+	 * the cleanup routines only free the (empty) schedule
+	 * and the memory of the output block.
 	 */
-	pthread_cleanup_push(cleanup_alarm_handler, (void *) handle_list_head);
-
+	schedule.next_due = NULL; schedule.period = NULL; schedule.bucket = NULL;
+	schedule.size = 0; schedule.capacity = 0;
+	pthread_cleanup_push(cleanup_alarm_handler, (void *) (&schedule));
+	output.text = NULL; output.size = 0; output.capacity = 0; output.records = 0;
+	pthread_cleanup_push(cleanup_alarm_output, (void *) (&output));
 
 
-	/* Disable cancellation. */
-	if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
-		EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
-	}
-
-	/* Obtain reader lock. */
-	obtain_alarm_read_lock(NULL);
 
 	/*
-	 * Critical Section:
-	 * Read the global alarms list and update the local
-	 * alarms list which this thread is going to handle.
-	 *
-	 *
-	 * The reason why we only require a reader lock on the
-	 * global alarms list is that we are not changing any
-	 * globally shared data on the design level. The link_handle
-	 * attribute just allow us to embed an alarm handler's
-	 * local list into the global list for faster runtime and
-	 * also memory allocation efficiency.
-	 *
-	 * The is_assigned flag makes it so that different alarm
-	 * handler threads do not even attempt to access alarms that
-	 * have already been assigned.
-	 *
-	 * Message types(msg_type) further help us in making the data
-	 * disjoint by only allowing alarm handlers to manage alarms
-	 * that have the same type as them.
-	 *
-	 * Finally, since we enforce unique threads of a given message
-	 * type(this is enforced by the main and command handler threads),
-	 * we arrive at the following conclusion: The local lists are
-	 * accessible globally but remain solely accessed by the owning
-	 * alarm handler thread.
-	 *
-	 *
-	 * However, note that even without one of the above, we may not
-	 * be able to guarantee that a reader lock would be enough.
-	 * For example:
-	 * 		If we allowed multiple threads of a given type, then there
-	 * 		would actually be an issue with the reader lock since many
-	 * 		alarm handler threads of a given type could find an unassigned
-	 * 		Alarm structure of their desired type at the same time and
-	 * 		all of them would be able to overwrite each other's selection
-	 * 		process.
+	 * Serve the type B command node which has created this thread and then
+	 * every node which it is reused for after it has retired and been parked
+	 * in the pool of alarm handler threads, each with a fresh clock.
 	 */
-	for (curr_alarm = alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
-		if ((!curr_alarm->is_assigned) &&
-			(curr_alarm->msg_type == msg_type)) {
+	while (true) {
+		msg_type = handler->msg_type;
+		shard = ALARM_SHARD(msg_type);
+		time_since_create = 0;
+		armed_wakeup = 0;
+		detach_seen = 0;
+		is_lingering = false;
 
-			/* Set the alarm's state to ASSIGNED. */
-			curr_alarm->is_assigned = true;
-			/* Set the alarm's handler ID pointer. */
-			curr_alarm->handler_id = &tid;
+		/* Disable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+		}
 
-			/*
-			 * Insert the alarm pointed to by curr_alarm into the local
-			 * alarms list in sorted order using the insert_alarm method.
-			 *
-			 * The return of the following invocation will always be NULL.
-			 */
-			insert_alarm(&handle_list_head, curr_alarm, next_handled_alarm,
-						insert_first_handled_alarm, insert_after_handled_alarm,
-						false, NULL, NULL);
-
-			/* Print status message informing the user of the internal state. */
-			fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
-						" and message number = %" PRIuFAST32 \
-						" has been assigned to Alarm thread with ID = %" \
-						PRIuFAST64 " at %" PRIuFAST64 ".\n", msg_type,
-						curr_alarm->msg_num, id, now());
+		/*
+		 * The reader lock on this thread's own shard of the alarms list has
+		 * already been obtained on its behalf by the command handler thread
+		 * which has created(or reused) it, so that none of the alarms that it has been
+		 * created for can be removed by the other command handler threads
+		 * before it has been assigned them(see cmd_handler). It has also
+		 * added this thread to the live alarm handler threads of the shard
+		 * so the alarms inserted after this search are posted to its inbox.
+		 */
+
+		/*
+		 * Critical Section:
+		 * Read the shard of the global alarms list and update the local
+		 * schedule of alarms which this thread is going to handle.
+		 *
+		 *
+		 * The reason why we only require a reader lock on the
+		 * global alarms list is that we are not changing any
+		 * globally shared data on the design level. The alarms
+		 * are only referenced by the thread's own schedule which
+		 * is not shared with any other thread.
+		 *
+		 * The is_assigned flag makes it so that different alarm
+		 * handler threads do not even attempt to access alarms that
+		 * have already been assigned.
+		 *
+		 * Message types(msg_type) further help us in making the data
+		 * disjoint by only allowing alarm handlers to manage alarms
+		 * that have the same type as them.
+		 *
+		 * Finally, since we enforce unique threads of a given message
+		 * type(this is enforced by the main and command handler threads),
+		 * we arrive at the following conclusion: The assigned alarms
+		 * are accessible globally but their assignment is solely
+		 * modified by the owning alarm handler thread.
+		 *
+		 *
+		 * However, note that even without one of the above, we may not
+		 * be able to guarantee that a reader lock would be enough.
+		 * For example:
+		 * 		If we allowed multiple threads of a given type, then there
+		 * 		would actually be an issue with the reader lock since many
+		 * 		alarm handler threads of a given type could find an unassigned
+		 * 		Alarm structure of their desired type at the same time and
+		 * 		all of them would be able to overwrite each other's selection
+		 * 		process.
+		 */
+		for (curr_alarm = shard->alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+			if ((!curr_alarm->is_assigned) &&
+				(curr_alarm->msg_type == msg_type)) {
+
+				/* Set the alarm's state to ASSIGNED. */
+				curr_alarm->is_assigned = true;
+				/* Set the alarm's handler pointer. */
+				curr_alarm->handler = handler;
+				++(handler->alarm_count);
+
+				/*
+				 * Insert the alarm pointed to by curr_alarm at the end of its
+				 * bucket of the schedule. The global alarms list is sorted by
+				 * message numbers which means that so is every bucket.
+				 */
+				if (insert_last_scheduled_alarm(&schedule, curr_alarm, time_since_create) != 0) {
+					EXIT_ERR(ALLOC_SCHEDULE_ERR_MSG, ALLOC_SCHEDULE_ERR);
+				}
+
+				/* Print status message informing the user of the internal state. */
+				fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
+							" and message number = %" PRIuFAST32 \
+							" has been assigned to Alarm thread with ID = %" \
+							PRIuFAST64 " at %" PRIuFAST64 ".\n", msg_type,
+							curr_alarm->msg_num, id, now());
+			}
 		}
-	}
 
-	/* Release reader lock. */
-	release_alarm_read_lock(NULL);
+		/* Release reader lock. */
+		release_alarm_read_lock(shard, NULL);
 
-	/* Enable cancellation. */
-	if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
-		EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
-	}
+		/* Start this thread's clock. */
+		if (clock_gettime(CLOCK_MONOTONIC, &start) != 0) {
+			EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+		}
+		timer.it_interval.tv_sec = 0; timer.it_interval.tv_nsec = 0;
 
-	/* Check if there are any pending cancellation requests. */
-	pthread_testcancel(); /* pthread_testcancel() never fails. */
+		/* Enable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+		}
 
+		/* Check if there are any pending cancellation requests. */
+		pthread_testcancel(); /* pthread_testcancel() never fails. */
 
 
-	/*
-	 * Infinite loop to update the alarms handling list,
-	 * then actually handling(printing) the alarms.
-	 *
-	 * This thread will terminate when all of its alarms
-	 * have been replaced or cancelled by the command handler
-	 * thread on appropriate type A or type C commands or
-	 * at the termination of the main thread itself.
-	 *
-	 * We know that the thread's local alarms list is not
-	 * empty(handle_list_head != NULL) in the first iteration
-	 * of the loop since this is enforced by the main and
-	 * command handler threads before creating a new alarm
-	 * handler thread.
-	 *
-	 * Every iteration, also check if any alarms have been
-	 * replaced or cancelled by an appropriate type A or
-	 * type C command and if so, then remove them from the
-	 * thread's list and signal the alarm cancel conditional
-	 * variable signifying that the alarm has been cancelled
-	 * so that the command handler thread can be woken up.
-	 */
-	while (true) {
-		sleep(1); /* Sleep for 1 second. */
-		++time_since_create;
 
-		/* Loop over all assigned alarms and print the appropriate ones. */
-		prev_alarm = NULL;
-		for (curr_alarm = handle_list_head; curr_alarm != NULL; /* Update inside. */) {
+		/*
+		 * Infinite loop to update the alarms schedule,
+		 * then actually handling(printing) the alarms.
+		 *
+		 * This thread will linger when all of its alarms have
+		 * been replaced or cancelled by the command handler
+		 * thread on appropriate type A, C or D commands and
+		 * it retires once it has lingered ALARM_HANDLER_LINGER
+		 * seconds without any alarms being posted to it. It is
+		 * only terminated otherwise at the termination of the
+		 * main thread itself.
+		 *
+		 * We know that the thread's schedule is not empty
+		 * (schedule.size != 0) in the first iteration of the
+		 * loop since this is enforced by the main and command
+		 * handler threads before creating(or reusing) an alarm
+		 * handler thread.
+		 *
+		 * Every iteration, sleep until the earliest due time of the
+		 * buckets of the schedule since no alarm can be due before then,
+		 * unless the command handler thread makes new detach requests in
+		 * the meantime. Therefore, the number of wakeups only depends on
+		 * the distinct due times of the alarms.
+		 * The thread sleeps in epoll_wait on its timerfd, which expires at
+		 * the next wakeup, and its wakeup eventfd, which the command handler
+		 * threads write after making detach requests, so that replaced or
+		 * cancelled alarms are detached as soon as they are requested.
+		 *
+		 * Every iteration, first move the alarms which the command handler
+		 * threads have posted to this thread's inbox since then(the alarms of
+		 * its message type inserted after it has searched the alarms list) to
+		 * its schedule, which also wakes it up through its eventfd.
+		 *
+		 * Every iteration, also check if the command handler threads
+		 * have replaced or cancelled any of this thread's alarms and if
+		 * so, then remove them from the thread's schedule. Once all of
+		 * them have been removed, broadcast the alarm cancel conditional
+		 * variable(only once) signifying that the alarms have been
+		 * cancelled so that the command handler threads can be woken up.
+		 * This way, cancelling many alarms of this thread costs a single
+		 * handshake.
+		 *
+		 * While this thread is lingering, its next wakeup is the end of
+		 * its linger period and once that has passed, its timerfd is
+		 * disarmed(next_wakeup is 0) since it only waits to be able to
+		 * retire(see end_detach_request) or for alarms to be posted to it.
+		 */
+		while (true) {
+			if (schedule.size != 0) {
+				next_wakeup = next_scheduled_due(&schedule);
+			} else if (linger_until > time_since_create) { /* (schedule.size == 0) */
+				next_wakeup = linger_until;
+			} else { /* (schedule.size == 0) && (linger_until <= time_since_create) */
+				next_wakeup = 0;
+			}
+
+			/* Arm the timerfd for the next wakeup unless it is already armed for it. */
+			if (next_wakeup != armed_wakeup) {
+				if (next_wakeup != 0) {
+					timer.it_value.tv_sec = start.tv_sec + (time_t) next_wakeup;
+					timer.it_value.tv_nsec = start.tv_nsec;
+				} else { /* (next_wakeup == 0) */
+					timer.it_value.tv_sec = 0;
+					timer.it_value.tv_nsec = 0;
+				}
+				if (timerfd_settime(handler->timer_fd, TFD_TIMER_ABSTIME, &timer, NULL) != 0) {
+					EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+				}
+				armed_wakeup = next_wakeup;
+			}
+
 			/*
-			 * First check to make sure that the alarm we are looking at, has not
-			 * been replaced or cancelled by the command handler thread before
-			 * attempting to print its message.
+			 * Sleep until the next wakeup or until there are new detach requests.
+			 * No locks are held while waiting and epoll_wait is a cancellation
+			 * point, so no cleanup routine is needed for it.
 			 */
-			if ((curr_alarm->is_replaced) || (curr_alarm->is_cancelled)) {
-				/* Print status message informing the user of the internal state. */
-				fprintf(app_log, "Alarm thread with ID = %" PRIuFAST64 \
-							" stopped printing %s alarm with message type = %" \
-							PRIuFAST32 " and message number = %" PRIuFAST32 \
-							" at %" PRIuFAST64 ".\n", id,
-							(curr_alarm->is_replaced ? "replaced" : "cancelled"),
-							msg_type, curr_alarm->msg_num, now());
-
-				/* Remove the alarm from the thread's local alarms list. */
-				if (curr_alarm == handle_list_head) {
-					/* The current alarm is the first alarm in the list. */
-
-					/* Update the head pointer of the list. */
-					handle_list_head = handle_list_head->link_handle;
-
-					/* Detach and reset the element saved in curr_alarm. */
-					curr_alarm->link_handle = NULL;
-					curr_alarm->is_assigned = false;
-					curr_alarm->handler_id = NULL;
-
-					/* Update curr_alarm. */
-					curr_alarm = handle_list_head;
-				} else { /* (curr_alarm != handle_list_head) */
-					/* The current alarm is NOT the first alarm in the list. */
-
-					/* Make the prev node point to the next node in the list. */
-					prev_alarm->link_handle = curr_alarm->link_handle;
-
-					/* Detach and reset the element saved in curr_alarm. */
-					curr_alarm->link_handle = NULL;
-					curr_alarm->is_assigned = false;
-					curr_alarm->handler_id = NULL;
-
-					/* Update curr_alarm. */
-					curr_alarm = prev_alarm->link_handle;
+			event_count = epoll_wait(handler->epoll_fd, events, 2, -1);
+			if (event_count == -1) {
+				if (errno == EINTR) { continue; }
+				EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+			}
+
+			/*
+			 * Read the ready file descriptors which resets the counter of the
+			 * eventfd and the expirations of the timerfd. The eventfd is read
+			 * before the number of detach requests so that the detach requests
+			 * made after reading the number always wake up the thread again.
+			 */
+			is_due = false;
+			for (e = 0; e < event_count; ++e) {
+				if (read(events[e].data.fd, &count, sizeof(count)) == -1) {
+					if ((errno == EAGAIN) || (errno == EINTR)) { continue; }
+					EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+				}
+				if (events[e].data.fd == handler->timer_fd) {
+					is_due = true;
+				}
+			}
+			if (is_due) {
+				time_since_create = next_wakeup;
+			}
+
+			/* Disable cancellation. */
+			if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+				EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+			}
+
+			/* Lock alarm_cancel_mutex. */
+			if (pthread_mutex_lock(&alarm_cancel_mutex) != 0) {
+				EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+			}
+
+			/*
+			 * Critical Section:
+			 * Move the alarms which have been posted to this thread's inbox since
+			 * it last woke up to its schedule, so that each of them is printed for
+			 * the first time wait_time seconds after it has been posted. This is
+			 * done before the detach requests are checked since they may refer
+			 * to these alarms as well.
+			 *
+			 * The whole inbox is taken at once by swapping its head with NULL,
+			 * since it is pushed to without any lock(see post_alarm). It is still
+			 * taken while alarm_cancel_mutex is locked, so that every alarm posted
+			 * before a detach request that is seen below has been taken as well.
+			 * The inbox is a stack, so it is reversed into the order of posting.
+			 */
+			posted_head = NULL;
+			curr_alarm = __sync_lock_test_and_set(&(handler->inbox_head), NULL);
+			while (curr_alarm != NULL) {
+				next_posted = curr_alarm->inbox_link;
+				curr_alarm->inbox_link = posted_head;
+				posted_head = curr_alarm;
+				curr_alarm = next_posted;
+			}
+			if (posted_head != NULL) {
+				/* A lingering thread resumes handling alarms instead of retiring. */
+				if (is_lingering) {
+					++alarm_threads_resumed;
 				}
 
-				/* Signal alarm_cancel_cond_var. */
-				if (pthread_cond_signal(&alarm_cancel_cond_var) != 0) {
-					EXIT_ERR(COND_VAR_SIGNAL_ERR_MSG, COND_VAR_SIGNAL_ERR);
+				if (clock_gettime(CLOCK_MONOTONIC, &current) != 0) {
+					EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
 				}
-				/* In the Linux implementation, sched_yield() always succeeds. */
-				if (sched_yield() != 0) {
-					EXIT_ERR(CPU_YIELD_ERR_MSG, CPU_YIELD_ERR);
+				elapsed = (uint_fast64_t) (current.tv_sec - start.tv_sec);
+				if ((elapsed != 0) && (current.tv_nsec < start.tv_nsec)) {
+					--elapsed;
 				}
-			} else { /* (!curr_alarm->is_replaced) && (!curr_alarm->is_cancelled) */
+				if (elapsed < time_since_create) {
+					elapsed = time_since_create;
+				}
+
 				/*
-				 * If the current alarm that we are looking at, has a wait time
-				 * that is a divisor of time_since_create, then it means that it
-				 * should be printed. The reason is that time_since_create is
-				 * incremented by 1 every second therefore in the given situation,
-				 * it means that the proper amount of time(the alarm's wait_time
-				 * seconds) has passed since the last time the alarm's message was
-				 * printed.
+				 * This thread's clock is advanced to the current time if it has
+				 * woken up before its next wakeup(or if it is lingering), since
+				 * no alarm is due before then, so that the posted alarms are due
+				 * wait_time seconds after they have been posted.
 				 */
-				if ((time_since_create % curr_alarm->wait_time) == 0) {
+				if (((!is_due) && (elapsed < next_wakeup)) || (schedule.size == 0)) {
+					time_since_create = elapsed;
+				}
+
+				for (curr_alarm = posted_head; curr_alarm != NULL; curr_alarm = curr_alarm->inbox_link) {
+					if (insert_last_scheduled_alarm(&schedule, curr_alarm, elapsed) != 0) {
+						EXIT_ERR(ALLOC_SCHEDULE_ERR_MSG, ALLOC_SCHEDULE_ERR);
+					}
+
+					/* Print status message informing the user of the internal state. */
 					fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
 								" and message number = %" PRIuFAST32 \
-								" being printed by Alarm thread with ID = %" \
-								PRIuFAST64 " at %" PRIuFAST64 ".\nAlarm message: |%s|\n",
-								msg_type, curr_alarm->msg_num, id, now(), curr_alarm->msg);
+								" has been assigned to Alarm thread with ID = %" \
+								PRIuFAST64 " at %" PRIuFAST64 ".\n", msg_type,
+								curr_alarm->msg_num, id, now());
+				}
+			}
+
+			/*
+			 * Read the number of detach requests which also guarantees that
+			 * the flags of the alarms that they refer to are visible.
+			 */
+			detach_requests = handler->detach_requests;
+
+			/*
+			 * Only check the flags of the alarms if there are new detach
+			 * requests. The remaining alarms are compacted towards the front
+			 * of their buckets which keeps them in the same relative order
+			 * and the buckets which become empty are removed.
+			 *
+			 * The alarms are detached while alarm_cancel_mutex is still locked
+			 * so that every command handler thread which is waiting for any of
+			 * them, sees all of them detached(and alarm_count updated) at once.
+			 * Many command handler threads may be waiting on alarm_cancel_cond_var
+			 * which is why it is broadcast(only once) rather than signalled.
+			 */
+			if (detach_requests != detach_seen) {
+				detach_seen = detach_requests;
+
+				for (b = 0; b < schedule.size; ++b) {
+					bucket = &(schedule.bucket[b]);
+
+					for (i = 0, j = 0; i < bucket->size; ++i) {
+						curr_alarm = bucket->alarm[i];
+
+						if ((curr_alarm->is_replaced) || (curr_alarm->is_cancelled)) {
+							/* Print status message informing the user of the internal state. */
+							fprintf(app_log, "Alarm thread with ID = %" PRIuFAST64 \
+										" stopped printing %s alarm with message type = %" \
+										PRIuFAST32 " and message number = %" PRIuFAST32 \
+										" at %" PRIuFAST64 ".\n", id,
+										(curr_alarm->is_replaced ? "replaced" : "cancelled"),
+										msg_type, curr_alarm->msg_num, now());
+
+							/*
+							 * Reset the element saved in curr_alarm. Its handler
+							 * pointer is reset by the command handler thread which
+							 * has made the detach request(see end_detach_request).
+							 */
+							curr_alarm->is_assigned = false;
+
+							/* Update the number of handled alarms(see post_alarm). */
+							(void) __sync_fetch_and_sub(&(handler->alarm_count), 1);
+						} else { /* (!curr_alarm->is_replaced) && (!curr_alarm->is_cancelled) */
+							/* Keep the alarm by moving it to index j. */
+							bucket->alarm[j++] = curr_alarm;
+						}
+					}
+					bucket->size = j;
 				}
+				remove_empty_alarm_buckets(&schedule);
 
-				/* Move to the next element. */
-				prev_alarm = curr_alarm;
-				curr_alarm = curr_alarm->link_handle;
+				/* Broadcast alarm_cancel_cond_var. */
+				if (pthread_cond_broadcast(&alarm_cancel_cond_var) != 0) {
+					EXIT_ERR(COND_VAR_BROADCAST_ERR_MSG, COND_VAR_BROADCAST_ERR);
+				}
 			}
-		}
 
-		/* Check to see if this thread is still handling any alarms. */
-		if (handle_list_head == NULL) {
-			/* Print status message informing the user of the internal state. */
-			fprintf(app_log, "Alarm thread with ID = %" PRIuFAST64 \
-						" handling alarms with message type = %" \
-						PRIuFAST32 " is self terminating at %" \
-						PRIuFAST64 ".\n", id, msg_type, now());
+			/* Unlock alarm_cancel_mutex. */
+			if (pthread_mutex_unlock(&alarm_cancel_mutex) != 0) {
+				EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+			}
+
+			/* Enable cancellation. */
+			if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+				EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+			}
+
+			/*
+			 * Print all of the alarms that are due once the next wakeup has
+			 * been reached. The alarms of a bucket are due when its period has
+			 * passed since the last time they were printed(or since they were
+			 * assigned to this thread), i.e., when its due time has been reached.
+			 *
+			 * Only the due times of the buckets are scanned and the alarms
+			 * themselves are only accessed when their bucket is due.
+			 *
+			 * The records of the due alarms are gathered into the output block
+			 * with the time computed once and then printed with a single write,
+			 * so that many alarms firing at once cost a single locked write on
+			 * app_log rather than one formatted print per alarm.
+			 *
+			 * The alarms may be replaced in place by the command handler threads
+			 * in the meantime so each of them is read through its sequence lock
+			 * (see read_alarm). The ones whose message type has been replaced
+			 * are no longer printed by this thread and are only kept until it
+			 * detaches them, as their replacement is published before the detach
+			 * request is seen. The ones whose wait time has been replaced are
+			 * then moved out of their bucket and into the one of their new
+			 * period, which is done while alarm_cancel_mutex is locked so that
+			 * their wait times cannot be replaced again while they are moved.
+			 */
+			if (is_due) {
+				timestamp = now();
+
+				for (b = 0; b < schedule.size; ++b) {
+					if (schedule.next_due[b] > time_since_create) { continue; }
+					bucket = &(schedule.bucket[b]);
+
+					for (i = 0, j = 0; i < bucket->size; ++i) {
+						curr_alarm = bucket->alarm[i];
+
+						read_alarm(curr_alarm, &snapshot);
+						if (snapshot.msg_type != msg_type) {
+							/* Keep the alarm by moving it to index j. */
+							bucket->alarm[j++] = curr_alarm;
+							continue;
+						}
+						if (append_alarm_record(&output, &snapshot, id, timestamp) != 0) {
+							EXIT_ERR(ALLOC_OUTPUT_ERR_MSG, ALLOC_OUTPUT_ERR);
+						}
+
+						if (snapshot.wait_time != schedule.period[b]) {
+							curr_alarm->inbox_link = moved_head;
+							moved_head = curr_alarm;
+						} else { /* (snapshot.wait_time == schedule.period[b]) */
+							/* Keep the alarm by moving it to index j. */
+							bucket->alarm[j++] = curr_alarm;
+						}
+					}
+					bucket->size = j;
+					schedule.next_due[b] += schedule.period[b];
+				}
+
+				if (moved_head != NULL) {
+					/* Disable cancellation. */
+					if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+						EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+					}
+
+					/* Lock alarm_cancel_mutex. */
+					if (pthread_mutex_lock(&alarm_cancel_mutex) != 0) {
+						EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+					}
+
+					while (moved_head != NULL) {
+						curr_alarm = moved_head;
+						moved_head = moved_head->inbox_link;
+						curr_alarm->inbox_link = NULL;
+
+						if (insert_last_scheduled_alarm(&schedule, curr_alarm, time_since_create) != 0) {
+							EXIT_ERR(ALLOC_SCHEDULE_ERR_MSG, ALLOC_SCHEDULE_ERR);
+						}
+
+						/* Print status message informing the user of the internal state. */
+						fprintf(app_log, "Alarm thread with ID = %" PRIuFAST64 \
+									" prints alarm with message type = %" PRIuFAST32 \
+									" and message number = %" PRIuFAST32 \
+									" every %" PRIuFAST32 " seconds from %" PRIuFAST64 " on.\n",
+									id, msg_type, curr_alarm->msg_num, curr_alarm->wait_time, now());
+					}
+					remove_empty_alarm_buckets(&schedule);
+
+					/* Unlock alarm_cancel_mutex. */
+					if (pthread_mutex_unlock(&alarm_cancel_mutex) != 0) {
+						EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+					}
+
+					/* Enable cancellation. */
+					if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+						EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+					}
+				}
+
+				if (output.records != 0) {
+					/* Disable cancellation so that the block is written whole. */
+					if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+						EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+					}
+
+					if (fwrite(output.text, sizeof(char), output.size, app_log) != output.size) {
+						EXIT_ERR(STREAM_ERR_MSG, STREAM_ERR);
+					}
+
+					/* Update the counters and empty the output block. */
+					handler->fired_records += output.records;
+					++(handler->fired_writes);
+					output.size = 0; output.records = 0;
+
+					/* Enable cancellation. */
+					if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+						EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+					}
+				}
+			}
+
+			/*
+			 * Check to see if this thread is still handling any alarms. If not,
+			 * then it lingers, during which it stays one of the live alarm handler
+			 * threads of its shard so the alarms of its message type which are
+			 * inserted are still posted to it, and then tries to retire. It is
+			 * reused for another type B command if it has been parked.
+			 */
+			if (schedule.size != 0) {
+				is_lingering = false;
+				continue;
+			}
+
+			if (!is_lingering) {
+				if (clock_gettime(CLOCK_MONOTONIC, &current) != 0) {
+					EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+				}
+				elapsed = (uint_fast64_t) (current.tv_sec - start.tv_sec);
+				if ((elapsed != 0) && (current.tv_nsec < start.tv_nsec)) {
+					--elapsed;
+				}
+				if (elapsed > time_since_create) {
+					time_since_create = elapsed;
+				}
+				linger_until = time_since_create + ALARM_HANDLER_LINGER;
+				is_lingering = true;
+
+				/* Print status message informing the user of the internal state. */
+				fprintf(app_log, "Alarm thread with ID = %" PRIuFAST64 \
+							" handling alarms with message type = %" \
+							PRIuFAST32 " has no alarms left and is lingering for %d" \
+							" seconds at %" PRIuFAST64 ".\n", id, msg_type,
+							ALARM_HANDLER_LINGER, now());
+			}
+
+			if (time_since_create >= linger_until) {
+				/* Disable cancellation. */
+				if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+					EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+				}
+
+				retired = alarm_handler_retire(handler, detach_seen);
+				if (retired == -1) {
+					/* Terminate and cleanup this thread. */
+					pthread_exit(NULL);
+				} else if (retired == 1) {
+					/* Wait(parked) until this thread is reused. */
+					handler = alarm_handler_park(handler);
+					break;
+				}
+
+				/* Try to retire again a second later unless alarms are posted in the meantime. */
+				linger_until = time_since_create + 1;
 
-			/* Terminate and cleanup this thread. */
-			pthread_exit(arg);
+				/* Enable cancellation. */
+				if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+					EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+				}
+			}
 		}
 	}
 
@@ -314,33 +716,319 @@ void * alarm_handler(void *arg) {
 	 * handler is established only during the execution of a specified
 	 * section of code.
 	 *
-	 * Therefore, the following call is needed to pair the call to
+	 * Therefore, the following calls are needed to pair the calls to
 	 * pthread_cleanup_push made in the beginning of this thread's
-	 * execution.
+	 * execution(one for the schedule and one for the output block).
 	 *
-	 * The pop is however placed in a section of code that will never be
-	 * reached since every alarm handling thread is meant to be cancelled
-	 * by the main thread which is when the cleanup routines will be
-	 * actually popped and executed.
+	 * The pops are however placed in a section of code that will never be
+	 * reached since every alarm handling thread is either cancelled by the
+	 * main thread or terminates after retiring which is when the cleanup
+	 * routines will be actually popped and executed.
 	 */
 	pthread_cleanup_pop(1);
+	pthread_cleanup_pop(1);
 
 
 
 	/* This return will never be reached. */
-	return arg;
+	return NULL;
+}
+
+/*
+ * The only invocations of this function should be from the alarm handler threads.
+ *
+ * Retire the alarm handler thread of the given type B command node(handler)
+ * which has no alarms left, unless alarms have been posted to it or detach
+ * requests made to it in the meantime, which are detected through the given
+ * number of detach requests that it has already processed(detach_seen).
+ *
+ * The thread is removed from the live alarm handler threads of its shard and
+ * its node from the commands list. The node is then either parked in the pool
+ * of alarm handler threads or freed, in which case the thread is detached so
+ * that it terminates on its own. The caller's cancellation must be disabled.
+ *
+ * The thread does not retire either while cmd_mutex is locked by another
+ * thread, in which case it has to try again later.
+ *
+ * Returns:
+ * 		1. -1	if the thread has retired and has to terminate
+ * 		2.  0	if the thread has not retired
+ * 		3.  1	if the thread has retired and has been parked
+ */
+int alarm_handler_retire(CmdB *handler, const uint_fast64_t detach_seen) {
+	/* Stores the return value of the current method. */
+	int result = 0;
+
+
+
+	/* Save the current thread(alarm handler)'s ID. */
+	const uint_fast64_t id = (uint_fast64_t) pthread_self();
+	/* The shard of the alarms list which stores the alarms of the thread. */
+	AlarmShard *shard = ALARM_SHARD(handler->msg_type);
+	/* Command type B pointers used for iterating over the commands list. */
+	CmdB *curr_cmdb = NULL, *prev_cmdb = NULL;
+	/* Used to disarm the thread's timerfd. */
+	struct itimerspec timer;
+	/* Whether the thread retires. */
+	bool is_retiring = false;
+
+	/* Stores the return status of functions. */
+	int status = 0;
+
+
+
+	/*
+	 * Lock cmd_mutex first since alarm_cancel_mutex is never held while
+	 * cmd_mutex is being locked. The thread must not block on cmd_mutex
+	 * though, since a command handler thread may hold it while waiting for
+	 * the reader lock on a shard whose writer is in turn waiting for this
+	 * thread to detach its alarms(see cmd_handler_detach_alarms), so it only
+	 * tries to lock it. No thread retires once the main thread has started
+	 * cancelling the alarm handler threads, since it then cancels and joins
+	 * with every thread of the commands list(and of the pool) so the thread
+	 * just waits to be cancelled.
+	 */
+	status = pthread_mutex_trylock(&cmd_mutex);
+	if (status == EBUSY) {
+		return 0;
+	} else if (status != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+
+	if (!alarm_threads_cancelled) {
+		/* Lock the handler_mutex of the shard and then alarm_cancel_mutex. */
+		if (pthread_mutex_lock(&(shard->handler_mutex)) != 0) {
+			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+		if (pthread_mutex_lock(&alarm_cancel_mutex) != 0) {
+			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+
+		/*
+		 * The thread only retires if nothing has been posted to its inbox
+		 * and no detach request has been made to it since it has last
+		 * checked and none of the command handler threads which have made
+		 * detach requests to it may still access its node. Once it has been
+		 * removed from the live alarm handler threads of its shard, no more
+		 * alarms can be posted to it.
+		 */
+		if ((handler->alarm_count == 0) && (handler->inbox_head == NULL) &&
+			(handler->detach_waiters == 0) && (handler->detach_requests == detach_seen)) {
+
+			remove_alarm_handler(&(shard->handler_list_head), handler);
+			is_retiring = true;
+		}
+
+		/* Unlock alarm_cancel_mutex and the handler_mutex of the shard. */
+		if (pthread_mutex_unlock(&alarm_cancel_mutex) != 0) {
+			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+		if (pthread_mutex_unlock(&(shard->handler_mutex)) != 0) {
+			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+	}
+
+	if (is_retiring) {
+		/*
+		 * Remove the thread's node from the commands list so that the
+		 * parsers accept new type B commands of its message type again.
+		 */
+		prev_cmdb = NULL;
+		for (curr_cmdb = cmdb_list_head; curr_cmdb != handler; curr_cmdb = curr_cmdb->link) {
+			prev_cmdb = curr_cmdb;
+		}
+		if (prev_cmdb == NULL) {
+			cmdb_list_head = handler->link;
+		} else { /* (prev_cmdb != NULL) */
+			prev_cmdb->link = handler->link;
+		}
+		if (handler == cmdb_list_tail) {
+			cmdb_list_tail = prev_cmdb;
+		}
+		if (handler == cmdb_list_new_elm) {
+			cmdb_list_new_elm = handler->link;
+		}
+		handler->link = NULL;
+		--alarm_threads_running;
+
+		/* Disarm the thread's timerfd. */
+		timer.it_interval.tv_sec = 0; timer.it_interval.tv_nsec = 0;
+		timer.it_value.tv_sec = 0; timer.it_value.tv_nsec = 0;
+		if (timerfd_settime(handler->timer_fd, 0, &timer, NULL) != 0) {
+			EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+		}
+
+		if (alarm_pool_size < ALARM_HANDLER_POOL) {
+			/* Park the thread in the pool with its node. */
+			handler->next_handler = NULL;
+			handler->link = alarm_pool_head;
+			alarm_pool_head = handler;
+			++alarm_pool_size;
+			result = 1;
+		} else { /* (alarm_pool_size >= ALARM_HANDLER_POOL) */
+			/* Nobody is going to join with the thread so detach it. */
+			if (pthread_detach(pthread_self()) != 0) {
+				EXIT_ERR(THREAD_DETACH_ERR_MSG, THREAD_DETACH_ERR);
+			}
+			result = -1;
+		}
+
+		/* Print status message informing the user of the internal state. */
+		fprintf(app_log, "Alarm thread with ID = %" PRIuFAST64 \
+					" handling alarms with message type = %" \
+					PRIuFAST32 " is %s at %" \
+					PRIuFAST64 " after printing %" PRIuFAST64 \
+					" alarms in %" PRIuFAST64 " writes.\n", id, handler->msg_type,
+					((result == 1) ? "retiring to the pool" : "self terminating"),
+					now(), handler->fired_records, handler->fired_writes);
+
+		if (result == -1) {
+			close_alarm_wakeup(handler);
+			free(handler);
+		}
+	}
+
+	/* Unlock cmd_mutex. */
+	if (pthread_mutex_unlock(&cmd_mutex) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+
+
+
+	return result;
+}
+
+/*
+ * The only invocations of this function should be from the alarm handler threads.
+ *
+ * Wait until the parked alarm handler thread of the given type B command node
+ * (handler) is reused for a new type B command and then free the node. The
+ * caller's cancellation must be disabled and it is only enabled while waiting.
+ *
+ * Returns: Pointer to the type B command node that the thread is reused for
+ */
+CmdB * alarm_handler_park(CmdB *handler) {
+	/*
+	 * The type B command node that the thread is reused for, which is
+	 * volatile since it is modified after pthread_cleanup_push.
+	 */
+	CmdB * volatile next_handler = NULL;
+	/* The events of the eventfd and the timerfd of the thread and their number. */
+	struct epoll_event events[2];
+	int event_count = 0, e = 0;
+	/* The counter of the eventfd or the number of expirations of the timerfd. */
+	uint64_t count = 0;
+	/* Dummy variable used when setting the cancel state of the thread. */
+	int old_state = 0;
+
+
+
+	/*
+	 * The node is freed by the main thread if the thread is cancelled while
+	 * it is still in the pool and by the cleanup routine otherwise.
+	 */
+	pthread_cleanup_push(cleanup_alarm_park, (void *) handler);
+
+	/*
+	 * The command handler thread which reuses the thread writes its eventfd
+	 * after handing it the new node(while cmd_mutex is locked), so the node
+	 * is always read after a wakeup which cannot be lost.
+	 */
+	while (next_handler == NULL) {
+		/* Enable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+		}
+
+		/* epoll_wait is a cancellation point. */
+		event_count = epoll_wait(handler->epoll_fd, events, 2, -1);
+		if (event_count == -1) {
+			if (errno != EINTR) {
+				EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+			}
+			event_count = 0;
+		}
+		for (e = 0; e < event_count; ++e) {
+			if (read(events[e].data.fd, &count, sizeof(count)) == -1) {
+				if ((errno == EAGAIN) || (errno == EINTR)) { continue; }
+				EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+			}
+		}
+
+		/* Disable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+		}
+
+		/* Lock cmd_mutex. */
+		if (pthread_mutex_lock(&cmd_mutex) != 0) {
+			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+		next_handler = handler->next_handler;
+		/* Unlock cmd_mutex. */
+		if (pthread_mutex_unlock(&cmd_mutex) != 0) {
+			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+	}
+
+	pthread_cleanup_pop(0);
+
+	/* The node has been taken out of the pool so nobody else accesses it. */
+	close_alarm_wakeup(handler);
+	free(handler);
+
+
+
+	return next_handler;
+}
+
+/*
+ * The parked alarm handler thread cleanup routine, which frees its previous
+ * type B command node once it has been taken out of the pool.
+ *
+ * Precondition: arg can be safely casted into (CmdB *).
+ */
+void cleanup_alarm_park(void *arg) {
+	/* The type B command node of the parked thread. */
+	CmdB *handler = (CmdB *) arg;
+	/* The type B command node that the thread has been reused for(if any). */
+	CmdB *next_handler = NULL;
+
+
+
+	/*
+	 * The main thread has already set alarm_threads_cancelled and no longer
+	 * holds cmd_mutex while joining with the cancelled threads.
+	 */
+	if (pthread_mutex_lock(&cmd_mutex) != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+	next_handler = handler->next_handler;
+	if (pthread_mutex_unlock(&cmd_mutex) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+
+	/*
+	 * Once the thread has been reused, the reader lock on the shard of the new
+	 * node has been obtained on its behalf, which it still has to release.
+	 */
+	if (next_handler != NULL) {
+		release_alarm_read_lock(ALARM_SHARD(next_handler->msg_type), NULL);
+		close_alarm_wakeup(handler);
+		free(handler);
+	}
 }
 
 /*
  * The alarm handler thread cleanup routine.
  *
- * Precondition: arg can be safely casted into (Alarm *).
+ * Precondition: arg can be safely casted into (AlarmSchedule *).
  */
 void cleanup_alarm_handler(void *arg) {
-	/* Head of the alarms list which the thread was handling. */
-	Alarm *handle_list_head = (Alarm *) arg;
-	/* Alarm pointer used for iterating over the alarms list. */
-	Alarm *curr_alarm = NULL;
+	/* Schedule of the alarms which the thread was handling. */
+	AlarmSchedule *schedule = (AlarmSchedule *) arg;
+	/* Indices used for iterating over the schedule. */
+	size_t b = 0, i = 0;
 
 	/*
 	 * No need to obtain any locks since all accessed parts of the
@@ -357,22 +1045,26 @@ void cleanup_alarm_handler(void *arg) {
 	 */
 
 	/*
-	 * Set each node's link_handle attribute in the thread's alarms
-	 * list to NULL(i.e. detach them to prevent segmentation fault),
-	 * is_assigned to false, and finally handler_id to NULL as well.
+	 * Set each alarm's is_assigned attribute in the thread's schedule
+	 * to false and handler to NULL as well. Then free the memory
+	 * allocated to the schedule's arrays. When the thread retires
+	 * and terminates, the schedule is already empty.
 	 */
-	while (handle_list_head != NULL) {
-		/* Save the current first element. */
-		curr_alarm = handle_list_head;
-		/* Move to the next element. */
-		handle_list_head = handle_list_head->link_handle;
-
-		/*
-		 * Remove the element saved in curr_alarm
-		 * from the thread's handled alarms list.
-		 */
-		curr_alarm->link_handle = NULL;
-		curr_alarm->is_assigned = false;
-		curr_alarm->handler_id = NULL;
+	for (b = 0; b < schedule->size; ++b) {
+		for (i = 0; i < schedule->bucket[b].size; ++i) {
+			schedule->bucket[b].alarm[i]->is_assigned = false;
+			schedule->bucket[b].alarm[i]->handler = NULL;
+		}
 	}
+	free_alarm_schedule(schedule);
+}
+
+/*
+ * The alarm handler thread output block cleanup routine.
+ *
+ * Precondition: arg can be safely casted into (AlarmOutput *).
+ */
+void cleanup_alarm_output(void *arg) {
+	/* Free the memory allocated to the thread's output block. */
+	free_alarm_output((AlarmOutput *) arg);
 }
@@ -0,0 +1,446 @@
+/**************************************************************************
+ *
+ * Author:
+ * 					Ashkan Moatamed
+ *
+ *
+ *
+ * alarm_table.c
+ *
+ *
+ *
+ * Implementation of the Shared Alarm Table
+ * Functions defined in alarm_app.h
+ *
+ *************************************************************************/
+
+/* Declare variables and function prototypes specified in alarm_app.h */
+#include "alarm_app.h"
+
+/*
+ * Map the shared alarm table with the given name(see ALARM_TABLE_NAME)
+ * into this process(see alarm_table). A table which already exists and
+ * is valid is attached to(*is_attached is set) while a new or invalid
+ * one is initialized.
+ *
+ * Precondition: name != NULL
+ *
+ * Returns: 0 on success or ALARM_TABLE_ERR otherwise
+ */
+int open_alarm_table(const char *name, bool *is_attached) {
+	/* The size of the table along with all of its records. */
+	const size_t size = sizeof(AlarmTable) + ALARM_TABLE_CAPACITY * sizeof(AlarmRecord);
+
+
+
+	/* The status of the segment. */
+	struct stat info;
+	/* The lock of the entire segment. */
+	struct flock table_lock;
+	/* The address that the segment is mapped at. */
+	void *addr = NULL;
+	/* The file descriptor of the segment. */
+	int fd = -1;
+	/* Is the existing table valid? */
+	bool is_valid = false;
+	/* Offset of the current record. */
+	uint64_t offset = 0;
+	/* Used for iterating over the records and the hash chains. */
+	size_t i = 0;
+
+
+
+	*is_attached = false;
+
+	/*
+	 * Open the segment(or the persistent alarm store), which is created
+	 * (empty) if it does not exist yet, and fail right away if another
+	 * process is using it. The file descriptor is kept open until
+	 * close_alarm_table since closing it would release the lock.
+	 */
+	#ifdef ALARM_TABLE_FILE
+		fd = open(name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	#else
+		fd = shm_open(name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	#endif
+	if (fd == -1) {
+		return ALARM_TABLE_ERR;
+	}
+	table_lock.l_type = F_WRLCK;
+	table_lock.l_whence = SEEK_SET;
+	table_lock.l_start = 0;
+	table_lock.l_len = 0;
+	if (fcntl(fd, F_SETLK, &table_lock) != 0) {
+		close(fd);
+		return ALARM_TABLE_ERR;
+	}
+
+	/* Resize the segment if it does not have the size of the table and map it. */
+	if ((fstat(fd, &info) != 0) ||
+		(((size_t) info.st_size != size) && (ftruncate(fd, (off_t) size) != 0))) {
+
+		close(fd);
+		return ALARM_TABLE_ERR;
+	}
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED) {
+		close(fd);
+		return ALARM_TABLE_ERR;
+	}
+	alarm_table = (AlarmTable *) addr;
+	alarm_table_fd = fd;
+
+	/*
+	 * The table is valid if it has been initialized(by this or another
+	 * process) with the same layout.
+	 */
+	is_valid = ((size_t) info.st_size == size) &&
+				(alarm_table->magic == ALARM_TABLE_MAGIC) &&
+				(alarm_table->version == ALARM_TABLE_VERSION) &&
+				(alarm_table->size == size) &&
+				(alarm_table->capacity == ALARM_TABLE_CAPACITY) &&
+				(alarm_table->buckets == ALARM_TABLE_BUCKETS) &&
+				(alarm_table->record_size == sizeof(AlarmRecord));
+
+	/*
+	 * No other process can be using the table, so its semaphore is
+	 * reinitialized in case the last process has crashed while holding
+	 * it. Its records are only verified(which reads all of them) if it
+	 * has not been closed cleanly since an update may have been cut
+	 * short, or else the header is all that has been read. It is then
+	 * marked as open until close_alarm_table.
+	 */
+	if (is_valid) {
+		if (sem_init(&(alarm_table->lock), 1, 1) != 0) {
+			/* Unmap the table without marking it as closed cleanly. */
+			munmap(addr, size);
+			close(fd);
+			alarm_table = NULL;
+			alarm_table_fd = -1;
+			return ALARM_TABLE_ERR;
+		}
+		if (alarm_table->is_clean == 0) {
+			is_valid = is_valid_alarm_table();
+		}
+	}
+	alarm_table->is_clean = 0;
+
+	/* Attach to the valid table. */
+	if (is_valid) {
+		*is_attached = true;
+		return 0;
+	}
+
+	/*
+	 * Initialize the table with empty hash chains and all of its records
+	 * in the free records list(in order). The magic number is written last
+	 * so that no process reads a partially initialized table.
+	 */
+	alarm_table->magic = 0;
+	alarm_table->version = ALARM_TABLE_VERSION;
+	alarm_table->size = size;
+	alarm_table->capacity = ALARM_TABLE_CAPACITY;
+	alarm_table->buckets = ALARM_TABLE_BUCKETS;
+	alarm_table->record_size = sizeof(AlarmRecord);
+	if (sem_init(&(alarm_table->lock), 1, 1) != 0) {
+		close_alarm_table();
+		return ALARM_TABLE_ERR;
+	}
+	alarm_table->count = 0;
+	for (i = 0; i < ALARM_TABLE_BUCKETS; ++i) {
+		alarm_table->bucket[i] = 0;
+	}
+	alarm_table->free_head = 0;
+	for (i = ALARM_TABLE_CAPACITY; i != 0; --i) {
+		offset = (uint64_t) (sizeof(AlarmTable) + (i - 1) * sizeof(AlarmRecord));
+		ALARM_RECORD(offset)->next = alarm_table->free_head;
+		alarm_table->free_head = offset;
+	}
+	ALARM_SEQ_BARRIER();
+	alarm_table->magic = ALARM_TABLE_MAGIC;
+
+
+
+	return 0;
+}
+
+/*
+ * Verify every hash chain and the free records list of the mapped
+ * alarm table, i.e., that all of their offsets point to records of the
+ * table, that every record is in exactly one of them and that the
+ * records of each hash chain have message numbers of the chain.
+ *
+ * Returns: true if and only if the table is consistent
+ */
+bool is_valid_alarm_table(void) {
+	/* The number of records found in the hash chains and in the free records list. */
+	uint64_t used = 0, found = 0;
+	/* Offset of the current record. */
+	uint64_t offset = 0;
+	/* Used for iterating over the hash chains. */
+	size_t bucket = 0;
+
+
+
+	/*
+	 * Every offset has to be the one of a record of the table. Stopping
+	 * once more records than the capacity have been found also stops at
+	 * any cycle.
+	 */
+	for (bucket = 0; bucket <= ALARM_TABLE_BUCKETS; ++bucket) {
+		offset = (bucket < ALARM_TABLE_BUCKETS) ? alarm_table->bucket[bucket] : alarm_table->free_head;
+		for (/* offset is already set. */; offset != 0; offset = ALARM_RECORD(offset)->next) {
+			if ((offset < sizeof(AlarmTable)) || (offset >= alarm_table->size) ||
+				((offset - sizeof(AlarmTable)) % sizeof(AlarmRecord) != 0) ||
+				(++found > ALARM_TABLE_CAPACITY)) {
+
+				return false;
+			}
+			if (bucket < ALARM_TABLE_BUCKETS) {
+				if (ALARM_RECORD(offset)->msg_num % ALARM_TABLE_BUCKETS != bucket) {
+					return false;
+				}
+				++used;
+			}
+		}
+	}
+
+
+
+	return (found == ALARM_TABLE_CAPACITY) && (used == alarm_table->count);
+}
+
+/*
+ * The only invocations of this function should be from the main thread.
+ *
+ * Insert an alarm into the alarms list for every record of the shared
+ * alarm table, exactly as if a type A command had been applied for it,
+ * before any other thread has been created. data_ptr is used exactly as
+ * in insert_cmd.
+ *
+ * Returns: The number of inserted alarms
+ */
+uint_fast64_t restore_alarm_table(MLData *data_ptr) {
+	/* Stores the return value of the current method. */
+	uint_fast64_t result = 0;
+
+
+
+	/* The shard of the alarms list which stores the current alarm. */
+	AlarmShard *shard = NULL;
+	/* Pointer to the new alarm node. */
+	Alarm *new_alarm = NULL;
+	/* Pointer to the current record. */
+	const AlarmRecord *record = NULL;
+	/* Offset of the current record. */
+	uint64_t offset = 0;
+	/* Used for iterating over the hash chains. */
+	size_t bucket = 0;
+
+
+
+	/*
+	 * Lock the table so that other processes do not modify it in the
+	 * meantime. insert_alarm does not need alarm_cancel_mutex since no
+	 * alarm can be assigned before any other thread of this process exists.
+	 */
+	if (sem_wait(&(alarm_table->lock)) != 0) {
+		EXIT_CMD(data_ptr, SEM_WAIT_ERR_MSG, SEM_WAIT_ERR);
+	}
+
+	for (bucket = 0; bucket < ALARM_TABLE_BUCKETS; ++bucket) {
+		for (offset = alarm_table->bucket[bucket]; offset != 0; offset = record->next) {
+			record = ALARM_RECORD(offset);
+
+			/* Allocate memory for the new alarm node. */
+			new_alarm = MALLOC_ALARM((uint_fast32_t) record->msg_num);
+			if (new_alarm == NULL) {
+				sem_post(&(alarm_table->lock));
+				EXIT_CMD(data_ptr, ALLOC_ALARM_ERR_MSG, ALLOC_ALARM_ERR);
+			}
+
+			/* Initialize the new alarm node's attributes. */
+			new_alarm->link = NULL;
+			new_alarm->wait_time = (uint_fast32_t) record->wait_time;
+			new_alarm->msg_type = (uint_fast32_t) record->msg_type;
+			new_alarm->msg_num = (uint_fast32_t) record->msg_num;
+			memcpy(new_alarm->msg, record->msg, MAX_MSG_LEN);
+			new_alarm->msg[MAX_MSG_LEN] = '\0';
+			new_alarm->is_assigned = false;
+			new_alarm->handler = NULL;
+			new_alarm->is_replaced = false;
+			new_alarm->is_cancelled = false;
+			new_alarm->seq = 0;
+			new_alarm->cmda_seq = 0;
+			/* express and lanes are set by insert_alarm. */
+			new_alarm->inbox_link = NULL;
+
+			/* Insert the new alarm into its shard of the alarms list. */
+			shard = ALARM_SHARD(new_alarm->msg_type);
+			insert_alarm(&(shard->alarm_list_head), shard->alarm_express_head, new_alarm,
+						next_alarm, insert_first_alarm, insert_after_alarm,
+						&alarm_cancel_cond_var, &alarm_cancel_mutex);
+			++result;
+		}
+	}
+
+	if (sem_post(&(alarm_table->lock)) != 0) {
+		EXIT_CMD(data_ptr, SEM_SIGNAL_ERR_MSG, SEM_SIGNAL_ERR);
+	}
+
+
+
+	return result;
+}
+
+/*
+ * The only invocations of this function should be from the command handler threads.
+ *
+ * Store the given alarm in the shared alarm table, replacing the record
+ * with the same message number(if any). The alarm is only counted in
+ * alarm_table_overflows if the table is full.
+ *
+ * Precondition: alarm != NULL
+ */
+void put_alarm_record(const Alarm *alarm) {
+	/* The hash chain of the alarm's message number. */
+	uint64_t *bucket = &(alarm_table->bucket[alarm->msg_num % ALARM_TABLE_BUCKETS]);
+	/* Pointer to the alarm's record. */
+	AlarmRecord *record = NULL;
+	/* Offset of the alarm's record. */
+	uint64_t offset = 0;
+
+
+
+	/* Lock the table. */
+	if (sem_wait(&(alarm_table->lock)) != 0) {
+		EXIT_ERR(SEM_WAIT_ERR_MSG, SEM_WAIT_ERR);
+	}
+
+	/*
+	 * Search the hash chain for the record with the alarm's message number.
+	 * If there is none, then the first free record is moved to the front of
+	 * the hash chain.
+	 */
+	for (offset = *bucket; offset != 0; offset = ALARM_RECORD(offset)->next) {
+		if (ALARM_RECORD(offset)->msg_num == alarm->msg_num) { break; }
+	}
+	if (offset == 0) {
+		offset = alarm_table->free_head;
+		if (offset != 0) {
+			alarm_table->free_head = ALARM_RECORD(offset)->next;
+			ALARM_RECORD(offset)->next = *bucket;
+			*bucket = offset;
+			++(alarm_table->count);
+		} else { /* (offset == 0) */
+			++alarm_table_overflows;
+		}
+	}
+
+	/* Set the record's attributes. */
+	if (offset != 0) {
+		record = ALARM_RECORD(offset);
+		record->wait_time = (uint64_t) alarm->wait_time;
+		record->msg_type = (uint64_t) alarm->msg_type;
+		record->msg_num = (uint64_t) alarm->msg_num;
+		strcpy(record->msg, alarm->msg);
+	}
+
+	/* Unlock the table. */
+	if (sem_post(&(alarm_table->lock)) != 0) {
+		EXIT_ERR(SEM_SIGNAL_ERR_MSG, SEM_SIGNAL_ERR);
+	}
+}
+
+/*
+ * The only invocations of this function should be from the command handler threads.
+ *
+ * Remove the record with the given message number(if any) from the
+ * shared alarm table.
+ */
+void remove_alarm_record(const uint_fast32_t msg_num) {
+	/* Pointer to the offset(link) of the current record. */
+	uint64_t *offset_ptr = &(alarm_table->bucket[msg_num % ALARM_TABLE_BUCKETS]);
+	/* Offset of the removed record. */
+	uint64_t offset = 0;
+
+
+
+	/* Lock the table. */
+	if (sem_wait(&(alarm_table->lock)) != 0) {
+		EXIT_ERR(SEM_WAIT_ERR_MSG, SEM_WAIT_ERR);
+	}
+
+	/*
+	 * Search the hash chain for the record with the given message number
+	 * and move it from the hash chain to the front of the free records list.
+	 */
+	while ((*offset_ptr != 0) && (ALARM_RECORD(*offset_ptr)->msg_num != msg_num)) {
+		offset_ptr = &(ALARM_RECORD(*offset_ptr)->next);
+	}
+	if (*offset_ptr != 0) {
+		offset = *offset_ptr;
+		*offset_ptr = ALARM_RECORD(offset)->next;
+		ALARM_RECORD(offset)->next = alarm_table->free_head;
+		alarm_table->free_head = offset;
+		--(alarm_table->count);
+	}
+
+	/* Unlock the table. */
+	if (sem_post(&(alarm_table->lock)) != 0) {
+		EXIT_ERR(SEM_SIGNAL_ERR_MSG, SEM_SIGNAL_ERR);
+	}
+}
+
+/*
+ * Mark the shared alarm table as closed cleanly(once the persistent alarm
+ * store has been written back) and unmap it from this process, which also
+ * releases its lock. The segment(or the store) itself is kept so that the
+ * next process attaches to it.
+ *
+ * Returns: 0 on success or ALARM_TABLE_ERR otherwise
+ */
+int close_alarm_table(void) {
+	/* The size of the table along with all of its records. */
+	const size_t size = sizeof(AlarmTable) + ALARM_TABLE_CAPACITY * sizeof(AlarmRecord);
+
+
+
+	/* Stores the return status of functions. */
+	int status = 0;
+
+
+
+	/* The table is not initialized if its initialization has failed. */
+	if (alarm_table->magic != ALARM_TABLE_MAGIC) {
+		status = ALARM_TABLE_ERR;
+	}
+	#ifdef ALARM_TABLE_FILE
+		/* Only mark the store as closed cleanly once it has been fully written back. */
+		if ((status == 0) && (msync((void *) alarm_table, size, MS_SYNC) != 0)) {
+			status = ALARM_TABLE_ERR;
+		}
+	#endif
+	if (status == 0) {
+		alarm_table->is_clean = 1;
+		#ifdef ALARM_TABLE_FILE
+			if (msync((void *) alarm_table, sizeof(AlarmTable), MS_SYNC) != 0) {
+				status = ALARM_TABLE_ERR;
+			}
+		#endif
+	}
+	if (munmap((void *) alarm_table, size) != 0) {
+		status = ALARM_TABLE_ERR;
+	}
+	alarm_table = NULL;
+
+	/* Closing the segment(or the store) also releases its lock. */
+	if (close(alarm_table_fd) != 0) {
+		status = ALARM_TABLE_ERR;
+	}
+	alarm_table_fd = -1;
+
+
+
+	return status;
+}
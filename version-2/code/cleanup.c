@@ -38,6 +38,18 @@ void cleanup_main(void *arg) {
 	CmdB *curr_cmdb = NULL;
 	/* Command type C pointer used for iterating over the commands list. */
 	CmdC *curr_cmdc = NULL;
+	/* Command type D pointer used for iterating over the commands list. */
+	CmdD *curr_cmdd = NULL;
+	/* The current command handler thread(worker). */
+	CmdWorker *worker = NULL;
+	/* The number of commands applied by the command handler threads. */
+	uint_fast64_t applied = 0;
+	/* The resource usage of the application. */
+	struct rusage usage;
+	/* Used for iterating over the express lanes of the shards of the alarms list. */
+	size_t lane = 0;
+	/* The current shard of the alarms list. */
+	AlarmShard *shard = NULL;
 	/* Alarm pointer used for iterating over the alarms list. */
 	Alarm *curr_alarm = NULL;
 
@@ -80,9 +92,39 @@ void cleanup_main(void *arg) {
 
 
 
-	/* Attempt to cancel the command handler thread. */
-	if (data.mode > CMD_THREAD_CREATE_FAIL) {
-		status = cancel_thread(data.cmd_thread_tid);
+	#ifdef CMD_SERVER_SOCKET
+		/*
+		 * Attempt to cancel the command server thread first
+		 * so that no more commands are inserted while the
+		 * rest of the threads are being cancelled.
+		 */
+		if (data.mode > CMD_SERVER_CREATE_FAIL) {
+			status = cancel_thread(data.cmd_server_tid);
+			if (status != 0) {
+				data.err.linenum = __LINE__;
+				data.err.val = status;
+				if (status == THREAD_JOIN_ERR) {
+					data.err.msg = THREAD_JOIN_ERR_MSG;
+				} else if (status == THREAD_CANCEL_ERR) {
+					data.err.msg = THREAD_CANCEL_ERR_MSG;
+				} else { /* (status == THREAD_CANCEL_RETVAL_ERR) */
+					data.err.msg = THREAD_CANCEL_RETVAL_ERR_MSG;
+				}
+				exit_main(data);
+			}
+		}
+	#endif
+
+
+
+	/*
+	 * Attempt to cancel the command handler threads(workers) which have
+	 * been created and free the commands that they have taken but not yet
+	 * applied.
+	 */
+	while (data.worker_count != 0) {
+		worker = &(cmd_workers[--(data.worker_count)]);
+		status = cancel_thread(worker->id);
 		if (status != 0) {
 			data.err.linenum = __LINE__;
 			data.err.val = status;
@@ -95,6 +137,49 @@ void cleanup_main(void *arg) {
 			}
 			exit_main(data);
 		}
+		applied += worker->applied;
+
+		/* Destroy the worker's new_cmd_insert_cond_var. */
+		status = pthread_cond_destroy(&(worker->new_cmd_insert_cond_var));
+		if (status != 0) {
+			data.err.linenum = __LINE__;
+			data.err.val = COND_VAR_DESTROY_ERR; data.err.msg = COND_VAR_DESTROY_ERR_MSG;
+			exit_main(data);
+		}
+
+		while (worker->cmda_list_head != NULL) {
+			/* Save the current first element. */
+			curr_cmda = worker->cmda_list_head;
+			/* Move to the next element. */
+			worker->cmda_list_head = worker->cmda_list_head->link;
+
+			/* Detach and free the element saved in curr_cmda. */
+			curr_cmda->link = NULL;
+			free(curr_cmda);
+		}
+		worker->cmda_list_tail = NULL;
+		while (worker->cmdc_list_head != NULL) {
+			/* Save the current first element. */
+			curr_cmdc = worker->cmdc_list_head;
+			/* Move to the next element. */
+			worker->cmdc_list_head = worker->cmdc_list_head->link;
+
+			/* Detach and free the element saved in curr_cmdc. */
+			curr_cmdc->link = NULL;
+			free(curr_cmdc);
+		}
+		worker->cmdc_list_tail = NULL;
+		while (worker->cmdd_list_head != NULL) {
+			/* Save the current first element. */
+			curr_cmdd = worker->cmdd_list_head;
+			/* Move to the next element. */
+			worker->cmdd_list_head = worker->cmdd_list_head->link;
+
+			/* Detach and free the element saved in curr_cmdd. */
+			curr_cmdd->link = NULL;
+			free(curr_cmdd);
+		}
+		worker->cmdd_list_tail = NULL;
 	}
 
 
@@ -125,9 +210,63 @@ void cleanup_main(void *arg) {
 	}
 	cmdc_list_tail = NULL;
 
+	/* Free memory allocated to the type D commands list. */
+	while (cmdd_list_head != NULL) {
+		/* Save the current first element. */
+		curr_cmdd = cmdd_list_head;
+		/* Move to the next element. */
+		cmdd_list_head = cmdd_list_head->link;
+
+		/* Detach and free the element saved in curr_cmdd. */
+		curr_cmdd->link = NULL;
+		free(curr_cmdd);
+	}
+	cmdd_list_tail = NULL;
+
+	/*
+	 * Issue cancellation requests to all alarm handler threads(the ones
+	 * of the processed type B commands and the ones parked in the pool)
+	 * first, so that they all terminate in parallel while the main thread
+	 * is joining with them one by one. This way, the time it takes to
+	 * terminate them does not add up.
+	 *
+	 * The alarm handler threads remove their own nodes from the commands
+	 * list when they retire(while cmd_mutex is locked), so cmd_mutex is
+	 * locked until alarm_threads_cancelled has been set, after which none
+	 * of them retires anymore and the lists no longer change.
+	 */
+	status = pthread_mutex_lock(&cmd_mutex);
+	if (status != 0) {
+		data.err.linenum = __LINE__;
+		data.err.val = MUTEX_LOCK_ERR; data.err.msg = MUTEX_LOCK_ERR_MSG;
+		exit_main(data);
+	}
+	alarm_threads_cancelled = true;
+	for (curr_cmdb = cmdb_list_head; curr_cmdb != NULL; curr_cmdb = curr_cmdb->link) {
+		if ((curr_cmdb->is_processed) && (pthread_cancel(curr_cmdb->id) != 0)) {
+			data.err.linenum = __LINE__;
+			data.err.val = THREAD_CANCEL_ERR; data.err.msg = THREAD_CANCEL_ERR_MSG;
+			exit_main(data);
+		}
+	}
+	for (curr_cmdb = alarm_pool_head; curr_cmdb != NULL; curr_cmdb = curr_cmdb->link) {
+		if (pthread_cancel(curr_cmdb->id) != 0) {
+			data.err.linenum = __LINE__;
+			data.err.val = THREAD_CANCEL_ERR; data.err.msg = THREAD_CANCEL_ERR_MSG;
+			exit_main(data);
+		}
+	}
+	/* The parked threads which have been reused lock cmd_mutex when cancelled. */
+	status = pthread_mutex_unlock(&cmd_mutex);
+	if (status != 0) {
+		data.err.linenum = __LINE__;
+		data.err.val = MUTEX_UNLOCK_ERR; data.err.msg = MUTEX_UNLOCK_ERR_MSG;
+		exit_main(data);
+	}
+
 	/*
 	 * Free memory allocated to the type B commands list
-	 * while also cancelling all alarm handler threads.
+	 * while also joining with all alarm handler threads.
 	 */
 	while (cmdb_list_head != NULL) {
 		/* Save the current first element. */
@@ -137,27 +276,144 @@ void cleanup_main(void *arg) {
 
 		/* We only have to worry about processed type B commands. */
 		if (curr_cmdb->is_processed) {
-			status = cancel_thread(curr_cmdb->id);
+			status = join_cancelled_thread(curr_cmdb->id);
 			if (status != 0) {
 				data.err.linenum = __LINE__;
 				data.err.val = status;
 				if (status == THREAD_JOIN_ERR) {
 					data.err.msg = THREAD_JOIN_ERR_MSG;
-				} else if (status == THREAD_CANCEL_ERR) {
-					data.err.msg = THREAD_CANCEL_ERR_MSG;
 				} else { /* (status == THREAD_CANCEL_RETVAL_ERR) */
 					data.err.msg = THREAD_CANCEL_RETVAL_ERR_MSG;
 				}
 				exit_main(data);
 			}
+
+			/*
+			 * The thread has been joined with so its output
+			 * counters can be safely read and reported.
+			 */
+			fprintf(app_log, "Alarm thread handling alarms with message type = %" \
+						PRIuFAST32 " printed %" PRIuFAST64 " alarms in %" \
+						PRIuFAST64 " writes.\n", curr_cmdb->msg_type,
+						curr_cmdb->fired_records, curr_cmdb->fired_writes);
 		}
 
+		/* Close the thread's wakeup file descriptors. */
+		close_alarm_wakeup(curr_cmdb);
+
 		/* Detach and free the element saved in curr_cmdb. */
 		curr_cmdb->link = NULL;
 		free(curr_cmdb);
 	}
 	cmdb_list_tail = NULL;
 
+	/* Free memory allocated to the pool while also joining with the parked threads. */
+	while (alarm_pool_head != NULL) {
+		/* Save the current first element. */
+		curr_cmdb = alarm_pool_head;
+		/* Move to the next element. */
+		alarm_pool_head = alarm_pool_head->link;
+
+		status = join_cancelled_thread(curr_cmdb->id);
+		if (status != 0) {
+			data.err.linenum = __LINE__;
+			data.err.val = status;
+			if (status == THREAD_JOIN_ERR) {
+				data.err.msg = THREAD_JOIN_ERR_MSG;
+			} else { /* (status == THREAD_CANCEL_RETVAL_ERR) */
+				data.err.msg = THREAD_CANCEL_RETVAL_ERR_MSG;
+			}
+			exit_main(data);
+		}
+
+		/* Close the thread's wakeup file descriptors. */
+		close_alarm_wakeup(curr_cmdb);
+
+		/* Detach and free the element saved in curr_cmdb. */
+		curr_cmdb->link = NULL;
+		free(curr_cmdb);
+	}
+	alarm_pool_size = 0;
+
+	/*
+	 * Report the context switches of the entire application(all of its
+	 * threads) per command applied by the command handler threads, which
+	 * shows how much scheduling each command costs, and the memory cost of
+	 * the alarm handler threads, i.e., the address space reserved by each of
+	 * them and by the most of them running at once, along with the maximum
+	 * resident set size of the entire application.
+	 */
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		if (applied != 0) {
+			fprintf(app_log, "Command threads applied %" PRIuFAST64 " commands while the application" \
+						" made %ld voluntary and %ld involuntary context switches(%.2f per command).\n",
+						applied, usage.ru_nvcsw, usage.ru_nivcsw,
+						(double) (usage.ru_nvcsw + usage.ru_nivcsw) / (double) applied);
+		}
+		if ((cmda_coalesced != 0) || (cmda_annihilated != 0) || (cmdc_coalesced != 0)) {
+			fprintf(app_log, "%" PRIuFAST64 " type A commands were replaced and %" PRIuFAST64 \
+						" were annihilated in the commands list while %" PRIuFAST64 \
+						" type C ranges were redundant(%" PRIuFAST64 " commands eliminated before being applied).\n",
+						cmda_coalesced, cmda_annihilated, cmdc_coalesced,
+						cmda_coalesced + cmda_annihilated + cmdc_coalesced);
+		}
+		if (alarms_migrated != 0) {
+			fprintf(app_log, "%" PRIuFAST64 " alarms whose message type was replaced were migrated" \
+						" straight to the Alarm threads of their new message types.\n", alarms_migrated);
+		}
+		if (alarms_replaced_in_place != 0) {
+			fprintf(app_log, "%" PRIuFAST64 " alarms were replaced in place while their Alarm threads" \
+						" kept handling them without detaching them.\n", alarms_replaced_in_place);
+		}
+		if (cmd_queue_peak != 0) {
+			fprintf(app_log, "At most %" PRIuFAST64 " commands were waiting in the commands list(capacity %lu)" \
+						" while %" PRIuFAST64 " new commands waited for room in it, %" PRIuFAST64 \
+						" were rejected and %" PRIuFAST64 " type A commands were shed.\n",
+						cmd_queue_peak, (unsigned long) CMD_QUEUE_CAPACITY,
+						cmd_queue_blocked, cmd_queue_rejected, cmd_queue_shed);
+		}
+		if (alarm_threads_created != 0) {
+			fprintf(app_log, "%" PRIuFAST64 " Alarm threads were created and at most %" PRIuFAST64 \
+						" of them were running at once reserving %lu bytes of address space each" \
+						"(%lu bytes in total) while the maximum resident set size was %ld KiB.\n",
+						alarm_threads_created, alarm_threads_peak,
+						(unsigned long) thread_attr_footprint(&alarm_thread_attr),
+						(unsigned long) (thread_attr_footprint(&alarm_thread_attr) * alarm_threads_peak),
+						usage.ru_maxrss);
+		}
+		if ((alarm_threads_reused != 0) || (alarm_threads_resumed != 0)) {
+			fprintf(app_log, "%" PRIuFAST64 " Alarm threads were reused from the pool and %" PRIuFAST64 \
+						" lingering Alarm threads resumed handling alarms(%" PRIuFAST64 \
+						" thread creations avoided).\n", alarm_threads_reused, alarm_threads_resumed,
+						alarm_threads_reused + alarm_threads_resumed);
+		}
+	}
+
+
+
+	#ifdef APP_CLOCK_TICK
+		/*
+		 * Attempt to cancel the clock thread last so that the timestamps
+		 * of the log messages of the other threads stay current until they
+		 * have been cancelled.
+		 */
+		if (data.mode > CLOCK_THREAD_CREATE_FAIL) {
+			status = cancel_thread(data.clock_tid);
+			if (status != 0) {
+				data.err.linenum = __LINE__;
+				data.err.val = status;
+				if (status == THREAD_JOIN_ERR) {
+					data.err.msg = THREAD_JOIN_ERR_MSG;
+				} else if (status == THREAD_CANCEL_ERR) {
+					data.err.msg = THREAD_CANCEL_ERR_MSG;
+				} else { /* (status == THREAD_CANCEL_RETVAL_ERR) */
+					data.err.msg = THREAD_CANCEL_RETVAL_ERR_MSG;
+				}
+				exit_main(data);
+			}
+		}
+	#endif
+
 
 
 	/*
@@ -166,25 +422,55 @@ void cleanup_main(void *arg) {
 	 * to create synchronization.
 	 */
 
-	/* Free memory allocated to the (global) alarms list. */
-	while (alarm_list_head != NULL) {
-		/* Save the current first element. */
-		curr_alarm = alarm_list_head;
-		/* Move to the next element. */
-		alarm_list_head = alarm_list_head->link;
+	/* Free memory allocated to every shard of the (global) alarms list. */
+	for (shard = alarm_shards; shard != alarm_shards + ALARM_SHARDS; ++shard) {
+		while (shard->alarm_list_head != NULL) {
+			/* Save the current first element. */
+			curr_alarm = shard->alarm_list_head;
+			/* Move to the next element. */
+			shard->alarm_list_head = shard->alarm_list_head->link;
+
+			/*
+			 * The alarm handler threads have already been
+			 * cancelled and their schedules have been freed
+			 * by the alarm handler thread cleanup routine
+			 * therefore we only have to worry about the link
+			 * attribute which connects nodes in the global
+			 * alarms list(every alarm in the inboxes of the
+			 * alarm handler threads is still part of it).
+			 */
+
+			/* Detach and free the element saved in curr_alarm. */
+			curr_alarm->link = NULL;
+			free(curr_alarm);
+		}
+		/* Every alarm is part of lane 0 so the express lanes are now empty. */
+		for (lane = 0; lane < ALARM_SKIP_LIST_LANES - 1; ++lane) {
+			shard->alarm_express_head[lane] = NULL;
+		}
+		/* The type B command nodes of the alarm handler threads have already been freed. */
+		shard->handler_list_head = NULL;
+	}
+
+
 
+	#ifdef ALARM_TABLE_SHM
 		/*
-		 * link_handle attributes have been set to NULL
-		 * by the alarm handler thread cleanup routine
-		 * therefore we only have to worry about the link
-		 * attribute which connects nodes in the global
-		 * alarms list.
+		 * Unmap the shared alarm table. Its alarms stay stored in it so
+		 * that the next process which attaches to it restores them.
 		 */
-
-		/* Detach and free the element saved in curr_alarm. */
-		curr_alarm->link = NULL;
-		free(curr_alarm);
-	}
+		if (data.mode > ALARM_TABLE_OPEN_FAIL) {
+			fprintf(app_log, "%lu alarms are stored in the shared alarm table %s while %" PRIuFAST64 \
+						" alarms did not fit into it.\n", (unsigned long) alarm_table->count,
+						ALARM_TABLE_NAME, alarm_table_overflows);
+			status = close_alarm_table();
+			if (status != 0) {
+				data.err.linenum = __LINE__;
+				data.err.val = ALARM_TABLE_ERR; data.err.msg = ALARM_TABLE_ERR_MSG;
+				exit_main(data);
+			}
+		}
+	#endif
 
 
 
@@ -206,29 +492,33 @@ void cleanup_main(void *arg) {
 		exit_main(data);
 	}
 
-	/* Destroy new_cmd_insert_cond_var. */
-	status = pthread_cond_destroy(&new_cmd_insert_cond_var);
-	if (status != 0) {
-		data.err.linenum = __LINE__;
-		data.err.val = COND_VAR_DESTROY_ERR; data.err.msg = COND_VAR_DESTROY_ERR_MSG;
-		exit_main(data);
-	}
-
 
 
-	/* Attempt to destroy alarm_rw_bin_sem. */
-	if (data.mode > ALARM_RW_BIN_SEM_INIT_FAIL) {
-		status = sem_destroy(&alarm_rw_bin_sem);
+	/* Attempt to destroy the semaphores and the handler_mutex of every shard of the alarms list. */
+	for (shard = alarm_shards; shard != alarm_shards + data.shard_count; ++shard) {
+		status = sem_destroy(&(shard->alarm_rw_bin_sem));
+		if (status == 0) {
+			status = sem_destroy(&(shard->alarm_r_bin_sem));
+		}
 		if (status != 0) {
 			data.err.linenum = __LINE__;
 			data.err.val = SEM_DESTROY_ERR; data.err.msg = SEM_DESTROY_ERR_MSG;
 			exit_main(data);
 		}
+		status = pthread_mutex_destroy(&(shard->handler_mutex));
+		if (status != 0) {
+			data.err.linenum = __LINE__;
+			data.err.val = MUTEX_DESTROY_ERR; data.err.msg = MUTEX_DESTROY_ERR_MSG;
+			exit_main(data);
+		}
 	}
 
-	/* Attempt to destroy alarm_r_bin_sem. */
-	if (data.mode > ALARM_R_BIN_SEM_INIT_FAIL) {
-		status = sem_destroy(&alarm_r_bin_sem);
+	/* Attempt to destroy the semaphores of the shard whose alarm_r_bin_sem or handler_mutex failed to initialize. */
+	if ((data.mode == ALARM_R_BIN_SEM_INIT_FAIL) || (data.mode == ALARM_HANDLER_MUTEX_INIT_FAIL)) {
+		status = sem_destroy(&(alarm_shards[data.shard_count].alarm_rw_bin_sem));
+		if ((status == 0) && (data.mode == ALARM_HANDLER_MUTEX_INIT_FAIL)) {
+			status = sem_destroy(&(alarm_shards[data.shard_count].alarm_r_bin_sem));
+		}
 		if (status != 0) {
 			data.err.linenum = __LINE__;
 			data.err.val = SEM_DESTROY_ERR; data.err.msg = SEM_DESTROY_ERR_MSG;
@@ -236,6 +526,19 @@ void cleanup_main(void *arg) {
 		}
 	}
 
+	/* Attempt to destroy the thread attributes which have been initialized. */
+	if (data.mode > ALARM_THREAD_ATTR_INIT_FAIL) {
+		status = pthread_attr_destroy(&alarm_thread_attr);
+		if ((status == 0) && (data.mode > CMD_THREAD_ATTR_INIT_FAIL)) {
+			status = pthread_attr_destroy(&cmd_thread_attr);
+		}
+		if (status != 0) {
+			data.err.linenum = __LINE__;
+			data.err.val = THREAD_ATTR_ERR; data.err.msg = THREAD_ATTR_ERR_MSG;
+			exit_main(data);
+		}
+	}
+
 
 
 	/* Destroy alarm_cancel_mutex. */
@@ -254,6 +557,22 @@ void cleanup_main(void *arg) {
 		exit_main(data);
 	}
 
+	/* Destroy cmd_queue_cond_var. */
+	status = pthread_cond_destroy(&cmd_queue_cond_var);
+	if (status != 0) {
+		data.err.linenum = __LINE__;
+		data.err.val = COND_VAR_DESTROY_ERR; data.err.msg = COND_VAR_DESTROY_ERR_MSG;
+		exit_main(data);
+	}
+
+	/* Destroy cmda_applied_cond_var. */
+	status = pthread_cond_destroy(&cmda_applied_cond_var);
+	if (status != 0) {
+		data.err.linenum = __LINE__;
+		data.err.val = COND_VAR_DESTROY_ERR; data.err.msg = COND_VAR_DESTROY_ERR_MSG;
+		exit_main(data);
+	}
+
 
 
 	/* Cleanup main thread and terminate. */
@@ -0,0 +1,49 @@
+/**************************************************************************
+ *
+ * Author:
+ * 					Ashkan Moatamed
+ *
+ *
+ *
+ * clock_ticker.c
+ *
+ *
+ *
+ * Implementation of the clock
+ * thread routine defined in alarm_app.h
+ *
+ *************************************************************************/
+
+/* Declare variables and function prototypes specified in alarm_app.h */
+#include "alarm_app.h"
+
+/*
+ * The clock thread routine, which publishes the time of APP_CLOCK(see
+ * publish_now) once every APP_CLOCK_TICK nanoseconds until it is cancelled.
+ *
+ * Precondition: arg can be safely casted into (const struct timespec *)
+ * which points to the tick(APP_CLOCK_TICK) of the clock thread.
+ *
+ * Returns: arg
+ */
+void * clock_ticker(void *arg) {
+	/* The time between two consecutive publications. */
+	const struct timespec *tick = (const struct timespec *) arg;
+
+
+
+	/*
+	 * nanosleep is a cancellation point so the thread is cancelled while
+	 * it sleeps, and publish_now cannot leave the published time torn
+	 * since it is only a single atomic store.
+	 */
+	while (true) {
+		publish_now(APP_CLOCK);
+		nanosleep(tick, NULL);
+	}
+
+
+
+	/* This return will never be reached. */
+	return arg;
+}
@@ -21,39 +21,79 @@
 /*
  * The command handler thread routine.
  *
- * Precondition: arg can be safely casted into (pthread_t *).
+ * Precondition: arg can be safely casted into (CmdWorker *).
  *
  * Returns: arg
  */
 void * cmd_handler(void *arg) {
+	/* The current thread(command handler thread)'s worker. */
+	CmdWorker *worker = (CmdWorker *) arg;
 	/* Save the current thread(command handler thread)'s ID. */
-	const pthread_t tid = *((pthread_t *) arg);
-	const uint_fast64_t id = (uint_fast64_t) tid;
+	const uint_fast64_t id = (uint_fast64_t) pthread_self();
 
 
 
-	/* Command type A pointer used for iterating over the commands list. */
-	CmdA *curr_cmda = NULL;
+	/* Command type A pointers used for iterating over the commands lists. */
+	CmdA *curr_cmda = NULL, *prev_cmda = NULL, *next_cmda = NULL;
 	/* Alarm pointer used for iterating over the alarms list. */
 	Alarm *curr_alarm = NULL;
 	/*
-	 * Alarm pointer used to save the pointer to the previous
-	 * node in the global alarms list when removing nodes from
-	 * the list as a result of an appropriate type C command.
+	 * Has the alarm of the current type A command replaced an existing alarm
+	 * in place(which its alarm handler thread keeps handling) or not?
 	 */
-	Alarm *prev_alarm = NULL;
+	bool is_replaced_in_place = false;
 	/*
-	 * Pointer to the thread ID of the alarm_handler thread which
-	 * has been cancelled as a result of an appropriate type A or
-	 * type C command.
+	 * The existing alarm with the message number of the current type A
+	 * command and whether it is of another message type or not, in which
+	 * case the new alarm migrates to the live alarm handler thread of its
+	 * own message type(if any).
 	 */
-	pthread_t *handler_id = NULL;
-	/* Command type B pointer used for iterating over the commands list. */
-	CmdB *curr_cmdb = NULL;
-	/* Command type C pointer used for iterating over the commands list. */
-	CmdC *curr_cmdc = NULL;
-	/* Stores the message number of the alarm to be cancelled. */
-	uint_fast32_t cancel_msg_num = 0;
+	Alarm *old_alarm = NULL;
+	bool is_type_changed = false;
+	/* Does the existing alarm have to be detached from its alarm handler thread? */
+	bool is_detaching = false;
+	/* Command type B pointers used for iterating over the commands list. */
+	CmdB *curr_cmdb = NULL, *prev_cmdb = NULL, *next_cmdb = NULL;
+	/* Pointer to the type B command node of a parked alarm handler thread. */
+	CmdB *park = NULL;
+	/* Command type C pointers used for iterating over the commands lists. */
+	CmdC *curr_cmdc = NULL, *prev_cmdc = NULL, *next_cmdc = NULL;
+	/* Stores the range of message numbers of the alarms to be cancelled. */
+	uint_fast32_t cancel_msg_num = 0, cancel_msg_num_last = 0;
+	/*
+	 * Stores the sequence number of the type C or type D command being
+	 * applied, whose alarms inserted by later type A commands are kept.
+	 */
+	uint_fast64_t cancel_seq = 0;
+	/*
+	 * The last alarm in each lane of the global alarms list(skip list)
+	 * before the alarm(s) being cancelled as a result of an appropriate
+	 * type C or type D command.
+	 */
+	Alarm *preds[ALARM_SKIP_LIST_LANES];
+	/* The current lane of the global alarms list. */
+	size_t lane = 0;
+	/* Command type D pointers used for iterating over the commands lists. */
+	CmdD *curr_cmdd = NULL, *prev_cmdd = NULL, *next_cmdd = NULL;
+	/* Stores the message type of the alarms to be cancelled. */
+	uint_fast32_t cancel_msg_type = 0;
+	/*
+	 * Pointer to the head of the singly-linked-list(through the link
+	 * attribute) of all alarms detached from the global alarms list
+	 * as a result of an appropriate type C or type D command.
+	 */
+	Alarm *cancel_list_head = NULL;
+	/* Stores the number of alarms cancelled by a type C or type D command. */
+	uint_fast64_t cancel_count = 0;
+	/* Stores the request of the command being applied. */
+	CmdRequest req;
+	/* The shard of the alarms list which the current command is applied to. */
+	AlarmShard *shard = NULL;
+	/*
+	 * The alarms removed from the current shard by a type C command and
+	 * the last alarm of the current run of consecutive alarms removed.
+	 */
+	Alarm *shard_cancel_head = NULL, *run_last = NULL;
 
 
 
@@ -67,33 +107,27 @@ void * cmd_handler(void *arg) {
 
 
 
-	/*
-	 * Set up this thread's cleanup routines to be called
-	 * when it is inevitably cancelled by the main thread.
-	 */
-	pthread_cleanup_push(cleanup_cmd_handler, (void *) (&status));
-
-
-
 	/*
 	 * Infinite loop to process new commands read from the commands list.
 	 *
-	 * Since the entire body of the while loop is a critical section, break
-	 * it down into multiple parts by obtaining and releasing locks for each
-	 * part. This way, the command handler thread creates a much smaller
-	 * bottleneck on the application by allowing other threads to obtain locks.
+	 * There are CMD_WORKERS command handler threads(workers) and every
+	 * command is applied by the worker of its key(see CMD_WORKER) which
+	 * is stored in its worker attribute. Every iteration, the worker takes
+	 * all of its own commands from the global commands list(while cmd_mutex
+	 * is locked) and then applies them without holding cmd_mutex, so that
+	 * commands with different keys are applied in parallel while commands
+	 * with the same key are still applied in the order of their insertion.
 	 *
-	 * Furthermore, use a few goto statements in order to short circuit its
-	 * execution allowing it to bypass processing commands of a given type, if
-	 * it knows there are no commands of that type.
+	 * The commands are applied in the following order just like before:
+	 * type A commands, then type B commands and finally type C and D
+	 * commands. Each part is skipped if the worker has no commands of
+	 * the corresponding type(s).
 	 *
-	 * At any point, the command handler thread knows that there is at least one
-	 * command that it has to execute but due to the above decision to break up
-	 * its critical section, it would have to obtain and release locks multiple
-	 * times before it can start processing type C commands. This would mean that
-	 * if there are only type C commands to execute, the initial lock obtaining
-	 * and releasing was just a waste of resources thus creating the need for
-	 * short circuiting.
+	 * The shards of the alarms list are written to by many workers at
+	 * once. Therefore, a worker locks a shard(as a writer) while it is
+	 * searching it and not only while modifying it. A worker never holds
+	 * more than one shard at once and never waits for a shard while
+	 * holding alarm_cancel_mutex.
 	 */
 	while (true) {
 		/* Lock new_cmd_insert_mutex. */
@@ -103,11 +137,20 @@ void * cmd_handler(void *arg) {
 		}
 
 		/*
-		 * Wait for the main thread to signal new_cmd_insert_cond_var signifying
-		 * that there has been at least one new (valid) command in the commands
-		 * list waiting to be executed. This causes the command handler thread
-		 * to be only running when it actually has to perform some actions and
-		 * not wasting resources when there is nothing to do.
+		 * The thread may be cancelled by the main thread while it is
+		 * waiting on its new_cmd_insert_cond_var, in which case it re-acquires
+		 * new_cmd_insert_mutex before its cleanup routines are executed.
+		 * Therefore, set up a cleanup routine which unlocks it again.
+		 */
+		pthread_cleanup_push(cleanup_cmd_handler, (void *) (&new_cmd_insert_mutex));
+
+		/*
+		 * Wait for a parser(the main or the command server thread) to
+		 * signal its new_cmd_insert_cond_var after inserting at least one
+		 * new (valid) command which this worker has to apply(see
+		 * notify_cmd_worker). This causes every command handler thread
+		 * to be only running when it actually has to perform some actions
+		 * and not wasting resources when there is nothing to do.
 		 *
 		 * A conditional wait (whether timed or not) is a cancellation point.
 		 * When the cancelability enable state of a thread is set to
@@ -131,18 +174,16 @@ void * cmd_handler(void *arg) {
 		 *
 		 * Mesa-style implies while loop. Hoare-style implies if statement.
 		 */
-		while ((cmda_list_head == NULL) && (cmdb_list_new_elm == NULL) && (cmdc_list_head == NULL)) {
-			status = pthread_cond_wait(&new_cmd_insert_cond_var, &new_cmd_insert_mutex);
+		while (worker->pending == 0) {
+			status = pthread_cond_wait(&(worker->new_cmd_insert_cond_var), &new_cmd_insert_mutex);
 			if (status != 0) {
 				EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
 			}
-		} /* (cmda_list_head != NULL) || (cmdb_list_new_elm != NULL) || (cmdc_list_head != NULL) */
+		} /* (worker->pending != 0) */
+		worker->pending = 0;
 
 		/* Unlock new_cmd_insert_mutex. */
-		status = pthread_mutex_unlock(&new_cmd_insert_mutex);
-		if (status != 0) {
-			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
-		}
+		pthread_cleanup_pop(1);
 
 		/* Check if there are any pending cancellation requests. */
 		pthread_testcancel(); /* pthread_testcancel() never fails. */
@@ -152,397 +193,752 @@ void * cmd_handler(void *arg) {
 		/* Obtain all necessary locks. */
 		cmd_handler_obtain_locks(&old_state);
 
+		/*
+		 * Critical Section Part 1:
+		 * Take all of this worker's type A, C and D commands from the
+		 * global commands list by moving them to the worker's own lists
+		 * in the same order. Its type B commands are left in the global
+		 * commands list(since the parsers search it for alarm handler
+		 * threads) and only counted, so that the ones inserted after this
+		 * point are not applied before the type A commands that they may
+		 * depend on. The parsers waiting for room in the global commands
+		 * list(see wait_cmd_queue) are then woken up.
+		 */
+		prev_cmda = NULL;
+		for (curr_cmda = cmda_list_head; curr_cmda != NULL; curr_cmda = next_cmda) {
+			next_cmda = curr_cmda->link;
 
-
-		/* Short circuit execution. */
-		if (cmda_list_head == NULL) {
-			/* No type A commands to execute. */
-			if (cmdb_list_new_elm == NULL) {
-				/*
-				 * No type B commands to execute.
-				 *
-				 * We must therefore have: (cmdc_list_head != NULL)
-				 */
-				goto TYPE_C_AFTER_OBTAIN_LOCKS;
-			} else { /* (cmdb_list_new_elm != NULL) */
-				goto TYPE_B_AFTER_OBTAIN_LOCKS;
+			if (curr_cmda->worker != worker->index) {
+				prev_cmda = curr_cmda;
+				continue;
 			}
-		} /* (cmda_list_head != NULL) */
-
 
+			/* Remove the command from the global commands list. */
+			if (prev_cmda == NULL) {
+				cmda_list_head = next_cmda;
+			} else { /* (prev_cmda != NULL) */
+				prev_cmda->link = next_cmda;
+			}
+			if (curr_cmda == cmda_list_tail) {
+				cmda_list_tail = prev_cmda;
+			}
+			--cmd_queue_depth;
 
-		/* Lock alarm_cancel_mutex for potential conditional wait. */
-		status = pthread_mutex_lock(&alarm_cancel_mutex);
-		if (status != 0) {
-			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+			/* Insert the command at the end of the worker's list. */
+			curr_cmda->link = NULL;
+			if (worker->cmda_list_head == NULL) {
+				worker->cmda_list_head = curr_cmda;
+			} else { /* (worker->cmda_list_head != NULL) */
+				worker->cmda_list_tail->link = curr_cmda;
+			}
+			worker->cmda_list_tail = curr_cmda;
 		}
 
-		/*
-		 * Critical Section Part 1:
-		 * Read the global commands list and execute all type A commands.
-		 */
-		while (cmda_list_head != NULL) {
-			/* Allocate memory for the new alarm node. */
-			curr_alarm = MALLOC(Alarm);
-			if (curr_alarm == NULL) {
-				EXIT_ERR(ALLOC_ALARM_ERR_MSG, ALLOC_ALARM_ERR);
-			}
-
-			/* Initialize the new alarm node's attributes. */
-			curr_alarm->link = NULL; curr_alarm->link_handle = NULL;
-			curr_alarm->wait_time = cmda_list_head->wait_time;
-			curr_alarm->msg_type = cmda_list_head->msg_type;
-			curr_alarm->msg_num = cmda_list_head->msg_num;
-			strcpy(curr_alarm->msg, cmda_list_head->msg); /* Set curr_alarm's message. */
-			curr_alarm->is_assigned = false;
-			curr_alarm->handler_id = NULL;
-			curr_alarm->is_replaced = false;
-			curr_alarm->is_cancelled = false;
-
-			/*
-			 * Save the current first command A node in curr_cmda.
-			 *
-			 * Move the head to the next command A node.
-			 *
-			 * Detach and free the command A node saved in curr_cmda.
-			 */
-			curr_cmda = cmda_list_head;
-			cmda_list_head = cmda_list_head->link;
-			curr_cmda->link = NULL;
-			free(curr_cmda);
+		worker->cmdb_count = 0;
+		for (curr_cmdb = cmdb_list_new_elm; curr_cmdb != NULL; curr_cmdb = curr_cmdb->link) {
+			if ((!curr_cmdb->is_processed) && (curr_cmdb->worker == worker->index)) {
+				++(worker->cmdb_count);
+			}
+		}
 
-			/*
-			 * Insert the new alarm pointed to by curr_alarm into the global
-			 * alarms list in sorted order using the insert_alarm method.
-			 */
-			handler_id = insert_alarm(&alarm_list_head, curr_alarm, next_alarm,
-						insert_first_alarm, insert_after_alarm,
-						true, &alarm_cancel_cond_var, &alarm_cancel_mutex);
+		prev_cmdc = NULL;
+		for (curr_cmdc = cmdc_list_head; curr_cmdc != NULL; curr_cmdc = next_cmdc) {
+			next_cmdc = curr_cmdc->link;
 
-			/* Print status message informing the user of the internal state. */
-			fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
-						" and message number = %" PRIuFAST32 \
-						" inserted by Command thread with ID = %" \
-						PRIuFAST64 " into the alarms list at %" PRIuFAST64 \
-						".\n", curr_alarm->msg_type, curr_alarm->msg_num, id, now());
+			if (curr_cmdc->worker != worker->index) {
+				prev_cmdc = curr_cmdc;
+				continue;
+			}
 
-			/*
-			 * (handler_id != NULL) implies (alarm handler
-			 * thread with ID *handler_id has self terminated)
-			 */
-			if (handler_id != NULL) {
-				/*
-				 * Free allocated resources by joining with
-				 * alarm handler thread and freeing memory.
-				 */
-				cmd_handler_join_with_alarm_handler(handler_id);
-			} /* (handler_id == NULL) */
-		}
-		cmda_list_tail = NULL; /* Update type A commands list tail. */
-		errno = 0;
+			/* Remove the command from the global commands list. */
+			if (prev_cmdc == NULL) {
+				cmdc_list_head = next_cmdc;
+			} else { /* (prev_cmdc != NULL) */
+				prev_cmdc->link = next_cmdc;
+			}
+			if (curr_cmdc == cmdc_list_tail) {
+				cmdc_list_tail = prev_cmdc;
+			}
+			--cmd_queue_depth;
 
-		/* Unlock alarm_cancel_mutex. */
-		status = pthread_mutex_unlock(&alarm_cancel_mutex);
-		if (status != 0) {
-			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+			/* Insert the command at the end of the worker's list. */
+			curr_cmdc->link = NULL;
+			if (worker->cmdc_list_head == NULL) {
+				worker->cmdc_list_head = curr_cmdc;
+			} else { /* (worker->cmdc_list_head != NULL) */
+				worker->cmdc_list_tail->link = curr_cmdc;
+			}
+			worker->cmdc_list_tail = curr_cmdc;
 		}
 
+		prev_cmdd = NULL;
+		for (curr_cmdd = cmdd_list_head; curr_cmdd != NULL; curr_cmdd = next_cmdd) {
+			next_cmdd = curr_cmdd->link;
 
-
-		/* Short circuit execution. */
-		if (cmdb_list_new_elm == NULL) {
-			/* No type B commands to execute. */
-			if (cmdc_list_head == NULL) {
-				/*
-				 * The only way we could get here
-				 * is that if there was at least one
-				 * type A command to execute but no
-				 * type B or type C commands to execute
-				 * so just release all locks and restart
-				 * the processing.
-				 */
-				goto TYPE_C_BEFORE_RELEASE_LOCKS;
-			} else { /* (cmdc_list_head != NULL) */
-				goto TYPE_B_BEFORE_RELEASE_LOCKS;
+			if (curr_cmdd->worker != worker->index) {
+				prev_cmdd = curr_cmdd;
+				continue;
 			}
-		} /* (cmdb_list_new_elm != NULL) */
 
+			/* Remove the command from the global commands list. */
+			if (prev_cmdd == NULL) {
+				cmdd_list_head = next_cmdd;
+			} else { /* (prev_cmdd != NULL) */
+				prev_cmdd->link = next_cmdd;
+			}
+			if (curr_cmdd == cmdd_list_tail) {
+				cmdd_list_tail = prev_cmdd;
+			}
+			--cmd_queue_depth;
+
+			/* Insert the command at the end of the worker's list. */
+			curr_cmdd->link = NULL;
+			if (worker->cmdd_list_head == NULL) {
+				worker->cmdd_list_head = curr_cmdd;
+			} else { /* (worker->cmdd_list_head != NULL) */
+				worker->cmdd_list_tail->link = curr_cmdd;
+			}
+			worker->cmdd_list_tail = curr_cmdd;
+		}
 
+		if (pthread_cond_broadcast(&cmd_queue_cond_var) != 0) {
+			EXIT_ERR(COND_VAR_BROADCAST_ERR_MSG, COND_VAR_BROADCAST_ERR);
+		}
 
 		/* Release all necessary locks. */
 		cmd_handler_release_locks(&old_state);
 
 
 
-		/* Give other threads a chance to obtain locks. */
+		if (worker->cmda_list_head != NULL) {
+			/* Disable cancellation. */
+			if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+				EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+			}
 
+			/*
+			 * Critical Section Part 2:
+			 * Execute all of the worker's type A commands. The commands
+			 * are only freed once all of them have been applied since
+			 * the parsers still search them in the meantime.
+			 */
+			for (curr_cmda = worker->cmda_list_head; curr_cmda != NULL; curr_cmda = curr_cmda->link) {
+				/*
+				 * An existing alarm with the same message number but of a
+				 * message type of another shard is removed from its shard
+				 * and its node is reused for the new alarm.
+				 */
+				curr_alarm = cmd_handler_move_alarm(curr_cmda->msg_num, curr_cmda->msg_type);
+				is_type_changed = (curr_alarm != NULL);
+
+				/* Allocate memory for the new alarm node(if needed). */
+				if (curr_alarm == NULL) {
+					curr_alarm = MALLOC_ALARM(curr_cmda->msg_num);
+					if (curr_alarm == NULL) {
+						EXIT_ERR(ALLOC_ALARM_ERR_MSG, ALLOC_ALARM_ERR);
+					}
+				}
 
+				/* Initialize the new alarm node's attributes. */
+				curr_alarm->link = NULL;
+				curr_alarm->wait_time = curr_cmda->wait_time;
+				curr_alarm->msg_type = curr_cmda->msg_type;
+				curr_alarm->msg_num = curr_cmda->msg_num;
+				strcpy(curr_alarm->msg, curr_cmda->msg); /* Set curr_alarm's message. */
+				curr_alarm->is_assigned = false;
+				curr_alarm->handler = NULL;
+				curr_alarm->is_replaced = false;
+				curr_alarm->is_cancelled = false;
+				curr_alarm->seq = 0;
+				curr_alarm->cmda_seq = curr_cmda->seq;
+				/* express and lanes are set by insert_alarm(if needed). */
+				curr_alarm->inbox_link = NULL;
 
-		/* Obtain all necessary locks. */
-		cmd_handler_obtain_locks(&old_state);
-TYPE_B_AFTER_OBTAIN_LOCKS:
+				/*
+				 * Insert the new alarm pointed to by curr_alarm into its shard
+				 * of the global alarms list in sorted order using the insert_alarm
+				 * method while only holding a writer lock on that shard.
+				 * alarm_cancel_mutex is only locked when the alarm replaces an
+				 * assigned alarm of another message type, for the conditional
+				 * wait of its detachment. Whether an alarm is assigned cannot change
+				 * while the shard is locked as a writer, since only the writers
+				 * make detach requests and they wait for them before unlocking it.
+				 *
+				 * If an alarm handler thread of the alarm's message type is
+				 * still running afterwards, then the alarm is posted to its inbox
+				 * (while the handler_mutex of the shard is locked so that the
+				 * thread cannot retire in the meantime) so that it is handled right away(it would otherwise remain
+				 * unassigned since the thread only searches the alarms list
+				 * when it starts). insert_alarm frees the new alarm if it has
+				 * replaced an existing one, so the alarm posted is the one
+				 * that it returns. The thread may be lingering with no
+				 * alarms left, in which case it resumes handling alarms.
+				 *
+				 * An existing alarm of the same message type which has been
+				 * replaced in place is still assigned to its alarm handler
+				 * thread, which prints the new message from its next firing
+				 * on, so it is neither detached nor posted again.
+				 *
+				 * An existing alarm of another message type is detached from
+				 * its alarm handler thread(if any) by insert_alarm or by
+				 * cmd_handler_move_alarm and the new alarm is then migrated,
+				 * i.e., posted in the same step to the live alarm handler
+				 * thread of its new message type(if any), so that the type
+				 * change neither misses its firings nor waits for a new
+				 * thread to search the alarms list.
+				 */
+				shard = ALARM_SHARD(curr_alarm->msg_type);
+				obtain_alarm_write_lock(shard);
+				is_detaching = false;
+				if (!is_type_changed) {
+					find_alarm_preds(&(shard->alarm_list_head), shard->alarm_express_head,
+								curr_cmda->msg_num, preds);
+					old_alarm = *alarm_lane(&(shard->alarm_list_head), shard->alarm_express_head, preds[0], 0);
+					is_type_changed = (old_alarm != NULL) && (old_alarm->msg_num == curr_cmda->msg_num) &&
+								(old_alarm->msg_type != curr_cmda->msg_type);
+					is_detaching = is_type_changed && old_alarm->is_assigned;
+				}
+				if (is_detaching) {
+					status = pthread_mutex_lock(&alarm_cancel_mutex);
+					if (status != 0) {
+						EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+					}
+				}
+				curr_alarm = insert_alarm(&(shard->alarm_list_head), shard->alarm_express_head, curr_alarm,
+							next_alarm, insert_first_alarm, insert_after_alarm,
+							&alarm_cancel_cond_var, &alarm_cancel_mutex);
+				if (is_detaching) {
+					status = pthread_mutex_unlock(&alarm_cancel_mutex);
+					if (status != 0) {
+						EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+					}
+				}
+				is_replaced_in_place = curr_alarm->is_assigned;
+				if (is_replaced_in_place) {
+					(void) __sync_fetch_and_add(&alarms_replaced_in_place, 1);
+				} else { /* (!is_replaced_in_place) */
+					status = pthread_mutex_lock(&(shard->handler_mutex));
+					if (status != 0) {
+						EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+					}
+					curr_cmdb = find_alarm_handler(shard->handler_list_head, curr_cmda->msg_type);
+					if ((curr_cmdb != NULL) && (post_alarm(curr_cmdb, curr_alarm) != 0)) {
+						EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+					}
+					if ((curr_cmdb != NULL) && (is_type_changed)) {
+						(void) __sync_fetch_and_add(&alarms_migrated, 1);
+
+						/* Print status message informing the user of the internal state. */
+						fprintf(app_log, "Alarm with message number = %" PRIuFAST32 \
+									" migrated to Alarm thread with ID = %" PRIuFAST64 \
+									" of message type = %" PRIuFAST32 " by Command thread with ID = %" \
+									PRIuFAST64 " at %" PRIuFAST64 ".\n", curr_cmda->msg_num,
+									(uint_fast64_t) curr_cmdb->id, curr_cmda->msg_type, id, now());
+					}
+					status = pthread_mutex_unlock(&(shard->handler_mutex));
+					if (status != 0) {
+						EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+					}
+				}
+				#ifdef ALARM_TABLE_SHM
+					/*
+					 * Store the alarm in the shared alarm table while the shard
+					 * is still locked so that the table is updated in the same
+					 * order as the alarms list.
+					 */
+					put_alarm_record(curr_alarm);
+				#endif
+				release_alarm_write_lock(shard);
+
+				/* Print status message informing the user of the internal state. */
+				fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
+							" and message number = %" PRIuFAST32 \
+							" %s by Command thread with ID = %" \
+							PRIuFAST64 " %s the alarms list at %" PRIuFAST64 \
+							".\n", curr_cmda->msg_type, curr_cmda->msg_num,
+							(is_replaced_in_place ? "replaced in place" : "inserted"), id,
+							(is_replaced_in_place ? "in" : "into"), now());
+				complete_cmd_request(&(curr_cmda->req), CMD_DONE_APPLIED, NULL);
+				++(worker->applied);
+			}
+			errno = 0;
 
+			/* Lock cmd_mutex. */
+			status = pthread_mutex_lock(&cmd_mutex);
+			if (status != 0) {
+				EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+			}
 
+			/* Free memory allocated to the worker's type A commands list. */
+			while (worker->cmda_list_head != NULL) {
+				/* Save the current first element. */
+				curr_cmda = worker->cmda_list_head;
+				/* Move to the next element. */
+				worker->cmda_list_head = worker->cmda_list_head->link;
 
-		/*
-		 * Critical Section Part 2:
-		 * Read the global commands list and execute all type B commands.
-		 */
-		for (curr_cmdb = cmdb_list_new_elm; curr_cmdb != NULL; curr_cmdb = curr_cmdb->link) {
-			/* assert(!curr_cmdb->is_processed) */
+				/* Detach and free the element saved in curr_cmda. */
+				curr_cmda->link = NULL;
+				free(curr_cmda);
+			}
+			worker->cmda_list_tail = NULL; /* Update type A commands list tail. */
 
-			/* Set the command's state to PROCESSED. */
-			curr_cmdb->is_processed = true;
+			/* Wake up the workers waiting for these type A commands(see find_prior_cmda). */
+			if (pthread_cond_broadcast(&cmda_applied_cond_var) != 0) {
+				EXIT_ERR(COND_VAR_BROADCAST_ERR_MSG, COND_VAR_BROADCAST_ERR);
+			}
 
-			/* Create the alarm handler thread. */
-			status = pthread_create(&(curr_cmdb->id), NULL,
-						alarm_handler, (void *) (&(curr_cmdb->msg_type)));
+			/* Unlock cmd_mutex. */
+			status = pthread_mutex_unlock(&cmd_mutex);
 			if (status != 0) {
-				EXIT_ERR(THREAD_CREATE_ERR_MSG, THREAD_CREATE_ERR);
+				EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
 			}
 
-			/* Print status message informing the user of the internal state. */
-			fprintf(app_log, "New Alarm thread with ID = %" PRIuFAST64 \
-						" for message type = %" PRIuFAST32 \
-						" created by Command thread with ID = %" \
-						PRIuFAST64 " at %" PRIuFAST64 ".\n",
-						(uint_fast64_t) curr_cmdb->id,
-						curr_cmdb->msg_type, id, now());
+			/* Enable cancellation. */
+			if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+				EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+			}
+
+			/* Check if there are any pending cancellation requests. */
+			pthread_testcancel(); /* pthread_testcancel() never fails. */
 		}
-		cmdb_list_new_elm = NULL;
 
 
 
-		/* Short circuit execution. */
-		if (cmdc_list_head == NULL) {
+		if (worker->cmdb_count != 0) {
+			/* Obtain all necessary locks. */
+			cmd_handler_obtain_locks(&old_state);
+
 			/*
-			 * The only way we could get here
-			 * is that there was at least one
-			 * type B command that needed to be
-			 * executed but there were no type C
-			 * commands to be executed so just
-			 * release all locks and restart the
-			 * processing.
+			 * Critical Section Part 3:
+			 * Read the global commands list and execute the worker's type
+			 * B commands that it has counted when taking its commands.
+			 *
+			 * Alarms of the given message type may have all been cancelled
+			 * by the other workers since the command has been inserted. The
+			 * shard of the new alarm handler thread is therefore read locked
+			 * for it before it is created, so that none of its alarms can be
+			 * removed before it has been assigned them and it is the new
+			 * thread which releases the reader lock(see alarm_handler).
+			 *
+			 * A thread which is parked in the pool of alarm handler threads
+			 * is reused for the command(by handing it the command's node)
+			 * instead of creating a new one whenever the pool is not empty.
 			 */
-			goto TYPE_C_BEFORE_RELEASE_LOCKS;
-		} /* (cmdc_list_head != NULL) */
+			prev_cmdb = NULL;
+			for (curr_cmdb = cmdb_list_head; (curr_cmdb != NULL) && (worker->cmdb_count != 0); curr_cmdb = next_cmdb) {
+				next_cmdb = curr_cmdb->link;
 
+				if ((curr_cmdb->is_processed) || (curr_cmdb->worker != worker->index)) {
+					prev_cmdb = curr_cmdb;
+					continue;
+				}
+				--(worker->cmdb_count);
+				--cmd_queue_depth;
+
+				/* Obtain reader lock on behalf of the new alarm handler thread. */
+				shard = ALARM_SHARD(curr_cmdb->msg_type);
+				obtain_alarm_read_lock(shard, NULL);
+				for (curr_alarm = shard->alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+					if (curr_alarm->msg_type == curr_cmdb->msg_type) { break; }
+				}
+
+				if (curr_alarm == NULL) {
+					/* Release reader lock. */
+					release_alarm_read_lock(shard, NULL);
+
+					/* Print status message informing the user of the internal state. */
+					fprintf(app_log, "Alarms with message type = %" PRIuFAST32 \
+								" no longer exist in the alarms list so Command thread with ID = %" \
+								PRIuFAST64 " did not create an Alarm thread for them at %" \
+								PRIuFAST64 ".\n", curr_cmdb->msg_type, id, now());
+					complete_cmd_request(&(curr_cmdb->req), CMD_DONE_IGNORED, NULL);
+
+					/* Remove the command from the global commands list and free it. */
+					if (prev_cmdb == NULL) {
+						cmdb_list_head = next_cmdb;
+					} else { /* (prev_cmdb != NULL) */
+						prev_cmdb->link = next_cmdb;
+					}
+					if (curr_cmdb == cmdb_list_tail) {
+						cmdb_list_tail = prev_cmdb;
+					}
+					if (curr_cmdb == cmdb_list_new_elm) {
+						cmdb_list_new_elm = next_cmdb;
+					}
+					curr_cmdb->link = NULL;
+					close_alarm_wakeup(curr_cmdb);
+					free(curr_cmdb);
+					continue;
+				}
 
+				/* Set the command's state to PROCESSED. */
+				curr_cmdb->is_processed = true;
 
-TYPE_B_BEFORE_RELEASE_LOCKS:
-		/* Release all necessary locks. */
-		cmd_handler_release_locks(&old_state);
+				/*
+				 * Add the new alarm handler thread to the live alarm handler
+				 * threads of its shard so that the alarms inserted after it has
+				 * searched the shard are posted to its inbox.
+				 */
+				status = pthread_mutex_lock(&(shard->handler_mutex));
+				if (status != 0) {
+					EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+				}
+				curr_cmdb->shard_link = shard->handler_list_head;
+				shard->handler_list_head = curr_cmdb;
+				status = pthread_mutex_unlock(&(shard->handler_mutex));
+				if (status != 0) {
+					EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+				}
 
+				if (alarm_pool_head != NULL) {
+					/* Take the most recently parked thread out of the pool. */
+					park = alarm_pool_head;
+					alarm_pool_head = alarm_pool_head->link;
+					--alarm_pool_size;
+					park->link = NULL;
+
+					/* Hand the command's node to the parked thread and wake it up. */
+					park->next_handler = curr_cmdb;
+					curr_cmdb->id = park->id;
+					if (wake_alarm_handler(park) != 0) {
+						EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+					}
+					++alarm_threads_reused;
+
+					/* Print status message informing the user of the internal state. */
+					fprintf(app_log, "Parked Alarm thread with ID = %" PRIuFAST64 \
+								" reused for message type = %" PRIuFAST32 \
+								" by Command thread with ID = %" \
+								PRIuFAST64 " at %" PRIuFAST64 ".\n",
+								(uint_fast64_t) curr_cmdb->id,
+								curr_cmdb->msg_type, id, now());
+				} else { /* (alarm_pool_head == NULL) */
+					/* Create the alarm handler thread with the alarm thread attributes. */
+					status = pthread_create(&(curr_cmdb->id), &alarm_thread_attr,
+								alarm_handler, (void *) curr_cmdb);
+					if (status != 0) {
+						EXIT_ERR(THREAD_CREATE_ERR_MSG, THREAD_CREATE_ERR);
+					}
+					++alarm_threads_created;
+
+					/* Print status message informing the user of the internal state. */
+					fprintf(app_log, "New Alarm thread with ID = %" PRIuFAST64 \
+								" for message type = %" PRIuFAST32 \
+								" created by Command thread with ID = %" \
+								PRIuFAST64 " at %" PRIuFAST64 ".\n",
+								(uint_fast64_t) curr_cmdb->id,
+								curr_cmdb->msg_type, id, now());
+				}
+				if (++alarm_threads_running > alarm_threads_peak) {
+					alarm_threads_peak = alarm_threads_running;
+				}
+				complete_cmd_request(&(curr_cmdb->req), CMD_DONE_APPLIED, NULL);
+				++(worker->applied);
 
+				prev_cmdb = curr_cmdb;
+			}
 
-		/* Give other threads a chance to obtain locks. */
+			/* Update type B commands list new element pointer. */
+			while ((cmdb_list_new_elm != NULL) && (cmdb_list_new_elm->is_processed)) {
+				cmdb_list_new_elm = cmdb_list_new_elm->link;
+			}
 
+			/* Wake up the parsers waiting for room in the global commands list. */
+			if (pthread_cond_broadcast(&cmd_queue_cond_var) != 0) {
+				EXIT_ERR(COND_VAR_BROADCAST_ERR_MSG, COND_VAR_BROADCAST_ERR);
+			}
 
+			/* Release all necessary locks. */
+			cmd_handler_release_locks(&old_state);
+		}
 
-		/* Obtain all necessary locks. */
-		cmd_handler_obtain_locks(&old_state);
-TYPE_C_AFTER_OBTAIN_LOCKS:
 
 
+		if ((worker->cmdc_list_head == NULL) && (worker->cmdd_list_head == NULL)) {
+			continue;
+		}
 
-		/* Lock alarm_cancel_mutex for potential conditional wait. */
-		status = pthread_mutex_lock(&alarm_cancel_mutex);
+		/*
+		 * The type A commands with message numbers in the ranges of this
+		 * worker's type C commands(or of the message types of its type D
+		 * commands) are applied by the workers of their own message numbers.
+		 * Wait until the ones inserted before the type C and D commands have
+		 * been applied(see find_prior_cmda), so that they are still applied
+		 * in the order of their insertion. Workers only wait here once they
+		 * have applied their own type A commands and only for type A commands
+		 * inserted before the commands that they apply, so the worker waiting
+		 * for the earliest inserted ones is never waited on in turn.
+		 *
+		 * The thread may be cancelled while it is waiting, in which case
+		 * the cleanup routine unlocks cmd_mutex again.
+		 */
+		/* Lock cmd_mutex. */
+		status = pthread_mutex_lock(&cmd_mutex);
 		if (status != 0) {
 			EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
 		}
+		pthread_cleanup_push(cleanup_cmd_handler, (void *) (&cmd_mutex));
+
+		for (curr_cmdc = worker->cmdc_list_head; curr_cmdc != NULL; curr_cmdc = curr_cmdc->link) {
+			while (find_prior_cmda(curr_cmdc->seq, 0, curr_cmdc->msg_num, curr_cmdc->msg_num_last) != NULL) {
+				status = pthread_cond_wait(&cmda_applied_cond_var, &cmd_mutex);
+				if (status != 0) {
+					EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
+				}
+			}
+		}
+		for (curr_cmdd = worker->cmdd_list_head; curr_cmdd != NULL; curr_cmdd = curr_cmdd->link) {
+			while (find_prior_cmda(curr_cmdd->seq, curr_cmdd->msg_type, 0, 0) != NULL) {
+				status = pthread_cond_wait(&cmda_applied_cond_var, &cmd_mutex);
+				if (status != 0) {
+					EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
+				}
+			}
+		}
+
+		/* Unlock cmd_mutex. */
+		pthread_cleanup_pop(1);
+
+		/* Disable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+		}
 
 		/*
-		 * Critical Section Part 3:
-		 * Read the global commands list and execute all type C commands.
+		 * Critical Section Part 4:
+		 * Execute all of the worker's type C commands.
 		 */
-		while (cmdc_list_head != NULL) {
+		while (worker->cmdc_list_head != NULL) {
 			/*
 			 * Save the current first command C node in curr_cmdc.
 			 *
 			 * Move the head to the next command C node.
 			 *
-			 * Save the message number of the alarm that should be cancelled.
+			 * Save the range of message numbers of the alarms that should be cancelled
+			 * and the request that the command was submitted with.
 			 *
 			 * Detach and free the command C node saved in curr_cmdc.
 			 */
-			curr_cmdc = cmdc_list_head;
-			cmdc_list_head = cmdc_list_head->link;
+			curr_cmdc = worker->cmdc_list_head;
+			worker->cmdc_list_head = worker->cmdc_list_head->link;
+			if (worker->cmdc_list_head == NULL) {
+				worker->cmdc_list_tail = NULL; /* Update type C commands list tail. */
+			}
 			cancel_msg_num = curr_cmdc->msg_num;
+			cancel_msg_num_last = curr_cmdc->msg_num_last;
+			cancel_seq = curr_cmdc->seq;
+			req = curr_cmdc->req;
 			curr_cmdc->link = NULL;
 			free(curr_cmdc);
 
 			/*
-			 * Find the corresponding alarm node and
-			 * remove it from the alarms list while
-			 * also freeing all allocated resources.
+			 * Every shard of the alarms list is sorted by message numbers
+			 * so all of its alarms in the range are consecutive nodes of
+			 * the shard. Find their predecessors through the express lanes
+			 * and then remove every run of consecutive alarms of the range
+			 * from every lane at once, i.e., the entire range unless some of
+			 * its alarms have been inserted by type A commands inserted after
+			 * the command(see cmda_seq of Alarm), which are kept. The removed
+			 * alarms of all of the shards are chained together through their
+			 * link attributes so that they can be freed after the alarm
+			 * handler threads have detached them.
+			 *
+			 * Each shard is locked(as a writer) while it is searched and
+			 * modified and the shards are locked one at a time.
 			 */
-			prev_alarm = NULL;
-			for (curr_alarm = alarm_list_head; curr_alarm != NULL; /* Update inside. */) {
-				if (curr_alarm->msg_num == cancel_msg_num) {
-					/* Remove the alarm from the global alarms list. */
-					if (curr_alarm == alarm_list_head) {
-						/* The current alarm is the first alarm in the list. */
-
-						/* Update the head pointer of the list. */
-						alarm_list_head = alarm_list_head->link;
-					} else { /* (curr_alarm != alarm_list_head) */
-						/* The current alarm is NOT the first alarm in the list. */
-
-						/* Make the prev node point to the next node in the list. */
-						prev_alarm->link = curr_alarm->link;
+			cancel_list_head = NULL;
+			for (shard = alarm_shards; shard != alarm_shards + ALARM_SHARDS; ++shard) {
+				obtain_alarm_write_lock(shard);
+				find_alarm_preds(&(shard->alarm_list_head), shard->alarm_express_head,
+							cancel_msg_num, preds);
+				shard_cancel_head = NULL;
+				curr_alarm = *alarm_lane(&(shard->alarm_list_head), shard->alarm_express_head, preds[0], 0);
+				while ((curr_alarm != NULL) && (curr_alarm->msg_num <= cancel_msg_num_last)) {
+					if (curr_alarm->cmda_seq > cancel_seq) {
+						/* The current alarm is now the predecessor in all of its lanes. */
+						for (lane = 0; lane < curr_alarm->lanes; ++lane) { preds[lane] = curr_alarm; }
+						curr_alarm = curr_alarm->link;
+						continue;
 					}
 
-					/*
-					 * Set the cancelled flag for the element
-					 * saved in curr_alarm and remove it from
-					 * the global alarms list.
-					 */
-					curr_alarm->link = NULL;
-					curr_alarm->is_cancelled = true;
+					/* Remove the run of alarms up to the next kept one(or the end of the range). */
+					run_last = curr_alarm;
+					while ((run_last->link != NULL) && (run_last->link->msg_num <= cancel_msg_num_last) &&
+						(run_last->link->cmda_seq < cancel_seq)) {
+
+						run_last = run_last->link;
+					}
+					curr_alarm = unlink_alarm_range(&(shard->alarm_list_head), shard->alarm_express_head,
+									preds, run_last->msg_num);
+					run_last->link = shard_cancel_head;
+					shard_cancel_head = curr_alarm;
 
-					/* Terminate the searching for loop. */
-					break;
-				} else { /* (curr_alarm->msg_num != cancel_msg_num) */
 					/* Move to the next element. */
-					prev_alarm = curr_alarm;
-					curr_alarm = curr_alarm->link;
+					curr_alarm = *alarm_lane(&(shard->alarm_list_head), shard->alarm_express_head, preds[0], 0);
+				}
+				#ifdef ALARM_TABLE_SHM
+					/* Remove the removed alarms from the shared alarm table. */
+					for (curr_alarm = shard_cancel_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+						remove_alarm_record(curr_alarm->msg_num);
+					}
+				#endif
+				release_alarm_write_lock(shard);
+
+				/* Move the removed alarms to the cancelled alarms list. */
+				while (shard_cancel_head != NULL) {
+					curr_alarm = shard_cancel_head;
+					shard_cancel_head = shard_cancel_head->link;
+					curr_alarm->link = cancel_list_head;
+					cancel_list_head = curr_alarm;
 				}
 			}
 
 			/*
-			 * At this point we know the following:
-			 * 		1. curr_alarm != NULL
-			 * 		2. curr_alarm->link == NULL
-			 * 		3. curr_alarm->is_cancelled
-			 */
-
-			/* Reset handler_id to NULL. */
-			handler_id = NULL;
-
-			/*
-			 * We only have to worry about the
-			 * cancellation of an assigned alarm.
+			 * The alarms may have already been cancelled by a type
+			 * C or type D command that was applied before this one.
 			 */
-			if (curr_alarm->is_assigned) {
-				/*
-				 * We know that the alarm handler thread is
-				 * going to cancel itself since the current
-				 * alarm is being handled(is_assigned) and no
-				 * other alarm is being handled(link_handle == NULL)
-				 * by this alarm handler thread.
-				 */
-				if (curr_alarm->link_handle == NULL) {
-					/*
-					 * Save the alarm handler thread's ID so
-					 * that we can find the corresponding type
-					 * B command node, remove it from the
-					 * commands list and free all allocated
-					 * resources.
-					 */
-					handler_id = curr_alarm->handler_id;
+			if (cancel_list_head == NULL) {
+				/* Print status message informing the user of the internal state. */
+				if (cancel_msg_num == cancel_msg_num_last) {
+					fprintf(app_log, "Alarm with message number = %" PRIuFAST32 \
+								" no longer exists in the alarms list so it cannot be deleted by Command thread with ID = %" \
+								PRIuFAST64 " at %" PRIuFAST64 ".\n", cancel_msg_num, id, now());
+				} else { /* (cancel_msg_num != cancel_msg_num_last) */
+					fprintf(app_log, "Alarms with message numbers in [%" PRIuFAST32 ", %" PRIuFAST32 \
+								"] no longer exist in the alarms list so they cannot be deleted by Command thread with ID = %" \
+								PRIuFAST64 " at %" PRIuFAST64 ".\n", cancel_msg_num, cancel_msg_num_last, id, now());
 				}
-
-				/*
-				 * Block this thread(command handler) until another thread(alarm handler) signals
-				 * the appropriate conditional variable(alarm_cancel_cond_var). While this thread
-				 * is blocked, the mutex(alarm_cancel_mutex) is released, then re-aquired before
-				 * this thread is woken up and the call returns.
-				 *
-				 * We do not need to release the writer lock on the alarms list since while this
-				 * thread is blocked, the main thread will also be blocked but since the alarm
-				 * handler thread that set the is_assigned of the Alarm structure pointed to by
-				 * curr_alarm is not blocked, it will eventually signal the conditional variable
-				 * which will wake this thread back up.
-				 *
-				 * The reason for this is that the alarm handler threads only obtain a reader lock
-				 * in the beginning of their creation and pick out all alarms that they are handling
-				 * and from then on, they just loop to print the previously picked out alarms.
-				 *
-				 * When using conditional variables, there is always a boolean predicate involving
-				 * shared variables associated with each conditional wait that is true if the thread
-				 * should proceed. Spurious wakeups from pthread_cond_timedwait() or pthread_cond_wait()
-				 * functions may occur. Since the return from pthread_cond_timedwait() or
-				 * pthread_cond_wait() does not imply anything about the value of the predicate, the
-				 * predicate should be re-evaluated upon such return.
-				 *
-				 * Mesa-style implies while loop. Hoare-style implies if statement.
-				 */
-				while (curr_alarm->is_assigned) {
-					status = pthread_cond_wait(&alarm_cancel_cond_var, &alarm_cancel_mutex);
-					if (status != 0) {
-						EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
-					}
-				} /* (!curr_alarm->is_assigned) */
+				complete_cmd_request(&req, CMD_DONE_IGNORED, NULL);
+				continue;
 			}
 
+			/* Wait for the alarm handler threads to detach the cancelled alarms. */
+			cancel_count = cmd_handler_detach_alarms(cancel_list_head);
+
 			/* Print status message informing the user of the internal state. */
-			fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
-						" and message number = %" PRIuFAST32 \
-						" has been deleted from the alarms list by Command thread with ID = %" \
-						PRIuFAST64 " at %" PRIuFAST64 ".\n",
-						curr_alarm->msg_type, curr_alarm->msg_num, id, now());
+			if (cancel_msg_num == cancel_msg_num_last) {
+				fprintf(app_log, "Alarm with message type = %" PRIuFAST32 \
+							" and message number = %" PRIuFAST32 \
+							" has been deleted from the alarms list by Command thread with ID = %" \
+							PRIuFAST64 " at %" PRIuFAST64 ".\n",
+							cancel_list_head->msg_type, cancel_list_head->msg_num, id, now());
+			} else { /* (cancel_msg_num != cancel_msg_num_last) */
+				fprintf(app_log, "All %" PRIuFAST64 " alarms with message numbers in [%" PRIuFAST32 \
+							", %" PRIuFAST32 "] have been deleted from the alarms list by Command thread with ID = %" \
+							PRIuFAST64 " at %" PRIuFAST64 ".\n",
+							cancel_count, cancel_msg_num, cancel_msg_num_last, id, now());
+			}
+			complete_cmd_request(&req, CMD_DONE_APPLIED, NULL);
+			++(worker->applied);
+
+			/* Free the cancelled alarms. */
+			cmd_handler_free_alarms(cancel_list_head);
+		}
 
+		/*
+		 * Critical Section Part 5:
+		 * Execute all of the worker's type D commands.
+		 */
+		while (worker->cmdd_list_head != NULL) {
 			/*
-			 * If the alarm was assigned to an alarm handler thread,
-			 * then its link_handle attribute has been set to NULL by
-			 * the thread's cleanup routine.
+			 * Save the current first command D node in curr_cmdd.
+			 *
+			 * Move the head to the next command D node.
 			 *
-			 * If the alarm was unassigned then its link_handle
-			 * attribute was initialized to NULL and has remained so.
+			 * Save the message type of the alarms that should be cancelled
+			 * and the request that the command was submitted with.
 			 *
-			 * Therefore, at this point, we should be able to safely
-			 * free the Alarm structure pointed to by curr_alarm.
+			 * Detach and free the command D node saved in curr_cmdd.
 			 */
-			free(curr_alarm);
+			curr_cmdd = worker->cmdd_list_head;
+			worker->cmdd_list_head = worker->cmdd_list_head->link;
+			if (worker->cmdd_list_head == NULL) {
+				worker->cmdd_list_tail = NULL; /* Update type D commands list tail. */
+			}
+			cancel_msg_type = curr_cmdd->msg_type;
+			cancel_seq = curr_cmdd->seq;
+			req = curr_cmdd->req;
+			curr_cmdd->link = NULL;
+			free(curr_cmdd);
 
 			/*
-			 * (handler_id != NULL) implies (alarm handler
-			 * thread with ID *handler_id has self terminated)
+			 * Find all corresponding alarm nodes and remove them
+			 * from the shard of the alarms list which stores them
+			 * in a single pass. The removed nodes are chained together
+			 * through their(now unused) link attributes so that they
+			 * can be freed after the alarm handler thread has detached
+			 * them.
+			 *
+			 * The predecessors of the current alarm in every lane
+			 * of the shard are maintained during the pass so that
+			 * it can also be removed from the express lanes.
+			 *
+			 * Only the shard of the given message type is locked(as a
+			 * writer) so the readers of all other shards are not blocked.
+			 *
+			 * The alarms inserted by type A commands inserted after the
+			 * command(see cmda_seq of Alarm) are kept.
 			 */
-			if (handler_id != NULL) {
-				/*
-				 * Free allocated resources by joining with
-				 * alarm handler thread and freeing memory.
-				 */
-				cmd_handler_join_with_alarm_handler(handler_id);
-			} /* (handler_id == NULL) */
-		}
-		cmdc_list_tail = NULL; /* Update type C commands list tail. */
+			cancel_list_head = NULL;
+			shard = ALARM_SHARD(cancel_msg_type);
+			obtain_alarm_write_lock(shard);
+			for (lane = 0; lane < ALARM_SKIP_LIST_LANES; ++lane) { preds[lane] = NULL; }
+			for (curr_alarm = shard->alarm_list_head; curr_alarm != NULL; /* Update inside. */) {
+				if ((curr_alarm->msg_type == cancel_msg_type) && (curr_alarm->cmda_seq < cancel_seq)) {
+					/* Remove the alarm from every lane of the shard. */
+					unlink_alarm_range(&(shard->alarm_list_head), shard->alarm_express_head,
+									preds, curr_alarm->msg_num);
+					#ifdef ALARM_TABLE_SHM
+						remove_alarm_record(curr_alarm->msg_num);
+					#endif
 
-		/* Unlock alarm_cancel_mutex. */
-		status = pthread_mutex_unlock(&alarm_cancel_mutex);
-		if (status != 0) {
-			EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
-		}
+					/*
+					 * Insert the element saved in curr_alarm as the
+					 * new first element of the cancelled alarms list.
+					 */
+					curr_alarm->link = cancel_list_head;
+					cancel_list_head = curr_alarm;
 
+					/* Move to the next element. */
+					curr_alarm = *alarm_lane(&(shard->alarm_list_head), shard->alarm_express_head, preds[0], 0);
+				} else { /* (curr_alarm->msg_type != cancel_msg_type) || (curr_alarm->cmda_seq > cancel_seq) */
+					/* The current alarm is now the predecessor in all of its lanes. */
+					for (lane = 0; lane < curr_alarm->lanes; ++lane) { preds[lane] = curr_alarm; }
 
+					/* Move to the next element. */
+					curr_alarm = curr_alarm->link;
+				}
+			}
+			release_alarm_write_lock(shard);
 
-TYPE_C_BEFORE_RELEASE_LOCKS:
-		/* Release all necessary locks. */
-		cmd_handler_release_locks(&old_state);
-	}
+			/*
+			 * Wait(single handshake) for the alarm handler thread to detach
+			 * all of the cancelled alarms. Alarm handler threads of a given
+			 * message type are unique, so all assigned alarms of the given
+			 * message type are being handled by the same thread.
+			 */
+			cancel_count = cmd_handler_detach_alarms(cancel_list_head);
 
+			/* Print status message informing the user of the internal state. */
+			fprintf(app_log, "All %" PRIuFAST64 " alarms with message type = %" PRIuFAST32 \
+						" have been deleted from the alarms list by Command thread with ID = %" \
+						PRIuFAST64 " at %" PRIuFAST64 ".\n",
+						cancel_count, cancel_msg_type, id, now());
+			complete_cmd_request(&req, CMD_DONE_APPLIED, NULL);
+			++(worker->applied);
 
+			/*
+			 * The alarm handler thread(if any) now lingers since all of
+			 * the alarms that it was handling have been cancelled.
+			 */
+			cmd_handler_free_alarms(cancel_list_head);
+		}
 
-	/*
-	 * POSIX.1 permits pthread_cleanup_push() and pthread_cleanup_pop()
-	 * to be implemented as macros that expand to text containing
-	 * '{' and '}', respectively. For this reason, the caller must ensure
-	 * that calls to these functions are paired within the same function,
-	 * and at the same lexical nesting level. In other words, a cleanup
-	 * handler is established only during the execution of a specified
-	 * section of code.
-	 *
-	 * Therefore, the following call is needed to pair the call to
-	 * pthread_cleanup_push made in the beginning of this thread's
-	 * execution.
-	 *
-	 * The pop is however placed in a section of code that will never be
-	 * reached since the command handler thread is meant to be cancelled
-	 * by the main thread which is when the cleanup routines will be
-	 * actually popped and executed.
-	 */
-	pthread_cleanup_pop(1);
+		/* Enable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+		}
+	}
 
 
 
@@ -551,138 +947,148 @@ TYPE_C_BEFORE_RELEASE_LOCKS:
 }
 
 /*
- * The only invocations of this function should be from the command handler thread.
+ * The only invocations of this function should be from the command handler threads.
+ *
+ * Alarms are partitioned into the shards of the alarms list by their message
+ * types while message numbers are unique across all of the shards. Therefore,
+ * if there is an alarm with the given message number in a shard other than
+ * the one of the given message type, then it has to be removed from that shard
+ * before an alarm of the given message type can replace it. The removal is
+ * exactly like its cancellation, i.e., the responsible alarm handler thread(if
+ * any) is woken up and waited on until it has detached the alarm.
  *
- * If handler_id is NULL then do nothing and just return 0 to the caller.
+ * Each of the other shards is locked(as a writer) while it is searched
+ * and modified. alarm_cancel_mutex is then locked for the detach request.
  *
- * If handler_id is not NULL then join with the alarm handler thread with
- * ID *handler_id and release all allocated resources and return the alarm
- * handler thread's message type which is guaranteed to be non-zero.
+ * Precondition: alarm_cancel_mutex is not locked by the caller
+ *
+ * Returns: The removed(and detached) alarm, which the caller reuses for
+ * the new alarm, or NULL if there is no such alarm in the other shards
  */
-uint_fast32_t cmd_handler_join_with_alarm_handler(pthread_t *handler_id) {
-	/* Stores the return value of the current method. */
-	uint_fast32_t result = 0;
-
-
-
-	/* Command type B pointer used for iterating over the commands list. */
-	CmdB *curr_cmdb = NULL;
+Alarm * cmd_handler_move_alarm(const uint_fast32_t msg_num, const uint_fast32_t msg_type) {
+	/* The shard of the alarms list which is being searched. */
+	AlarmShard *shard = NULL;
+	/* Pointer to the removed alarm. */
+	Alarm *old_alarm = NULL;
 	/*
-	 * Command type B pointer used to save the pointer to the previous
-	 * node in the global commands list when removing nodes from the list
-	 * as a result of an appropriate type A or type C command.
+	 * The last alarm in each lane of the shard with
+	 * a smaller message number than the given one.
 	 */
-	CmdB *prev_cmdb = NULL;
+	Alarm *preds[ALARM_SKIP_LIST_LANES];
 
 
 
-	/* Return to caller immediately if handler_id is NULL. */
-	if (handler_id == NULL) { return 0; }
+	for (shard = alarm_shards; shard != alarm_shards + ALARM_SHARDS; ++shard) {
+		if (shard == ALARM_SHARD(msg_type)) { continue; }
 
+		obtain_alarm_write_lock(shard);
+		find_alarm_preds(&(shard->alarm_list_head), shard->alarm_express_head, msg_num, preds);
+		old_alarm = *alarm_lane(&(shard->alarm_list_head), shard->alarm_express_head, preds[0], 0);
+		if ((old_alarm != NULL) && (old_alarm->msg_num == msg_num)) {
+			/* Remove the alarm from every lane of its shard. */
+			unlink_alarm_range(&(shard->alarm_list_head), shard->alarm_express_head, preds, msg_num);
+			release_alarm_write_lock(shard);
+			old_alarm->link = NULL;
 
+			/*
+			 * Wait(single handshake) for the alarm handler thread(if any)
+			 * to detach the alarm after waking it up.
+			 */
+			cmd_handler_detach_alarms(old_alarm);
 
-	/*
-	 * Find the corresponding type B command node
-	 * and remove it from the commands list while
-	 * also freeing all allocated resources.
-	 */
-	prev_cmdb = NULL;
-	for (curr_cmdb = cmdb_list_head; curr_cmdb != NULL; /* Update inside. */) {
-		/* pthread_equal never fails. */
-		if ((curr_cmdb->is_processed) &&
-			(pthread_equal(curr_cmdb->id, *handler_id) != 0)) {
+			return old_alarm;
+		}
+		release_alarm_write_lock(shard);
+	}
 
-			/* Remove the command from the global commands list. */
-			if (curr_cmdb == cmdb_list_head) {
-				/* The current command is the first command in the list. */
+	return NULL;
+}
 
-				/*
-				 * Update the tail pointer of the list if
-				 * there is only 1 element in the list.
-				 */
-				if (cmdb_list_head == cmdb_list_tail) {
-					cmdb_list_tail = NULL;
-				}
-				/* Update the head pointer of the list. */
-				cmdb_list_head = cmdb_list_head->link;
+/*
+ * The only invocations of this function should be from the command handler threads.
+ *
+ * Cancel all of the alarms of the given list(chained through their link
+ * attributes) which have already been removed from the alarms list. The
+ * alarm handler threads which are handling any of them are woken up and
+ * waited on until they have detached them. Each alarm handler thread
+ * detaches all of its cancelled alarms in the same wakeup which means
+ * that there is only a single handshake per alarm handler thread
+ * regardless of the size of the list.
+ *
+ * Precondition: alarm_cancel_mutex is not locked by the caller
+ *
+ * Returns: The number of alarms in the list
+ */
+uint_fast64_t cmd_handler_detach_alarms(Alarm *cancel_list_head) {
+	/* Stores the return value of the current method. */
+	uint_fast64_t result = 0;
 
-				/* Detach the element saved in curr_cmdb. */
-				curr_cmdb->link = NULL;
 
-				/*
-				 * No need to update curr_cmdb since we are going to
-				 * terminate the entire loop with a break statement.
-				 *
-				 * Update:
-				 * curr_cmdb = cmdb_list_head;
-				 */
-			} else { /* (curr_cmdb != cmdb_list_head) */
-				/* The current command is NOT the first command in the list. */
 
-				/* Make the prev node point to the next node in the list. */
-				prev_cmdb->link = curr_cmdb->link;
+	/* Alarm pointer used for iterating over the list. */
+	Alarm *curr_alarm = NULL;
+	/* Is at least one of the alarms assigned to an alarm handler thread? */
+	bool is_assigned = false;
 
-				/*
-				 * Update the tail pointer of the list if
-				 * the node being removed is the last
-				 * node in the list.
-				 */
-				if (curr_cmdb == cmdb_list_tail) {
-					cmdb_list_tail = prev_cmdb;
-				}
 
-				/* Detach the element saved in curr_cmdb. */
-				curr_cmdb->link = NULL;
 
-				/*
-				 * No need to update curr_cmdb since we are going to
-				 * terminate the entire loop with a break statement.
-				 *
-				 * Update:
-				 * curr_cmdb = prev_cmdb->link;
-				 */
-			}
+	/* Lock alarm_cancel_mutex. */
+	if (pthread_mutex_lock(&alarm_cancel_mutex) != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
 
-			/* Terminate the searching for loop. */
-			break;
-		} else { /* (!curr_cmdb->is_processed) || (pthread_equal(curr_cmdb->id, *handler_id) == 0) */
-			/* Move to the next element. */
-			prev_cmdb = curr_cmdb;
-			curr_cmdb = curr_cmdb->link;
+	/*
+	 * Set the cancelled flag of every alarm and make a detach
+	 * request to the alarm handler thread of every assigned alarm.
+	 */
+	for (curr_alarm = cancel_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+		curr_alarm->is_cancelled = true;
+		++result;
+
+		if (curr_alarm->is_assigned) {
+			++(curr_alarm->handler->detach_requests);
+			++(curr_alarm->handler->detach_waiters);
+			is_assigned = true;
+			/*
+			 * Only wake up the responsible alarm handler thread since
+			 * it otherwise sleeps until its next due alarms.
+			 */
+			if (wake_alarm_handler(curr_alarm->handler) != 0) {
+				EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+			}
 		}
 	}
 
 	/*
-	 * At this point we know the following:
-	 * 		1. curr_cmdb != NULL
-	 * 		2. curr_cmdb->is_processed
-	 * 		3. pthread_equal(curr_cmdb->id, *handler_id)
+	 * Block this thread(command handler) until the alarm handler threads
+	 * broadcast the appropriate conditional variable(alarm_cancel_cond_var)
+	 * after detaching the cancelled alarms. While this thread is blocked,
+	 * the mutex(alarm_cancel_mutex) is released, then re-aquired before
+	 * this thread is woken up and the call returns.
 	 *
-	 * Join with the alarm handler thread
-	 * to free the allocated resources. We
-	 * do not care about its return value
-	 * which is why we pass NULL as the
-	 * second argument to pthread_join.
+	 * Mesa-style implies while loop. Hoare-style implies if statement.
 	 */
+	if (is_assigned) {
+		for (curr_alarm = cancel_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+			while (curr_alarm->is_assigned) {
+				if (pthread_cond_wait(&alarm_cancel_cond_var, &alarm_cancel_mutex) != 0) {
+					EXIT_ERR(COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
+				}
+			} /* (!curr_alarm->is_assigned) */
+		}
+	}
 
-	/* Save the alarm handler thread's message type. */
-	result = curr_cmdb->msg_type;
-
-	/* Print status message informing the user of the internal state. */
-	fprintf(app_log, "Command thread with ID = %" PRIuFAST64 \
-				" is joining with Alarm thread with ID = %" \
-				PRIuFAST64 " handling alarms with message type = %" \
-				PRIuFAST32 " at %" PRIuFAST64 ".\n",
-				(uint_fast64_t) pthread_self(), (uint_fast64_t) curr_cmdb->id,
-				result, now());
-
-	/* Join with the alarm handler thread. */
-	if (pthread_join(curr_cmdb->id, NULL) != 0) {
-		EXIT_ERR(THREAD_JOIN_ERR_MSG, THREAD_JOIN_ERR);
+	/* End the detach requests. */
+	for (curr_alarm = cancel_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+		if ((curr_alarm->handler != NULL) && (end_detach_request(curr_alarm) != 0)) {
+			EXIT_ERR(WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+		}
 	}
 
-	/* Free the element saved in curr_cmdb. */
-	free(curr_cmdb);
+	/* Unlock alarm_cancel_mutex. */
+	if (pthread_mutex_unlock(&alarm_cancel_mutex) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
 
 
 
@@ -690,69 +1096,47 @@ uint_fast32_t cmd_handler_join_with_alarm_handler(pthread_t *handler_id) {
 }
 
 /*
- * The command handler thread cleanup routine.
+ * The only invocations of this function should be from the command handler threads.
  *
- * Precondition: arg can be safely casted into (int *).
+ * Free the entire list of alarms which have been detached by
+ * cmd_handler_detach_alarms.
  */
-void cleanup_cmd_handler(void *arg) {
-	/* Stores the return status of functions. */
-	int status = *((int *) arg);
-	/*
-	 * The above use of arg is just so that we can avoid
-	 * a -Wunused-variable warning/error during compilation
-	 * otherwise the argument is indeed unused. However, we
-	 * have to have it since pthread_cleanup_push requires
-	 * the cleanup handler to have the above signature.
-	 */
-
-
+void cmd_handler_free_alarms(Alarm *cancel_list_head) {
+	/* Alarm pointer used for iterating over the list. */
+	Alarm *curr_alarm = NULL;
 
-	/*
-	 * The pthread_mutex_trylock() function shall be equivalent
-	 * to pthread_mutex_lock(), except that if the mutex object
-	 * referenced by the argument is currently locked (by any
-	 * thread, including the current thread), the call shall
-	 * return immediately.
-	 *
-	 * The pthread_mutex_trylock() function shall return zero if
-	 * a lock on the mutex object referenced by the argument is
-	 * acquired. Otherwise, an error number is returned to indicate
-	 * the error.
-	 *
-	 * The pthread_mutex_trylock() function shall fail if the mutex
-	 * could not be acquired because it was already locked in which
-	 * case it will return EBUSY.
-	 *
-	 *
-	 * We first invoke pthread_mutex_trylock() in an attempt to
-	 * lock the mutex. Then if it was unlocked, then the function
-	 * will return zero and if it was locked, it will return EBUSY.
-	 *
-	 * Since the only thread that actually locks new_cmd_insert_mutex
-	 * and/or alarm_cancel_mutex is the command handler thread itself,
-	 * then we can indeed attempt to unlock the mutexes in either of
-	 * the two situations described above.
-	 */
 
 
+	while (cancel_list_head != NULL) {
+		/* Save the current first element. */
+		curr_alarm = cancel_list_head;
+		/* Move to the next element. */
+		cancel_list_head = cancel_list_head->link;
 
-	/* Guarantee that new_cmd_insert_mutex is unlocked. */
-	status = pthread_mutex_trylock(&new_cmd_insert_mutex);
-	if ((status != 0) && (status != EBUSY)) {
-		EXIT_ERR(MUTEX_TRYLOCK_ERR_MSG, MUTEX_TRYLOCK_ERR);
-	}
-	status = pthread_mutex_unlock(&new_cmd_insert_mutex);
-	if (status != 0) {
-		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		/* Detach and free the element saved in curr_alarm. */
+		curr_alarm->link = NULL;
+		free(curr_alarm);
 	}
+}
 
-	/* Guarantee that alarm_cancel_mutex is unlocked. */
-	status = pthread_mutex_trylock(&alarm_cancel_mutex);
-	if ((status != 0) && (status != EBUSY)) {
-		EXIT_ERR(MUTEX_TRYLOCK_ERR_MSG, MUTEX_TRYLOCK_ERR);
-	}
-	status = pthread_mutex_unlock(&alarm_cancel_mutex);
-	if (status != 0) {
+/*
+ * The command handler thread cleanup routine used while it is
+ * waiting on its new_cmd_insert_cond_var which unlocks the mutex.
+ *
+ * Precondition: arg can be safely casted into (pthread_mutex_t *)
+ * which points to a mutex that is locked by the caller.
+ */
+void cleanup_cmd_handler(void *arg) {
+	/*
+	 * alarm_cancel_mutex on the other hand is never unlocked here and
+	 * neither is cmd_mutex, other than while waiting on cmda_applied_cond_var.
+	 * This is safe since the command handler threads otherwise only lock
+	 * them while their cancellation is disabled which means that they can
+	 * never be cancelled while owning them.
+	 */
+
+	/* Unlock the mutex. */
+	if (pthread_mutex_unlock((pthread_mutex_t *) arg) != 0) {
 		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
 	}
 }
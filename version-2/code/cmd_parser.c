@@ -0,0 +1,1692 @@
+/**************************************************************************
+ *
+ * Author:
+ * 					Ashkan Moatamed
+ *
+ *
+ *
+ * cmd_parser.c
+ *
+ *
+ *
+ * Implementation of the command processing
+ * functions defined in alarm_app.h
+ *
+ *************************************************************************/
+
+/* Declare variables and function prototypes specified in alarm_app.h */
+#include "alarm_app.h"
+
+/*
+ * Process the command stored in line(of length len) on behalf of the
+ * thread with the given name(thread_name) and ID. The command may start
+ * with an optional "Request(ID) " prefix which is stripped before the
+ * command is inserted(see insert_cmd). A completion record is emitted
+ * for the request of every command with such a prefix: right away if
+ * the command is not accepted, or else by the command handler thread
+ * once it has applied the command. The records are printed to app_log
+ * for the main thread(client == 0) or else sent to the command server's
+ * client whose connection number is client.
+ *
+ * Preconditions:
+ * 		1. line != NULL
+ * 		2. strlen(line) == len
+ * 		3. thread_name != NULL
+ *
+ * Returns: The result of insert_cmd or CMD_INVALID if the prefix is invalid
+ */
+CResult process_cmd(const char *line, const size_t len, const char *thread_name,
+			const uint_fast64_t id, const uint_fast64_t client, MLData *data_ptr) {
+
+	/* The request that the command is submitted with. */
+	CmdRequest req;
+	/* Used for safely reading the request ID as a uint_fast32_t number. */
+	int_fast64_t l_req_id = 0;
+	/*
+	 * The expected prefix which is rebuilt from the read request ID.
+	 * It has maximum length CMD_REQUEST_PREFIX_MAX_LEN + 1 since it has
+	 * to be able to store that many chars and 1 nullchar('\0').
+	 */
+	char prefix[CMD_REQUEST_PREFIX_MAX_LEN + 1];
+	/* The length of the prefix(0 if there is none). */
+	size_t prefix_len = 0;
+
+	/* The result of processing the command. */
+	CResult result = CMD_INVALID;
+
+
+
+	/* Initialize the request and record its submission time. */
+	req.req_id = 0;
+	req.client = client;
+	req.submit_time = CMD_LATENCY_NOW();
+
+	if (sscanf(line, "Request(%" SCNdFAST64 ") ", &l_req_id) == 1) {
+		/* Parse l_req_id as a uint_fast32_t number. */
+		errno = 0;
+		req.req_id = f64_to_uf32(l_req_id);
+		if ((errno != 0) || (req.req_id == 0)) {
+			/* l_req_id is not a valid positive uint_fast32_t number. */
+			fprintf(stderr, "The given request ID is invalid since it is 0 or not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/*
+		 * Make sure line starts with exactly the rebuilt prefix
+		 * which rules out whitespace and redundant zeros.
+		 */
+		prefix_len = (size_t) sprintf(prefix, "Request(%" PRIuFAST32 ") ", req.req_id);
+		if ((len < prefix_len) || (strncmp(line, prefix, prefix_len) != 0)) {
+			fprintf(stderr, "The given request ID prefix is invalid since it does not conform to the specified format.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+	}
+
+
+
+	/* Insert the rest of the command and complete the request if it is not pending. */
+	result = insert_cmd(line + prefix_len, len - prefix_len, thread_name, id, &req, data_ptr);
+	if (result == CMD_INVALID) {
+		complete_cmd_request(&req, CMD_DONE_INVALID, data_ptr);
+	} else if (result == CMD_IGNORED) {
+		complete_cmd_request(&req, CMD_DONE_IGNORED, data_ptr);
+	} else if (result == CMD_REJECTED) {
+		fprintf(stderr, "The given command is rejected since the commands list is full.\nCommand: |%s|\n", line);
+		complete_cmd_request(&req, CMD_DONE_REJECTED, data_ptr);
+	} /* (result == CMD_ACCEPTED) */
+
+	return result;
+}
+
+/*
+ * Emit the completion record of the given request(req) if it has
+ * a request ID, or else do nothing. data_ptr is used exactly as
+ * in insert_cmd.
+ *
+ * Precondition: req != NULL
+ */
+void complete_cmd_request(const CmdRequest *req, const CCompletion completion,
+			MLData *data_ptr) {
+
+	/* The name of each completion. */
+	const char * const completions[] = { "invalid", "applied", "ignored", "replaced", "rejected" };
+
+	/* The new completion record node. */
+	CmdDone *new_done = NULL;
+	/* Was the completion records list empty before the insertion? */
+	bool was_empty = false;
+	/* The completion time of the request. */
+	uint_fast64_t done_time = 0;
+
+	/* Stores the return status of functions. */
+	int status = 0;
+
+
+
+	if (req->req_id == 0) {
+		/* Only requests with a request ID are completed. */
+		return;
+	}
+	done_time = CMD_LATENCY_NOW();
+
+	if (req->client == 0) {
+		/* Print the completion record of the main thread's request. */
+		fprintf(app_log, "Request with ID = %" PRIuFAST32 " was completed as %s at %" PRIuFAST64 \
+					" after %" PRIuFAST64 " microseconds.\n", req->req_id,
+					completions[completion], now(), CMD_LATENCY(req->submit_time, done_time));
+		return;
+	}
+
+
+
+	/* Allocate memory for the new completion record node. */
+	new_done = MALLOC(CmdDone);
+	if (new_done == NULL) {
+		/* Cleanup main thread(or terminate process) and terminate. */
+		EXIT_CMD(data_ptr, ALLOC_DONE_ERR_MSG, ALLOC_DONE_ERR);
+	}
+
+	/* Initialize the new completion record node's attributes. */
+	new_done->link = NULL;
+	new_done->req = *req;
+	new_done->completion = completion;
+	new_done->done_time = done_time;
+
+	/* Lock cmd_done_mutex. */
+	status = pthread_mutex_lock(&cmd_done_mutex);
+	if (status != 0) {
+		/* Cleanup main thread(or terminate process) and terminate. */
+		EXIT_CMD(data_ptr, MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+
+	/*
+	 * Critical Section:
+	 * Insert the new completion record at the end of the global completion
+	 * records list in O(1) unless the command server has been terminated
+	 * in which case there is no one left to deliver it to the client.
+	 */
+	if (cmd_done_write_fd == -1) {
+		free(new_done);
+	} else { /* (cmd_done_write_fd != -1) */
+		was_empty = (cmd_done_list_head == NULL);
+		if (was_empty) {
+			cmd_done_list_head = new_done;
+		} else { /* (!was_empty) */
+			cmd_done_list_tail->link = new_done;
+		}
+		cmd_done_list_tail = new_done;
+
+		/*
+		 * Wake the command server up. Only the first record inserted into
+		 * an empty list needs to do so since the server empties the list
+		 * after it has read the pipe. A full pipe(EAGAIN) already has a
+		 * pending wakeup so the result of write is deliberately ignored.
+		 */
+		if (was_empty) {
+			status = (int) write(cmd_done_write_fd, "", 1);
+		}
+	}
+
+	/* Unlock cmd_done_mutex. */
+	status = pthread_mutex_unlock(&cmd_done_mutex);
+	if (status != 0) {
+		/* Cleanup main thread(or terminate process) and terminate. */
+		EXIT_CMD(data_ptr, MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+}
+
+/*
+ * Search every shard of the global alarms list(through its express lanes)
+ * while holding a reader lock on it, to determine if there is at least one
+ * alarm with a message number in [msg_num, msg_num_last] or not. Alarms are
+ * partitioned by their message types so any of the shards may store them.
+ * data_ptr is used exactly as in insert_cmd.
+ *
+ * Precondition: msg_num <= msg_num_last
+ *
+ * Returns: true if and only if such an alarm exists
+ */
+bool alarm_range_exists(const uint_fast32_t msg_num, const uint_fast32_t msg_num_last,
+			MLData *data_ptr) {
+
+	/* The current shard of the alarms list. */
+	AlarmShard *shard = NULL;
+	/* The first alarm of the shard which is not before the range. */
+	Alarm *curr_alarm = NULL;
+	/*
+	 * The last alarm in each lane of the shard with a smaller
+	 * message number than the first one in the range.
+	 */
+	Alarm *preds[ALARM_SKIP_LIST_LANES];
+
+
+
+	for (shard = alarm_shards; shard != alarm_shards + ALARM_SHARDS; ++shard) {
+		/* Obtain reader lock. */
+		obtain_alarm_read_lock(shard, data_ptr);
+
+		/*
+		 * Critical Section:
+		 * The shard is sorted by message numbers so skip all alarms
+		 * with a smaller message number than the first message number
+		 * in the range(through the express lanes). The first alarm that
+		 * is not skipped(if any) is the only one that can possibly be in
+		 * the range.
+		 */
+		find_alarm_preds(&(shard->alarm_list_head), shard->alarm_express_head, msg_num, preds);
+		curr_alarm = *alarm_lane(&(shard->alarm_list_head), shard->alarm_express_head, preds[0], 0);
+
+		/* Release reader lock. */
+		release_alarm_read_lock(shard, data_ptr);
+
+		if ((curr_alarm != NULL) && (curr_alarm->msg_num <= msg_num_last)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Search the type A commands which have not yet been applied, i.e.,
+ * the ones in the global commands list and the ones which have been
+ * taken by the command handler threads, for a command with the given
+ * message type if msg_type != 0 or else for a command with a message
+ * number in [msg_num, msg_num_last].
+ *
+ * Precondition: cmd_mutex is locked by the caller
+ *
+ * Returns: Pointer to the first such command or NULL if none exists
+ */
+const CmdA * find_pending_cmda(const uint_fast32_t msg_type,
+			const uint_fast32_t msg_num, const uint_fast32_t msg_num_last) {
+
+	/* The current list of type A commands. */
+	const CmdA *list_head = cmda_list_head;
+	/* Command type A pointer used for iterating over the lists. */
+	const CmdA *curr_cmda = NULL;
+	/* The index of the command handler thread whose list is searched next. */
+	size_t w = 0;
+
+
+
+	while (true) {
+		for (curr_cmda = list_head; curr_cmda != NULL; curr_cmda = curr_cmda->link) {
+			if ((msg_type != 0) ? (curr_cmda->msg_type == msg_type) :
+				((curr_cmda->msg_num >= msg_num) && (curr_cmda->msg_num <= msg_num_last))) {
+
+				return curr_cmda;
+			}
+		}
+
+		if (w == CMD_WORKERS) { return NULL; }
+		list_head = cmd_workers[w++].cmda_list_head;
+	}
+}
+
+/*
+ * Search the type A commands which have been taken by the command handler
+ * threads but not yet applied for a command with a message number in
+ * [msg_num, msg_num_last]. Unlike the ones which are still in the global
+ * commands list, these cannot be annihilated(see annihilate_pending_cmda).
+ *
+ * Precondition: cmd_mutex is locked by the caller
+ *
+ * Returns: Pointer to the first such command or NULL if none exists
+ */
+const CmdA * find_taken_cmda(const uint_fast32_t msg_num, const uint_fast32_t msg_num_last) {
+	/* Command type A pointer used for iterating over the lists. */
+	const CmdA *curr_cmda = NULL;
+	/* The index of the command handler thread whose list is searched. */
+	size_t w = 0;
+
+
+
+	for (w = 0; w < CMD_WORKERS; ++w) {
+		for (curr_cmda = cmd_workers[w].cmda_list_head; curr_cmda != NULL; curr_cmda = curr_cmda->link) {
+			if ((curr_cmda->msg_num >= msg_num) && (curr_cmda->msg_num <= msg_num_last)) {
+				return curr_cmda;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Search the type A commands which have not yet been applied exactly like
+ * find_pending_cmda, but only for the ones inserted before the command
+ * with the given sequence number(seq). A type C command is applied by the
+ * worker of the first message number of its first range and a type D
+ * command by the worker of its message type while type A commands are
+ * applied by the workers of their own message numbers, so they have to
+ * wait until such commands have been applied(see cmd_handler).
+ *
+ * Precondition: cmd_mutex is locked by the caller
+ *
+ * Returns: Pointer to the first such command or NULL if none exists
+ */
+const CmdA * find_prior_cmda(const uint_fast64_t seq, const uint_fast32_t msg_type,
+			const uint_fast32_t msg_num, const uint_fast32_t msg_num_last) {
+
+	/* The current list of type A commands. */
+	const CmdA *list_head = cmda_list_head;
+	/* Command type A pointer used for iterating over the lists. */
+	const CmdA *curr_cmda = NULL;
+	/* The index of the command handler thread whose list is searched next. */
+	size_t w = 0;
+
+
+
+	while (true) {
+		for (curr_cmda = list_head; curr_cmda != NULL; curr_cmda = curr_cmda->link) {
+			if ((curr_cmda->seq < seq) && ((msg_type != 0) ? (curr_cmda->msg_type == msg_type) :
+				((curr_cmda->msg_num >= msg_num) && (curr_cmda->msg_num <= msg_num_last)))) {
+
+				return curr_cmda;
+			}
+		}
+
+		if (w == CMD_WORKERS) { return NULL; }
+		list_head = cmd_workers[w++].cmda_list_head;
+	}
+}
+
+/*
+ * Remove the type A commands with a message number in [msg_num, msg_num_last]
+ * from the global commands list(the ones which have not yet been taken by
+ * their command handler threads) since a type C command of the range is
+ * going to cancel their alarms anyway. This saves inserting each of their
+ * alarms only to remove it again(along with a handshake with its alarm
+ * handler thread). Their requests are completed as replaced. data_ptr is
+ * used exactly as in insert_cmd.
+ *
+ * The type A commands which have already been taken by their command
+ * handler threads are left alone since they may be applied at any moment.
+ *
+ * Precondition: cmd_mutex is locked by the caller
+ *
+ * Returns: The number of removed type A commands
+ */
+uint_fast64_t annihilate_pending_cmda(const uint_fast32_t msg_num,
+			const uint_fast32_t msg_num_last, MLData *data_ptr) {
+
+	/* Stores the return value of the current method. */
+	uint_fast64_t result = 0;
+
+
+
+	/* Command type A pointers used for iterating over the commands list. */
+	CmdA *curr_cmda = NULL, *prev_cmda = NULL, *next_cmda = NULL;
+
+
+
+	for (curr_cmda = cmda_list_head; curr_cmda != NULL; curr_cmda = next_cmda) {
+		next_cmda = curr_cmda->link;
+
+		if ((curr_cmda->msg_num < msg_num) || (curr_cmda->msg_num > msg_num_last)) {
+			prev_cmda = curr_cmda;
+			continue;
+		}
+
+		/* Remove the command from the global commands list. */
+		if (prev_cmda == NULL) {
+			cmda_list_head = next_cmda;
+		} else { /* (prev_cmda != NULL) */
+			prev_cmda->link = next_cmda;
+		}
+		if (curr_cmda == cmda_list_tail) {
+			cmda_list_tail = prev_cmda;
+		}
+
+		/* Print status message informing the user of the internal state. */
+		fprintf(app_log, "Type A command with message type = %" PRIuFAST32 \
+					" and message number = %" PRIuFAST32 \
+					" has been annihilated in the commands list by a type C command at %" \
+					PRIuFAST64 ".\n", curr_cmda->msg_type, curr_cmda->msg_num, now());
+
+		/* The command is never going to be applied so complete its request right away. */
+		complete_cmd_request(&(curr_cmda->req), CMD_DONE_REPLACED, data_ptr);
+
+		/* Detach and free the element saved in curr_cmda. */
+		curr_cmda->link = NULL;
+		free(curr_cmda);
+		++result;
+	}
+	cmda_annihilated += result;
+	cmd_queue_depth -= result;
+
+	return result;
+}
+
+/*
+ * Wait(on cmd_queue_cond_var) until there is room for count new commands
+ * in the global commands list if CMD_QUEUE_POLICY is CMD_QUEUE_BLOCK, or
+ * else return right away. It also returns right away if count is larger
+ * than the capacity of the list since there is never going to be room for
+ * all of them(see admit_cmd). data_ptr is used exactly as in insert_cmd.
+ *
+ * Precondition: cmd_mutex is locked by the caller
+ */
+void wait_cmd_queue(const uint_fast64_t count, MLData *data_ptr) {
+	if ((CMD_QUEUE_POLICY != CMD_QUEUE_BLOCK) || (CMD_QUEUE_CAPACITY == 0) ||
+		(count > CMD_QUEUE_CAPACITY) || (cmd_queue_depth + count <= CMD_QUEUE_CAPACITY)) {
+		return;
+	}
+	++cmd_queue_blocked;
+
+	/*
+	 * The command server thread signals the command handler threads only
+	 * once per batch of commands(see notify_cmd_worker) so it signals them
+	 * before waiting, or else they may never take the commands that it has
+	 * already inserted.
+	 */
+	if (data_ptr == NULL) {
+		signal_cmd_workers();
+	}
+
+	while (cmd_queue_depth + count > CMD_QUEUE_CAPACITY) {
+		if (pthread_cond_wait(&cmd_queue_cond_var, &cmd_mutex) != 0) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, COND_VAR_WAIT_ERR_MSG, COND_VAR_WAIT_ERR);
+		}
+	} /* (cmd_queue_depth + count <= CMD_QUEUE_CAPACITY) */
+}
+
+/*
+ * Make room for count new commands in the global commands list according
+ * to CMD_QUEUE_POLICY and count them as waiting in it. The requests of the
+ * shed type A commands are completed as rejected. data_ptr is used exactly
+ * as in insert_cmd.
+ *
+ * Precondition: cmd_mutex is locked by the caller
+ *
+ * Returns: false if the new commands are rejected and true otherwise
+ */
+bool admit_cmd(const uint_fast64_t count, MLData *data_ptr) {
+	/* Command type A pointer used to shed the oldest type A command. */
+	CmdA *curr_cmda = NULL;
+
+
+
+	/*
+	 * Under CMD_QUEUE_BLOCK the room has already been waited for(see
+	 * wait_cmd_queue) so the new commands are only rejected if there
+	 * are more of them than the capacity of the list.
+	 */
+	while ((CMD_QUEUE_CAPACITY != 0) && (cmd_queue_depth + count > CMD_QUEUE_CAPACITY)) {
+
+		if ((CMD_QUEUE_POLICY != CMD_QUEUE_SHED) || (cmda_list_head == NULL)) {
+			++cmd_queue_rejected;
+			return false;
+		}
+
+		/* Remove the oldest type A command from the global commands list. */
+		curr_cmda = cmda_list_head;
+		cmda_list_head = cmda_list_head->link;
+		if (cmda_list_head == NULL) {
+			cmda_list_tail = NULL;
+		}
+		--cmd_queue_depth;
+		++cmd_queue_shed;
+
+		/* Print status message informing the user of the internal state. */
+		fprintf(app_log, "Type A command with message type = %" PRIuFAST32 \
+					" and message number = %" PRIuFAST32 \
+					" has been shed from the full commands list at %" \
+					PRIuFAST64 ".\n", curr_cmda->msg_type, curr_cmda->msg_num, now());
+
+		/* The command is never going to be applied so complete its request right away. */
+		complete_cmd_request(&(curr_cmda->req), CMD_DONE_REJECTED, data_ptr);
+
+		/* Detach and free the element saved in curr_cmda. */
+		curr_cmda->link = NULL;
+		free(curr_cmda);
+	}
+
+	cmd_queue_depth += count;
+	if (cmd_queue_depth > cmd_queue_peak) {
+		cmd_queue_peak = cmd_queue_depth;
+	}
+
+	return true;
+}
+
+/*
+ * Tell the command handler thread with the given index(worker) that
+ * a command which it applies has been inserted into the global commands
+ * list, by incrementing its pending counter and signalling its own
+ * new_cmd_insert_cond_var. data_ptr is used exactly as in insert_cmd.
+ *
+ * The command server thread(data_ptr == NULL) only increments the pending
+ * counter and signals the workers once it has processed all of the commands
+ * that it has received from a client(see signal_cmd_workers), so that each
+ * worker is woken up once per batch of commands instead of once per command.
+ *
+ * Precondition: worker < CMD_WORKERS
+ */
+void notify_cmd_worker(const size_t worker, MLData *data_ptr) {
+	/* Lock new_cmd_insert_mutex. */
+	if (pthread_mutex_lock(&new_cmd_insert_mutex) != 0) {
+		/* Cleanup main thread(or terminate process) and terminate. */
+		EXIT_CMD(data_ptr, MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+
+	/*
+	 * Every command handler thread waits on its own conditional variable
+	 * so only the given one is woken up and the rest keep sleeping.
+	 */
+	++(cmd_workers[worker].pending);
+	if (data_ptr != NULL) {
+		if (pthread_cond_signal(&(cmd_workers[worker].new_cmd_insert_cond_var)) != 0) {
+			/* Cleanup main thread and terminate. */
+			EXIT_CMD(data_ptr, COND_VAR_SIGNAL_ERR_MSG, COND_VAR_SIGNAL_ERR);
+		}
+	}
+
+	/* Unlock new_cmd_insert_mutex. */
+	if (pthread_mutex_unlock(&new_cmd_insert_mutex) != 0) {
+		/* Cleanup main thread(or terminate process) and terminate. */
+		EXIT_CMD(data_ptr, MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+}
+
+/*
+ * The only invocations of this function should be from the command server thread.
+ *
+ * Signal the new_cmd_insert_cond_var of every command handler thread(worker)
+ * which has pending commands. Signalling a worker which is not waiting has
+ * no effect while its pending commands are applied in its current batch.
+ */
+void signal_cmd_workers(void) {
+	/* The index of the current command handler thread. */
+	size_t w = 0;
+
+
+
+	/* Lock new_cmd_insert_mutex. */
+	if (pthread_mutex_lock(&new_cmd_insert_mutex) != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+
+	for (w = 0; w < CMD_WORKERS; ++w) {
+		if (cmd_workers[w].pending != 0) {
+			if (pthread_cond_signal(&(cmd_workers[w].new_cmd_insert_cond_var)) != 0) {
+				EXIT_ERR(COND_VAR_SIGNAL_ERR_MSG, COND_VAR_SIGNAL_ERR);
+			}
+		}
+	}
+
+	/* Unlock new_cmd_insert_mutex. */
+	if (pthread_mutex_unlock(&new_cmd_insert_mutex) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+}
+
+/*
+ * Parse and validate the command stored in line(of length len) and then
+ * insert it into the global commands list on behalf of the thread with
+ * the given name(thread_name) and ID. Status messages are printed for the
+ * user exactly as if the command had been entered at the prompt. The
+ * given request(req) is attached to the inserted command so that the
+ * command handler thread can complete it.
+ *
+ * The main thread passes its local data(data_ptr) so that it is cleaned
+ * up on fatal errors while every other caller passes NULL in which case
+ * the process is terminated instead.
+ *
+ * Preconditions:
+ * 		1. line != NULL
+ * 		2. strlen(line) == len
+ * 		3. thread_name != NULL
+ * 		4. req != NULL
+ *
+ * Returns:
+ * 		1. CMD_INVALID
+ * 									if the command does not conform
+ * 									to any of the specified formats
+ * 		2. CMD_ACCEPTED
+ * 									if the command(or at least one
+ * 									of its ranges) has been inserted
+ * 									into the global commands list
+ * 		3. CMD_IGNORED
+ * 									if the command is valid but it
+ * 									would have no effect
+ * 		4. CMD_REJECTED
+ * 									if the command is valid but the
+ * 									global commands list is full(see
+ * 									CMD_QUEUE_POLICY)
+ */
+CResult insert_cmd(const char *line, const size_t len, const char *thread_name,
+			const uint_fast64_t id, const CmdRequest *req, MLData *data_ptr) {
+
+	/* Temporary variables used to parse commands. */
+	char *tmp_str = NULL;
+	size_t i = 0, msg_start = 0, msg_end = 0, msg_max_end = 0;
+
+
+
+	/*
+	 * Has the user been informed of the internal state or not?
+	 *
+	 * This flag is used in processing commands to determine whether
+	 * a status message has been printed informing the user of the
+	 * internal state or not.
+	 */
+	bool is_user_informed = false;
+	/*
+	 * Is there at least one alarm in the global alarms list(or in the type
+	 * A commands list waiting to be added to the alarms list) of the given
+	 * message type or with the given message number?
+	 *
+	 * This flag is used in processing type B and C commands to determine
+	 * whether at least one alarm of the given message type or with the
+	 * given message number has been found or not.
+	 */
+	bool alarm_exists = false;
+
+	/*
+	 * Command type A pointers used for iterating over the type A
+	 * commands list and also to store new type A commands which
+	 * are created by the user.
+	 */
+	CmdA *curr_cmda = NULL, *new_cmda = NULL;
+	/*
+	 * Pointer to a type A command which has not yet been applied
+	 * (see find_pending_cmda) of the given message type.
+	 */
+	const CmdA *pending_cmda = NULL;
+	/* The index of the command handler thread which applies the new command. */
+	size_t worker = 0;
+	/* The shard of the alarms list which stores alarms of the given message type. */
+	AlarmShard *shard = NULL;
+	/* Alarm pointer used for iterating over the shard. */
+	Alarm *curr_alarm = NULL;
+	/*
+	 * Command type B pointers used for iterating over the type B
+	 * commands list and also to store new type B commands which
+	 * are created by the user.
+	 */
+	CmdB *curr_cmdb = NULL, *new_cmdb = NULL;
+	/*
+	 * Command type C pointers used for iterating over the type C
+	 * commands list and also to store new type C commands which
+	 * are created by the user.
+	 */
+	CmdC *curr_cmdc = NULL, *new_cmdc = NULL;
+	/*
+	 * Command type C lists used to separate the ranges of a new type C
+	 * command into those with at least one alarm(or type A command) in
+	 * the range and those without any.
+	 */
+	CmdC *found_cmdc_head = NULL, *found_cmdc_tail = NULL;
+	CmdC *missing_cmdc_head = NULL, *missing_cmdc_tail = NULL;
+	/*
+	 * Command type C list used to collect the found ranges of a new type
+	 * C command which are not contained in the range of a type C command
+	 * in the global commands list, along with their number, so that they
+	 * are either all inserted into the global commands list or rejected.
+	 */
+	CmdC *new_cmdc_head = NULL, *new_cmdc_tail = NULL;
+	uint_fast64_t new_ranges = 0;
+	/*
+	 * Command type C list used to collect the ranges of a new type C
+	 * command which are applied by annihilating type A commands(see
+	 * annihilate_pending_cmda) without being inserted, i.e., the ones
+	 * contained in the range of a type C command in the global commands
+	 * list and the ones whose type A commands are all still in it.
+	 */
+	CmdC *redundant_cmdc_head = NULL, *redundant_cmdc_tail = NULL;
+	/* The number of ranges of a new type C command. */
+	uint_fast64_t ranges = 0;
+	/* The number of type A commands which have been annihilated by a new type C command. */
+	uint_fast64_t annihilated = 0;
+	/*
+	 * Command type D pointers used for iterating over the type D
+	 * commands list and also to store new type D commands which
+	 * are created by the user.
+	 */
+	CmdD *curr_cmdd = NULL, *new_cmdd = NULL;
+
+	/* The read wait time in the new command. */
+	uint_fast32_t wait_time = 0;
+	/* Used for safely reading wait_time as a uint_fast32_t number. */
+	int_fast64_t l_wait_time = 0;
+	/* The read message type in the new command. */
+	uint_fast32_t msg_type = 0;
+	/* Used for safely reading msg_type as a uint_fast32_t number. */
+	int_fast64_t l_msg_type = 0;
+	/* The read message number in the new command. */
+	uint_fast32_t msg_num = 0;
+	/* Used for safely reading msg_num as a uint_fast32_t number. */
+	int_fast64_t l_msg_num = 0;
+	/*
+	 * msg has maximum length MAX_MSG_LEN + 1 since it has to be
+	 * able to store MAX_MSG_LEN many chars and 1 nullchar('\0').
+	 */
+	char msg[MAX_MSG_LEN + 1];
+
+
+
+	/* Stores the return status of functions. */
+	int status = 0;
+
+	/* The result of processing the command. */
+	CResult result = CMD_IGNORED;
+
+
+
+	if (len < 2) {
+		/*
+		 * Input line has length 0 or 1 which means that
+		 * it cannot possibly be a valid command.
+		 */
+		fprintf(stderr, "The read command is invalid since its length is less than 2.\nCommand: |%s|\n", line);
+		return CMD_INVALID;
+	}
+
+
+
+	if (sscanf(line, "%" SCNdFAST64 " Message(%" SCNdFAST64 ", %" SCNdFAST64 ") ", &l_wait_time, &l_msg_type, &l_msg_num) == 3) {
+		/* Type A */
+
+		/* Parse l_wait_time as a uint_fast32_t number. */
+		errno = 0;
+		wait_time = f64_to_uf32(l_wait_time);
+		if (errno != 0) {
+			/* l_wait_time is not a valid uint_fast32_t number. */
+			fprintf(stderr, "The given type A command is invalid since the given Time is not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (wait_time == 0) {
+			/* wait_time should be positive. */
+			fprintf(stderr, "The given type A command is invalid since the given Time is 0.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/* Parse l_msg_type as a uint_fast32_t number. */
+		errno = 0;
+		msg_type = f64_to_uf32(l_msg_type);
+		if (errno != 0) {
+			/* l_msg_type is not a valid uint_fast32_t number. */
+			fprintf(stderr, "The given type A command is invalid since the given Type is not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (msg_type == 0) {
+			/* msg_type should be positive. */
+			fprintf(stderr, "The given type A command is invalid since the given Type is 0.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/* Parse l_msg_num as a uint_fast32_t number. */
+		errno = 0;
+		msg_num = f64_to_uf32(l_msg_num);
+		if (errno != 0) {
+			/* l_msg_num is not a valid uint_fast32_t number. */
+			fprintf(stderr, "The given type A command is invalid since the given Number is not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (msg_num == 0) {
+			/* msg_num should be positive. */
+			fprintf(stderr, "The given type A command is invalid since the given Number is 0.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+
+
+		/* Allocate and fill tmp_str. */
+		tmp_str = MALLOC_ARRAY(char, len);
+		if (tmp_str == NULL) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, ALLOC_STR_ERR_MSG, ALLOC_STR_ERR);
+		}
+		sprintf(tmp_str, "%" PRIuFAST32 " Message(%" PRIuFAST32 ", %" PRIuFAST32 ") ", wait_time, msg_type, msg_num);
+
+		/*
+		 * Find msg from line using tmp_str's length.
+		 *
+		 * msg's 1st index == tmp_str's last index + 1
+		 * == (strlen(tmp_str) - 1) + 1 == strlen(tmp_str)
+		 */
+		msg_start = strlen(tmp_str);
+		/*
+		 * msg ends either MAX_MSG_LEN many more chars after it starts
+		 * or it ends where the line ends which happens when the line
+		 * is shorter thus eliminating the need for truncation.
+		 *
+		 * Truncation is done by taking the minimum of the two possible
+		 * lengths for msg and ignoring the rest of the chars in line.
+		 */
+		msg_max_end = msg_start + MAX_MSG_LEN;
+		msg_end = MIN(msg_max_end, len);
+
+		/* Copy the alarm message from line into msg. */
+		for (i = msg_start; i != msg_end; ++i) {
+			msg[i - msg_start] = line[i];
+		}
+		msg[msg_end - msg_start] = '\0'; /* Null terminate msg. */
+
+		/* Make sure the alarm message is non-empty. */
+		if (msg_start == msg_end) {
+			free(tmp_str); /* Free memory allocated to tmp_str. */
+			fprintf(stderr, "The given AlarmMessage is the empty string.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/*
+		 * Validate the command type.
+		 *
+		 * Make sure line and tmp_str match in the first
+		 * msg_start == strlen(tmp_str) many chars.
+		 */
+		status = 1; /* Assume its validity. */
+		for (i = 0; i != msg_start; ++i) {
+			if (line[i] != tmp_str[i]) {
+				status = 0; /* Not valid. */
+				break;
+			}
+		}
+		free(tmp_str); /* Free memory allocated to tmp_str. */
+		if (status == 0) {
+			/*
+			 * Command is invalid since line does not start with the same
+			 * string as tmp_str. This happens in one of the following situations:
+			 *
+			 * 1. line has additional or not enough whitespace
+			 * 2. line has redundant zeros
+			 * 3. line contains an empty AlarmMessage
+			 * 4. line contains at least one number that does not fit into int_fast64_t
+			 *
+			 * All of the above issues occur in the first msg_start( == strlen(tmp_str))
+			 * many chars of line. The reason why these are not checked earlier is that
+			 * the scanf family of functions including sscanf, ignore whitespace,
+			 * redundant zeros, and numbers too long for a given format which is why we
+			 * enforce it manually.
+			 */
+			fprintf(stderr, "The given type A command is invalid since it differs from the specified format before the first character of the AlarmMessage.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+
+
+		/*
+		 * A valid type A command is accepted since it is either
+		 * inserted as a new command or replaces another one, unless
+		 * the global commands list is full(see CMD_QUEUE_POLICY).
+		 */
+		result = CMD_ACCEPTED;
+
+		/*
+		 * Search the global alarms list to determine if the new
+		 * alarm is going to replace an existing alarm or not. The
+		 * existing alarm may be of any message type.
+		 */
+		if (alarm_range_exists(msg_num, msg_num, data_ptr)) {
+			/* Print status message informing the user of the internal state. */
+			fprintf(app_log, "An alarm with message number = %" PRIuFAST32 \
+						" already exists in the alarms list which will be replaced.\n", msg_num);
+
+			/* Set the user informed flag. */
+			is_user_informed = true;
+		}
+
+
+
+		/* Lock cmd_mutex. */
+		status = pthread_mutex_lock(&cmd_mutex);
+		if (status != 0) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+		wait_cmd_queue(1, data_ptr);
+
+		/*
+		 * Critical Section:
+		 * Read the global commands list to determine if the
+		 * new type A command specifies a new alarm that is
+		 * going to replace an existing alarm or not.
+		 */
+		for (curr_cmda = cmda_list_head; curr_cmda != NULL; curr_cmda = curr_cmda->link) {
+			if (curr_cmda->msg_num == msg_num) {
+				if (!is_user_informed) {
+					/* Print status message informing the user of the internal state. */
+					fprintf(app_log, "A type A command with message number = %" PRIuFAST32 \
+								" already exists in the commands list which will be replaced.\n", msg_num);
+
+					/* Set the user informed flag. */
+					is_user_informed = true;
+				}
+
+				/*
+				 * Replace the type A command. When type A commands are
+				 * taken by their command handler thread, they are
+				 * immediately removed from the commands list(see
+				 * cmd_handler). Therefore, if we have found
+				 * a command in the list with the same message number, it
+				 * means that it has not yet been processed but it is going
+				 * to be replaced by the new command. Therefore, we can just
+				 * replace the command pointed to be curr_cmda with the new
+				 * command to arrive at the same spot that we would have
+				 * otherwise arrived.
+				 */
+				curr_cmda->wait_time = wait_time;
+				curr_cmda->msg_type = msg_type;
+				strcpy(curr_cmda->msg, msg); /* Set curr_cmda's message. */
+
+				/*
+				 * The replaced command's request is never going to be
+				 * applied so complete it right away and take it over.
+				 */
+				complete_cmd_request(&(curr_cmda->req), CMD_DONE_REPLACED, data_ptr);
+				curr_cmda->req = *req;
+				curr_cmda->seq = ++cmd_seq;
+				cmda_seq_last = cmd_seq;
+				++cmda_coalesced;
+
+				/* Terminate the searching for loop. */
+				break;
+			}
+		}
+
+		if ((curr_cmda == NULL) && (!admit_cmd(1, data_ptr))) {
+			/* There is no room for the new command in the global commands list. */
+			result = CMD_REJECTED;
+		} else if (curr_cmda == NULL) {
+			/*
+			 * The only way that curr_cmda can be NULL at this
+			 * point is if the commands list was empty or the if
+			 * condition in the above loop(checking message numbers)
+			 * always evaluated to false which implies that the new
+			 * command is indeed a new command to be added to the list.
+			 */
+
+			/* Allocate memory for the new command A node. */
+			new_cmda = MALLOC(CmdA);
+			if (new_cmda == NULL) {
+				/* Cleanup main thread(or terminate process) and terminate. */
+				EXIT_CMD(data_ptr, ALLOC_CMDA_ERR_MSG, ALLOC_CMDA_ERR);
+			}
+
+			/* Initialize the new command A node's attributes. */
+			new_cmda->link = NULL;
+			new_cmda->wait_time = wait_time;
+			new_cmda->msg_type = msg_type;
+			new_cmda->msg_num = msg_num;
+			strcpy(new_cmda->msg, msg); /* Set new_cmda's message. */
+			new_cmda->req = *req;
+			new_cmda->worker = CMD_WORKER(msg_num);
+			new_cmda->seq = ++cmd_seq;
+			cmda_seq_last = cmd_seq;
+
+			/* Insert the new type A command at the end of the global commands list in O(1). */
+			if (cmda_list_head == NULL) {
+				cmda_list_head = new_cmda;
+			} else { /* (cmda_list_head != NULL) */
+				cmda_list_tail->link = new_cmda;
+			}
+			cmda_list_tail = new_cmda;
+
+			/* Print status message informing the user of the internal state. */
+			if (!is_user_informed) {
+				fprintf(app_log, "New type A command with message type = %" PRIuFAST32 \
+							" and message number = %" PRIuFAST32 " inserted by %s thread with ID = %" \
+							PRIuFAST64 " into the commands list at %" PRIuFAST64 ".\n", msg_type, msg_num, thread_name, id, now());
+			}
+		}
+
+		/* Unlock cmd_mutex. */
+		status = pthread_mutex_unlock(&cmd_mutex);
+		if (status != 0) {
+			/*
+			 * We do not need to free memory allocated to new_cmda if
+			 * it was allocated in the above. The reason is that it has
+			 * been successfully inserted into the global commands list
+			 * if it was indeed allocated and thus it will be freed by
+			 * the main cleanup.
+			 */
+
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+
+		/* Notify the command handler thread of the new type A command insertion. */
+		if (result == CMD_ACCEPTED) {
+			notify_cmd_worker(CMD_WORKER(msg_num), data_ptr);
+		}
+	} else if (sscanf(line, "Create_Thread: MessageType(%" SCNdFAST64 ")", &l_msg_type) == 1) {
+		/* Type B */
+
+		/* Parse l_msg_type as a uint_fast32_t number. */
+		errno = 0;
+		msg_type = f64_to_uf32(l_msg_type);
+		if (errno != 0) {
+			/* l_msg_type is not a valid uint_fast32_t number. */
+			fprintf(stderr, "The given type B command is invalid since the given Type is not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (msg_type == 0) {
+			/* msg_type should be positive. */
+			fprintf(stderr, "The given type B command is invalid since the given Type is 0.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/* Validate the command. */
+		status = is_valid_cmd(line, len, 'B', msg_type);
+		if (status == -1) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, ALLOC_STR_ERR_MSG, ALLOC_STR_ERR);
+		} else if (status == 0) {
+			fprintf(stderr, "The given type B command is invalid since it does not conform to the specified format.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+
+
+		/* Obtain reader lock on the shard which stores the alarms of the given message type. */
+		shard = ALARM_SHARD(msg_type);
+		obtain_alarm_read_lock(shard, data_ptr);
+
+		/*
+		 * Critical Section:
+		 * Read the shard of the global alarms list to determine if
+		 * there is at least one alarm of the given message type or not.
+		 */
+		for (curr_alarm = shard->alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+			if (curr_alarm->msg_type == msg_type) {
+				/* Set the alarm exists flag. */
+				alarm_exists = true;
+
+				/* Terminate the searching for loop. */
+				break;
+			}
+		}
+
+		/* Release reader lock. */
+		release_alarm_read_lock(shard, data_ptr);
+
+
+
+		/* Lock cmd_mutex. */
+		status = pthread_mutex_lock(&cmd_mutex);
+		if (status != 0) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+		wait_cmd_queue(1, data_ptr);
+
+		/*
+		 * The command handler threads first process type A
+		 * commands. This means that even if there are no alarms
+		 * in the global alarms list of the given message type
+		 * right now, there may be some in the list after the type
+		 * A commands are processed and the alarms list has been
+		 * repopulated by the command handler threads.
+		 *
+		 * In that case, the new command is applied by the command
+		 * handler thread of the type A command instead, so that it
+		 * is applied after the new alarm has been inserted.
+		 */
+		worker = CMD_WORKER(msg_type);
+		if (!alarm_exists) {
+			/*
+			 * Critical Section Part 1:
+			 * Read the type A commands which have not yet been applied
+			 * to determine if there is at least one type A command of
+			 * the given message type or not.
+			 */
+			pending_cmda = find_pending_cmda(msg_type, 0, 0);
+			if (pending_cmda != NULL) {
+				/* Set the alarm exists flag. */
+				alarm_exists = true;
+				worker = pending_cmda->worker;
+			}
+		}
+
+		if (alarm_exists) {
+			/*
+			 * Critical Section Part 2:
+			 * Read the global commands list to determine if there is
+			 * at least one type B command of the given message type
+			 * or not.
+			 */
+			for (curr_cmdb = cmdb_list_head; curr_cmdb != NULL; curr_cmdb = curr_cmdb->link) {
+				if (curr_cmdb->msg_type == msg_type) {
+					/* Print status message informing the user of the internal state. */
+					if (curr_cmdb->is_processed) {
+						printf("The given type B command requests a new Alarm thread with message type = %" \
+									PRIuFAST32 " but there is already one such thread with ID = %" PRIuFAST64 \
+									".\n", msg_type, (uint_fast64_t) curr_cmdb->id);
+					} else { /* (!curr_cmdb->is_processed) */
+						printf("The given type B command requests a new Alarm thread with message type = %" \
+									PRIuFAST32 " but there is already one such request in the commands list.\n",
+									msg_type);
+					}
+
+					/* Terminate the searching for loop. */
+					break;
+				}
+			}
+
+			if ((curr_cmdb == NULL) && (!admit_cmd(1, data_ptr))) {
+				/* There is no room for the new command in the global commands list. */
+				result = CMD_REJECTED;
+			} else if (curr_cmdb == NULL) {
+				/*
+				 * The only way that curr_cmdb can be NULL at this
+				 * point is if the commands list was empty or the if
+				 * condition in the above loop(checking message types)
+				 * always evaluated to false which implies that the new
+				 * command is indeed a new command to be added to the list.
+				 */
+
+				/* Allocate memory for the new command B node. */
+				new_cmdb = MALLOC(CmdB);
+				if (new_cmdb == NULL) {
+					/* Cleanup main thread(or terminate process) and terminate. */
+					EXIT_CMD(data_ptr, ALLOC_CMDB_ERR_MSG, ALLOC_CMDB_ERR);
+				}
+
+				/* Initialize the new command B node's attributes. */
+				new_cmdb->link = NULL;
+				new_cmdb->msg_type = msg_type;
+				/* id will be initialized by the command handler thread. */
+				new_cmdb->is_processed = false;
+				new_cmdb->alarm_count = 0;
+				new_cmdb->detach_requests = 0;
+				new_cmdb->fired_records = 0;
+				new_cmdb->fired_writes = 0;
+				new_cmdb->detach_waiters = 0;
+				new_cmdb->inbox_head = NULL;
+				new_cmdb->shard_link = NULL;
+				new_cmdb->next_handler = NULL;
+				if (open_alarm_wakeup(new_cmdb) != 0) {
+					free(new_cmdb);
+					/* Cleanup main thread(or terminate process) and terminate. */
+					EXIT_CMD(data_ptr, WAKEUP_FD_ERR_MSG, WAKEUP_FD_ERR);
+				}
+				new_cmdb->req = *req;
+				new_cmdb->worker = worker;
+
+				result = CMD_ACCEPTED;
+
+				/* Insert the new type B command at the end of the global commands list in O(1). */
+				if (cmdb_list_head == NULL) {
+					cmdb_list_head = new_cmdb;
+				} else { /* (cmdb_list_head != NULL) */
+					cmdb_list_tail->link = new_cmdb;
+				}
+				cmdb_list_tail = new_cmdb;
+				/* Update type B commands list new element pointer. */
+				if (cmdb_list_new_elm == NULL) {
+					cmdb_list_new_elm = cmdb_list_tail;
+				}
+
+				/* Print status message informing the user of the internal state. */
+				fprintf(app_log, "New type B command with message type = %" PRIuFAST32 \
+							" inserted by %s thread with ID = %" PRIuFAST64 \
+							" into the commands list at %" PRIuFAST64 ".\n", msg_type, thread_name, id, now());
+			}
+		} else { /* (!alarm_exists) */
+			/*
+			 * At this point we know that there are no alarms
+			 * in the global alarms list of the given message
+			 * type nor will there be as of now since we also
+			 * know that there are no type A commands of the
+			 * given message type.
+			 */
+			printf("The given type B command requests a new Alarm thread with message type = %" \
+						PRIuFAST32 " but there are no alarms of this type.\n", msg_type);
+		}
+
+		/* Unlock cmd_mutex. */
+		status = pthread_mutex_unlock(&cmd_mutex);
+		if (status != 0) {
+			/*
+			 * We do not need to free memory allocated to new_cmdb if
+			 * it was allocated in the above. The reason is that it has
+			 * been successfully inserted into the global commands list
+			 * if it was indeed allocated and thus it will be freed by
+			 * the main cleanup.
+			 */
+
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+
+		/* Notify the command handler thread of the new type B command insertion. */
+		if (result == CMD_ACCEPTED) {
+			notify_cmd_worker(worker, data_ptr);
+		}
+	} else if (sscanf(line, "Cancel: Message(%" SCNdFAST64, &l_msg_num) == 1) {
+		/* Type C */
+
+		/*
+		 * Parse and validate the command. A type C command may cancel
+		 * many ranges of message numbers at once so parse_cmdc_ranges
+		 * stores one new command C node per range in a new list pointed
+		 * to by new_cmdc.
+		 */
+		status = parse_cmdc_ranges(line, len, &new_cmdc);
+		if (status == -1) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, ALLOC_CMDC_ERR_MSG, ALLOC_CMDC_ERR);
+		} else if (status == 0) {
+			fprintf(stderr, "The given type C command is invalid since it does not conform to the specified format.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (status == 2) {
+			fprintf(stderr, "The given type C command is invalid since one of the given Numbers is 0 or not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (status == 3) {
+			fprintf(stderr, "The given type C command is invalid since one of the given ranges has a first Number larger than its last.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/*
+		 * We do not need to free memory allocated to the ranges list
+		 * pointed to by new_cmdc(or any of the lists that its nodes are
+		 * moved to in the following) if the main thread is terminated
+		 * below since the entire process is going to be terminated.
+		 */
+
+		/*
+		 * All of the ranges are applied by the command handler thread
+		 * of the first message number of the first range, so that they
+		 * are still applied in a single round.
+		 */
+		worker = CMD_WORKER(new_cmdc->msg_num);
+
+
+
+		/*
+		 * Read the global alarms list to determine, for each of the
+		 * given ranges, if there is at least one alarm with a message
+		 * number in the range or not. Ranges for which such an alarm
+		 * exists are moved to the found ranges list and the rest are
+		 * moved to the missing ranges list.
+		 */
+		while (new_cmdc != NULL) {
+			/* Detach the current first range of the new list. */
+			curr_cmdc = new_cmdc;
+			new_cmdc = new_cmdc->link;
+			curr_cmdc->link = NULL;
+
+			if (alarm_range_exists(curr_cmdc->msg_num, curr_cmdc->msg_num_last, data_ptr)) {
+				insert_last_cmdc(&found_cmdc_head, &found_cmdc_tail, curr_cmdc);
+			} else { /* (!alarm_range_exists(curr_cmdc->msg_num, curr_cmdc->msg_num_last, data_ptr)) */
+				insert_last_cmdc(&missing_cmdc_head, &missing_cmdc_tail, curr_cmdc);
+			}
+			++ranges;
+		}
+
+
+
+		/* Lock cmd_mutex. */
+		status = pthread_mutex_lock(&cmd_mutex);
+		if (status != 0) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+
+		/*
+		 * Wait for room for every range since the number of ranges which
+		 * are actually inserted is only known once the global commands list
+		 * has been searched, while cmd_mutex must not be unlocked afterwards.
+		 */
+		wait_cmd_queue(ranges, data_ptr);
+
+		/*
+		 * The command handler threads first process type A
+		 * commands. This means that even if there are no alarms
+		 * in the global alarms list in a given range right now,
+		 * there may be some in the list after the type A commands
+		 * are processed and the alarms list has been repopulated
+		 * by the command handler threads.
+		 *
+		 * Nothing is modified until the new ranges have been admitted
+		 * into the global commands list, so that a rejected command has
+		 * no effect at all.
+		 *
+		 * Critical Section Part 1:
+		 * Read the type A commands which have not yet been applied to
+		 * determine, for each of the missing ranges, if there is at least
+		 * one type A command with a message number in the range or not and
+		 * if so, whether one of them has already been taken by a command
+		 * handler thread. A range whose type A commands are all still in the
+		 * global commands list is applied by annihilating them(see Part 3)
+		 * while the others are handled exactly like the found ranges.
+		 */
+		while (missing_cmdc_head != NULL) {
+			/* Detach the current first range of the missing ranges list. */
+			curr_cmdc = missing_cmdc_head;
+			missing_cmdc_head = missing_cmdc_head->link;
+			curr_cmdc->link = NULL;
+
+			if (find_taken_cmda(curr_cmdc->msg_num, curr_cmdc->msg_num_last) != NULL) {
+				insert_last_cmdc(&found_cmdc_head, &found_cmdc_tail, curr_cmdc);
+			} else if (find_pending_cmda(0, curr_cmdc->msg_num, curr_cmdc->msg_num_last) != NULL) {
+				/* (find_taken_cmda(curr_cmdc->msg_num, curr_cmdc->msg_num_last) == NULL) */
+				insert_last_cmdc(&redundant_cmdc_head, &redundant_cmdc_tail, curr_cmdc);
+			} else { /* (find_pending_cmda(0, curr_cmdc->msg_num, curr_cmdc->msg_num_last) == NULL) */
+				/*
+				 * At this point we know that there are no alarms
+				 * in the global alarms list in the given range nor
+				 * will there be as of now since we also know that
+				 * there are no type A commands in the given range.
+				 */
+				if (curr_cmdc->msg_num == curr_cmdc->msg_num_last) {
+					printf("The given type C command requests the cancellation of an alarm with message number = %" \
+								PRIuFAST32 " but there are no alarms with this message number.\n", curr_cmdc->msg_num);
+				} else { /* (curr_cmdc->msg_num != curr_cmdc->msg_num_last) */
+					printf("The given type C command requests the cancellation of all alarms with message numbers in [%" \
+								PRIuFAST32 ", %" PRIuFAST32 "] but there are no alarms with these message numbers.\n",
+								curr_cmdc->msg_num, curr_cmdc->msg_num_last);
+				}
+
+				/* Free the range saved in curr_cmdc. */
+				free(curr_cmdc);
+			}
+		}
+		missing_cmdc_tail = NULL;
+
+		/*
+		 * Critical Section Part 2:
+		 * Read the global commands list to determine, for each of the
+		 * found ranges, if there is already a type C command whose range
+		 * contains it or not. The contained ranges are redundant while
+		 * the new ones are then inserted into the global commands list as
+		 * long as there is room for all of them.
+		 */
+		while (found_cmdc_head != NULL) {
+			/* Detach the current first range of the found ranges list. */
+			new_cmdc = found_cmdc_head;
+			found_cmdc_head = found_cmdc_head->link;
+			new_cmdc->link = NULL;
+
+			for (curr_cmdc = cmdc_list_head; curr_cmdc != NULL; curr_cmdc = curr_cmdc->link) {
+				if ((curr_cmdc->msg_num <= new_cmdc->msg_num) &&
+					(curr_cmdc->msg_num_last >= new_cmdc->msg_num_last) &&
+					(curr_cmdc->seq > cmda_seq_last)) {
+
+					/* Print status message informing the user of the internal state. */
+					if (new_cmdc->msg_num == new_cmdc->msg_num_last) {
+						printf("The given type C command requests the cancellation of an alarm with message number = %" \
+									PRIuFAST32 " but there is already one such request in the commands list.\n", new_cmdc->msg_num);
+					} else { /* (new_cmdc->msg_num != new_cmdc->msg_num_last) */
+						printf("The given type C command requests the cancellation of all alarms with message numbers in [%" \
+									PRIuFAST32 ", %" PRIuFAST32 "] but there is already one such request in the commands list.\n",
+									new_cmdc->msg_num, new_cmdc->msg_num_last);
+					}
+
+					/* Terminate the searching for loop. */
+					break;
+				}
+			}
+
+			if (curr_cmdc == NULL) {
+				/*
+				 * The only way that curr_cmdc can be NULL at this
+				 * point is if the commands list was empty or the if
+				 * condition in the above loop(checking message numbers)
+				 * always evaluated to false which implies that the new
+				 * command is indeed a new command to be added to the list.
+				 */
+				insert_last_cmdc(&new_cmdc_head, &new_cmdc_tail, new_cmdc);
+				++new_ranges;
+			} else { /* (curr_cmdc != NULL) */
+				insert_last_cmdc(&redundant_cmdc_head, &redundant_cmdc_tail, new_cmdc);
+			}
+		}
+		found_cmdc_tail = NULL;
+
+		if ((new_ranges != 0) && (!admit_cmd(new_ranges, data_ptr))) {
+			/*
+			 * There is no room for the new ranges in the global commands
+			 * list so all of the ranges are freed before any type A command
+			 * has been annihilated.
+			 */
+			while (new_cmdc_head != NULL) {
+				new_cmdc = new_cmdc_head;
+				new_cmdc_head = new_cmdc_head->link;
+				free(new_cmdc);
+			}
+			new_cmdc_tail = NULL;
+			while (redundant_cmdc_head != NULL) {
+				new_cmdc = redundant_cmdc_head;
+				redundant_cmdc_head = redundant_cmdc_head->link;
+				free(new_cmdc);
+			}
+			redundant_cmdc_tail = NULL;
+			result = CMD_REJECTED;
+		}
+
+		/*
+		 * Critical Section Part 3:
+		 * Annihilate the type A commands of every admitted range which are
+		 * still in the global commands list, since the range(or the type C
+		 * command which contains it) is going to cancel their alarms anyway.
+		 * The redundant ranges have thereby been applied.
+		 */
+		while (redundant_cmdc_head != NULL) {
+			/* Detach the current first range of the redundant ranges list. */
+			new_cmdc = redundant_cmdc_head;
+			redundant_cmdc_head = redundant_cmdc_head->link;
+
+			annihilated += annihilate_pending_cmda(new_cmdc->msg_num, new_cmdc->msg_num_last, data_ptr);
+
+			/* Free the range saved in new_cmdc. */
+			free(new_cmdc);
+			++cmdc_coalesced;
+		}
+		redundant_cmdc_tail = NULL;
+		for (new_cmdc = new_cmdc_head; new_cmdc != NULL; new_cmdc = new_cmdc->link) {
+			annihilated += annihilate_pending_cmda(new_cmdc->msg_num, new_cmdc->msg_num_last, data_ptr);
+		}
+
+		while (new_cmdc_head != NULL) {
+			/* Detach the current first range of the new ranges list. */
+			new_cmdc = new_cmdc_head;
+			new_cmdc_head = new_cmdc_head->link;
+			new_cmdc->link = NULL;
+
+			/* Insert the new type C command at the end of the global commands list in O(1). */
+			new_cmdc->worker = worker;
+			new_cmdc->seq = ++cmd_seq;
+			insert_last_cmdc(&cmdc_list_head, &cmdc_list_tail, new_cmdc);
+			result = CMD_ACCEPTED;
+
+			/* Print status message informing the user of the internal state. */
+			if (new_cmdc->msg_num == new_cmdc->msg_num_last) {
+				fprintf(app_log, "New type C command with message number = %" PRIuFAST32 \
+							" inserted by %s thread with ID = %" PRIuFAST64 \
+							" into the commands list at %" PRIuFAST64 ".\n", new_cmdc->msg_num, thread_name, id, now());
+			} else { /* (new_cmdc->msg_num != new_cmdc->msg_num_last) */
+				fprintf(app_log, "New type C command with message numbers in [%" PRIuFAST32 ", %" PRIuFAST32 \
+							"] inserted by %s thread with ID = %" PRIuFAST64 \
+							" into the commands list at %" PRIuFAST64 ".\n",
+							new_cmdc->msg_num, new_cmdc->msg_num_last, thread_name, id, now());
+			}
+		}
+		new_cmdc_tail = NULL;
+		new_cmdc = NULL;
+
+		/*
+		 * All of the inserted ranges are applied in a single round in
+		 * the order of insertion so the request is attached to the last
+		 * one of them(if any) and is completed once it has been applied.
+		 * Otherwise, the command has already been applied if it has
+		 * annihilated at least one type A command.
+		 */
+		if (result == CMD_ACCEPTED) {
+			cmdc_list_tail->req = *req;
+		} else if ((result == CMD_IGNORED) && (annihilated != 0)) { /* (result != CMD_ACCEPTED) */
+			fprintf(app_log, "Type C command annihilated %" PRIuFAST64 \
+						" type A commands in the commands list so it has been applied by %s thread with ID = %" \
+						PRIuFAST64 " at %" PRIuFAST64 ".\n", annihilated, thread_name, id, now());
+			complete_cmd_request(req, CMD_DONE_APPLIED, data_ptr);
+		}
+
+		/* Unlock cmd_mutex. */
+		status = pthread_mutex_unlock(&cmd_mutex);
+		if (status != 0) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+
+		/*
+		 * Notify the command handler thread of the new type C command
+		 * insertion. All of the ranges are notified at once so that the
+		 * command handler thread can apply them in a single round.
+		 */
+		if (result == CMD_ACCEPTED) {
+			notify_cmd_worker(worker, data_ptr);
+		} else if ((result == CMD_IGNORED) && (annihilated != 0)) { /* (result != CMD_ACCEPTED) */
+			result = CMD_ACCEPTED;
+		}
+	} else if (sscanf(line, "Cancel: MessageType(%" SCNdFAST64 ")", &l_msg_type) == 1) {
+		/* Type D */
+
+		/* Parse l_msg_type as a uint_fast32_t number. */
+		errno = 0;
+		msg_type = f64_to_uf32(l_msg_type);
+		if (errno != 0) {
+			/* l_msg_type is not a valid uint_fast32_t number. */
+			fprintf(stderr, "The given type D command is invalid since the given Type is not a valid unsigned number.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		} else if (msg_type == 0) {
+			/* msg_type should be positive. */
+			fprintf(stderr, "The given type D command is invalid since the given Type is 0.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+		/* Validate the command. */
+		status = is_valid_cmd(line, len, 'D', msg_type);
+		if (status == -1) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, ALLOC_STR_ERR_MSG, ALLOC_STR_ERR);
+		} else if (status == 0) {
+			fprintf(stderr, "The given type D command is invalid since it does not conform to the specified format.\nCommand: |%s|\n", line);
+			return CMD_INVALID;
+		}
+
+
+
+		/* Obtain reader lock on the shard which stores the alarms of the given message type. */
+		shard = ALARM_SHARD(msg_type);
+		obtain_alarm_read_lock(shard, data_ptr);
+
+		/*
+		 * Critical Section:
+		 * Read the shard of the global alarms list to determine if
+		 * there is at least one alarm of the given message type or not.
+		 */
+		for (curr_alarm = shard->alarm_list_head; curr_alarm != NULL; curr_alarm = curr_alarm->link) {
+			if (curr_alarm->msg_type == msg_type) {
+				/* Set the alarm exists flag. */
+				alarm_exists = true;
+
+				/* Terminate the searching for loop. */
+				break;
+			}
+		}
+
+		/* Release reader lock. */
+		release_alarm_read_lock(shard, data_ptr);
+
+
+
+		/* Lock cmd_mutex. */
+		status = pthread_mutex_lock(&cmd_mutex);
+		if (status != 0) {
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+		}
+		wait_cmd_queue(1, data_ptr);
+
+		/*
+		 * The command handler threads first process type A
+		 * commands. This means that even if there are no alarms
+		 * in the global alarms list of the given message type
+		 * right now, there may be some in the list after the type
+		 * A commands are processed and the alarms list has been
+		 * repopulated by the command handler threads.
+		 *
+		 * In that case, the new command is applied by the command
+		 * handler thread of the type A command instead, so that it
+		 * is applied after the new alarm has been inserted.
+		 */
+		worker = CMD_WORKER(msg_type);
+		if (!alarm_exists) {
+			/*
+			 * Critical Section Part 1:
+			 * Read the type A commands which have not yet been applied
+			 * to determine if there is at least one type A command of
+			 * the given message type or not.
+			 */
+			pending_cmda = find_pending_cmda(msg_type, 0, 0);
+			if (pending_cmda != NULL) {
+				/* Set the alarm exists flag. */
+				alarm_exists = true;
+				worker = pending_cmda->worker;
+			}
+		}
+
+		if (alarm_exists) {
+			/*
+			 * Critical Section Part 2:
+			 * Read the global commands list to determine if there is
+			 * at least one type D command of the given message type
+			 * or not.
+			 */
+			for (curr_cmdd = cmdd_list_head; curr_cmdd != NULL; curr_cmdd = curr_cmdd->link) {
+				if (curr_cmdd->msg_type == msg_type) {
+					/* Print status message informing the user of the internal state. */
+					printf("The given type D command requests the cancellation of all alarms with message type = %" \
+								PRIuFAST32 " but there is already one such request in the commands list.\n", msg_type);
+
+					/*
+					 * The existing command now also has to cancel the alarms of
+					 * the type A commands inserted since then, which makes it
+					 * equivalent to the new command.
+					 */
+					curr_cmdd->seq = ++cmd_seq;
+
+					/* Terminate the searching for loop. */
+					break;
+				}
+			}
+
+			if ((curr_cmdd == NULL) && (!admit_cmd(1, data_ptr))) {
+				/* There is no room for the new command in the global commands list. */
+				result = CMD_REJECTED;
+			} else if (curr_cmdd == NULL) {
+				/*
+				 * The only way that curr_cmdd can be NULL at this
+				 * point is if the commands list was empty or the if
+				 * condition in the above loop(checking message types)
+				 * always evaluated to false which implies that the new
+				 * command is indeed a new command to be added to the list.
+				 */
+
+				/* Allocate memory for the new command D node. */
+				new_cmdd = MALLOC(CmdD);
+				if (new_cmdd == NULL) {
+					/* Cleanup main thread(or terminate process) and terminate. */
+					EXIT_CMD(data_ptr, ALLOC_CMDD_ERR_MSG, ALLOC_CMDD_ERR);
+				}
+
+				/* Initialize the new command D node's attributes. */
+				new_cmdd->link = NULL;
+				new_cmdd->msg_type = msg_type;
+				new_cmdd->req = *req;
+				new_cmdd->worker = worker;
+				new_cmdd->seq = ++cmd_seq;
+
+				result = CMD_ACCEPTED;
+
+				/* Insert the new type D command at the end of the global commands list in O(1). */
+				if (cmdd_list_head == NULL) {
+					cmdd_list_head = new_cmdd;
+				} else { /* (cmdd_list_head != NULL) */
+					cmdd_list_tail->link = new_cmdd;
+				}
+				cmdd_list_tail = new_cmdd;
+
+				/* Print status message informing the user of the internal state. */
+				fprintf(app_log, "New type D command with message type = %" PRIuFAST32 \
+							" inserted by %s thread with ID = %" PRIuFAST64 \
+							" into the commands list at %" PRIuFAST64 ".\n", msg_type, thread_name, id, now());
+			}
+		} else { /* (!alarm_exists) */
+			/*
+			 * At this point we know that there are no alarms
+			 * in the global alarms list of the given message
+			 * type nor will there be as of now since we also
+			 * know that there are no type A commands of the
+			 * given message type.
+			 */
+			printf("The given type D command requests the cancellation of all alarms with message type = %" \
+						PRIuFAST32 " but there are no alarms of this type.\n", msg_type);
+		}
+
+		/* Unlock cmd_mutex. */
+		status = pthread_mutex_unlock(&cmd_mutex);
+		if (status != 0) {
+			/*
+			 * We do not need to free memory allocated to new_cmdd if
+			 * it was allocated in the above. The reason is that it has
+			 * been successfully inserted into the global commands list
+			 * if it was indeed allocated and thus it will be freed by
+			 * the main cleanup.
+			 */
+
+			/* Cleanup main thread(or terminate process) and terminate. */
+			EXIT_CMD(data_ptr, MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+		}
+
+		/* Notify the command handler thread of the new type D command insertion. */
+		if (result == CMD_ACCEPTED) {
+			notify_cmd_worker(worker, data_ptr);
+		}
+	} else {
+		fprintf(stderr, "The read command is invalid since it does not conform to any of the specified formats.\nCommand: |%s|\n", line);
+		return CMD_INVALID;
+	}
+
+	return result;
+}
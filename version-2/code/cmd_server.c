@@ -0,0 +1,629 @@
+/**************************************************************************
+ *
+ * Author:
+ * 					Ashkan Moatamed
+ *
+ *
+ *
+ * cmd_server.c
+ *
+ *
+ *
+ * Implementation of the command server
+ * thread routines defined in alarm_app.h
+ *
+ *************************************************************************/
+
+/* Declare variables and function prototypes specified in alarm_app.h */
+#include "alarm_app.h"
+
+/*
+ * The command server thread routine.
+ *
+ * Precondition: arg can be safely casted into (char *) which
+ * points to the name of the socket that the server listens on.
+ *
+ * Returns: arg
+ */
+void * cmd_server(void *arg) {
+	/* Save the current thread(command server)'s ID. */
+	const uint_fast64_t id = (uint_fast64_t) pthread_self();
+
+
+
+	/* The resources which are released by the cleanup routine. */
+	CmdServer server;
+	/* Client pointer used for serving the clients. */
+	CmdClient *client = NULL;
+	/* The address of the listening socket. */
+	struct sockaddr_un addr;
+
+	/* The event used to register sockets and the events of each wakeup. */
+	struct epoll_event event;
+	struct epoll_event events[CMD_SERVER_MAX_EVENTS];
+	/* The number of events of the current wakeup and the current event. */
+	int event_count = 0, e = 0;
+	/* The events that the server was waiting for on the current client. */
+	uint32_t old_events = 0;
+	/* The newly accepted socket. */
+	int fd = -1;
+	/* The two ends of the completion pipe. */
+	int done_fds[2];
+	/* Have new completion records been inserted during the current wakeup? */
+	bool is_done_ready = false;
+	/* Used to empty the completion pipe. */
+	char done_buf[64];
+
+
+
+	/* Dummy variable used when setting the cancel state of this thread. */
+	int old_state = 0;
+
+
+
+	/*
+	 * Set up this thread's cleanup routines to be called
+	 * when it is cancelled by the main thread when it is
+	 * terminating.
+	 */
+	server.path = (const char *) arg;
+	server.listen_fd = -1; server.epoll_fd = -1; server.done_fd = -1;
+	server.conn_count = 0; server.client_list_head = NULL;
+	pthread_cleanup_push(cleanup_cmd_server, (void *) (&server));
+
+
+
+	/*
+	 * Disable cancellation since this thread is going to access the
+	 * global commands list(through process_cmd) and only enable it
+	 * while it is waiting for new events.
+	 */
+	if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+		EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+	}
+
+	/* Create the listening socket removing any stale socket of a previous run. */
+	server.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server.listen_fd == -1) {
+		EXIT_ERR(SOCKET_ERR_MSG, SOCKET_ERR);
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, server.path, sizeof(addr.sun_path) - 1);
+	unlink(server.path);
+	if ((bind(server.listen_fd, (struct sockaddr *) (&addr), sizeof(addr)) != 0) ||
+		(listen(server.listen_fd, SOMAXCONN) != 0) ||
+		(fcntl(server.listen_fd, F_SETFL, fcntl(server.listen_fd, F_GETFL) | O_NONBLOCK) != 0)) {
+
+		EXIT_ERR(SOCKET_ERR_MSG, SOCKET_ERR);
+	}
+
+	/*
+	 * Create the epoll instance and register the listening socket. Its
+	 * events are the only ones with a NULL data pointer while the events
+	 * of each client point to the client's node.
+	 */
+	server.epoll_fd = epoll_create1(0);
+	if (server.epoll_fd == -1) {
+		EXIT_ERR(EPOLL_ERR_MSG, EPOLL_ERR);
+	}
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	if (epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event) != 0) {
+		EXIT_ERR(EPOLL_ERR_MSG, EPOLL_ERR);
+	}
+
+	/*
+	 * Create the completion pipe and register its read end whose events
+	 * point to server.done_fd. Its write end is published(while holding
+	 * cmd_done_mutex) so that completion records can be delivered.
+	 */
+	if (pipe(done_fds) != 0) {
+		EXIT_ERR(PIPE_ERR_MSG, PIPE_ERR);
+	}
+	server.done_fd = done_fds[0];
+	if ((fcntl(done_fds[0], F_SETFL, fcntl(done_fds[0], F_GETFL) | O_NONBLOCK) != 0) ||
+		(fcntl(done_fds[1], F_SETFL, fcntl(done_fds[1], F_GETFL) | O_NONBLOCK) != 0)) {
+
+		close(done_fds[1]);
+		EXIT_ERR(PIPE_ERR_MSG, PIPE_ERR);
+	}
+	event.events = EPOLLIN;
+	event.data.ptr = (void *) (&server.done_fd);
+	if (epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.done_fd, &event) != 0) {
+		close(done_fds[1]);
+		EXIT_ERR(EPOLL_ERR_MSG, EPOLL_ERR);
+	}
+	if (pthread_mutex_lock(&cmd_done_mutex) != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+	cmd_done_write_fd = done_fds[1];
+	if (pthread_mutex_unlock(&cmd_done_mutex) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+
+	/* Print status message informing the user of the internal state. */
+	fprintf(app_log, "Command server thread with ID = %" PRIuFAST64 \
+				" is accepting commands on %s at %" PRIuFAST64 ".\n",
+				id, server.path, now());
+
+
+
+	/*
+	 * Infinite loop to wait for new clients and commands.
+	 *
+	 * Every client is served until it would block so that a single
+	 * thread can serve many clients at once. Each of their commands
+	 * is processed exactly like a command entered at the prompt and
+	 * is then acknowledged with one of the following lines:
+	 * 		1. "OK accepted"		if the command has been inserted
+	 * 		2. "OK ignored"		if the command would have no effect
+	 * 		3. "ERR invalid"		if the command is invalid
+	 *
+	 * Commands with a "Request(ID) " prefix are also completed later
+	 * (possibly after many more commands) with the following line:
+	 * 		"DONE ID Completion Latency"
+	 * where Completion is one of applied, replaced, ignored, or invalid
+	 * and Latency is the number of microseconds from the submission of
+	 * the command to its completion.
+	 */
+	while (true) {
+		/* Enable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
+		}
+
+		/* epoll_wait is a cancellation point. */
+		event_count = epoll_wait(server.epoll_fd, events, CMD_SERVER_MAX_EVENTS, -1);
+
+		/* Disable cancellation. */
+		if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) != 0) {
+			EXIT_ERR(CANCELLATION_DISABLE_ERR_MSG, CANCELLATION_DISABLE_ERR);
+		}
+
+		if (event_count == -1) {
+			if (errno == EINTR) { continue; }
+			EXIT_ERR(EPOLL_ERR_MSG, EPOLL_ERR);
+		}
+
+
+
+		is_done_ready = false;
+		for (e = 0; e < event_count; ++e) {
+			if (events[e].data.ptr == (void *) (&server.done_fd)) {
+				/*
+				 * Route the completion records after all other events since
+				 * serving the clients may free some of them while their
+				 * events are still in the events array.
+				 */
+				is_done_ready = true;
+				continue;
+			}
+
+			if (events[e].data.ptr == NULL) {
+				/* Accept all of the pending connections. */
+				while ((fd = accept(server.listen_fd, NULL, NULL)) != -1) {
+					if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+						EXIT_ERR(SOCKET_ERR_MSG, SOCKET_ERR);
+					}
+
+					/* Allocate memory for the new client node. */
+					client = MALLOC(CmdClient);
+					if (client == NULL) {
+						close(fd);
+						EXIT_ERR(ALLOC_CLIENT_ERR_MSG, ALLOC_CLIENT_ERR);
+					}
+
+					/* Initialize the new client node's attributes. */
+					client->fd = fd;
+					client->conn_num = ++(server.conn_count);
+					client->events = EPOLLIN;
+					client->is_closed = false;
+					client->in_size = 0;
+					client->out_size = 0;
+					client->done_list_head = NULL;
+					client->done_list_tail = NULL;
+
+					/* Insert the new client at the beginning of the clients list in O(1). */
+					client->link = server.client_list_head;
+					server.client_list_head = client;
+
+					event.events = client->events;
+					event.data.ptr = (void *) client;
+					if (epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+						EXIT_ERR(EPOLL_ERR_MSG, EPOLL_ERR);
+					}
+				}
+
+				if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+					(errno != EINTR) && (errno != ECONNABORTED)) {
+
+					EXIT_ERR(SOCKET_ERR_MSG, SOCKET_ERR);
+				}
+				continue;
+			}
+
+
+
+			/* Serve the client until it would block. */
+			client = (CmdClient *) events[e].data.ptr;
+			old_events = client->events;
+			serve_cmd_client(client, id);
+			update_cmd_client(&server, client, old_events);
+		}
+
+		/*
+		 * Wake up the command handler threads which have to apply the
+		 * commands processed for all of the ready clients only once they
+		 * have been served, so that each worker applies them in a single
+		 * batch and does not preempt this thread after each command.
+		 */
+		signal_cmd_workers();
+
+
+
+		if (is_done_ready) {
+			/*
+			 * Empty the completion pipe before taking the records so that
+			 * records inserted after they have been taken write to it again.
+			 */
+			while (read(server.done_fd, done_buf, sizeof(done_buf)) > 0) {
+				/* Do nothing. */
+			}
+			route_cmd_done(&server, id);
+		}
+	}
+
+
+
+	/*
+	 * POSIX.1 permits pthread_cleanup_push() and pthread_cleanup_pop()
+	 * to be implemented as macros that expand to text containing
+	 * '{' and '}', respectively. For this reason, the caller must ensure
+	 * that calls to these functions are paired within the same function,
+	 * and at the same lexical nesting level. In other words, a cleanup
+	 * handler is established only during the execution of a specified
+	 * section of code.
+	 *
+	 * Therefore, the following call is needed to pair the call to
+	 * pthread_cleanup_push made in the beginning of this thread's
+	 * execution.
+	 *
+	 * The pop is however placed in a section of code that will never be
+	 * reached since the command server thread is meant to be cancelled
+	 * by the main thread which is when the cleanup routines will be
+	 * actually popped and executed.
+	 */
+	pthread_cleanup_pop(1);
+
+
+
+	/* This return will never be reached. */
+	return arg;
+}
+
+/*
+ * Serve the given client of the command server thread with the
+ * given ID by sending its pending acknowledgements and processing
+ * its complete commands until it either has to wait for the client
+ * or the client has closed its connection.
+ *
+ * When it returns, client->events denotes the events that the command
+ * server should wait for on client->fd unless client->is_closed.
+ *
+ * Precondition: client != NULL
+ */
+void serve_cmd_client(CmdClient *client, const uint_fast64_t id) {
+	/* The acknowledgement of each result of processing a command. */
+	const char * const acks[] = { "ERR invalid\n", "OK accepted\n", "OK ignored\n", "ERR rejected\n" };
+	/* The length of the longest acknowledgement. */
+	const size_t max_ack_len = sizeof("ERR rejected\n") - 1;
+	/* The name of each completion. */
+	const char * const completions[] = { "invalid", "applied", "ignored", "replaced", "rejected" };
+	/* Completion record pointer used for iterating over the client's records. */
+	CmdDone *done = NULL;
+
+	/* Indices of the start of the current command and of its end('\n'). */
+	size_t start = 0, end = 0;
+	/* The number of bytes read from or written to the client's socket. */
+	ssize_t count = 0;
+
+
+
+	while (true) {
+		/*
+		 * Process the complete commands(terminated by '\n') as long
+		 * as there is room for their acknowledgements. A '\r' before
+		 * the '\n' is ignored so that clients may use either.
+		 */
+		for (start = 0, end = 0; (end < client->in_size) &&
+			(client->out_size + max_ack_len <= CMD_SERVER_MAX_ACKS); ++end) {
+
+			if (client->in[end] == '\n') {
+				client->in[end] = '\0';
+				if ((end > start) && (client->in[end - 1] == '\r')) {
+					client->in[end - 1] = '\0';
+				}
+
+				/*
+				 * Commands are null terminated where they end so strlen
+				 * also stops at any nullchar('\0') sent by the client.
+				 */
+				strcpy(client->out + client->out_size,
+						acks[process_cmd(client->in + start, strlen(client->in + start),
+									"Command server", id, client->conn_num, NULL)]);
+				client->out_size += strlen(client->out + client->out_size);
+
+				start = end + 1;
+			}
+		}
+
+		/* Move the remaining commands to the front of the buffer. */
+		memmove(client->in, client->in + start, client->in_size - start);
+		client->in_size -= start;
+
+		/* Move the completion records into the buffer as long as there is room. */
+		while ((client->done_list_head != NULL) &&
+			(client->out_size + CMD_DONE_MAX_LEN <= CMD_SERVER_MAX_ACKS)) {
+
+			/* Save the current first element. */
+			done = client->done_list_head;
+			/* Move to the next element. */
+			client->done_list_head = client->done_list_head->link;
+
+			client->out_size += (size_t) sprintf(client->out + client->out_size,
+										"DONE %" PRIuFAST32 " %s %" PRIuFAST64 "\n",
+										done->req.req_id, completions[done->completion],
+										CMD_LATENCY(done->req.submit_time, done->done_time));
+
+			/* Detach and free the element saved in done. */
+			done->link = NULL;
+			free(done);
+		}
+		if (client->done_list_head == NULL) {
+			client->done_list_tail = NULL;
+		}
+
+
+
+		/* Send the pending acknowledgements. */
+		while (client->out_size != 0) {
+			count = send(client->fd, client->out, client->out_size, MSG_NOSIGNAL);
+			if (count == -1) {
+				if (errno == EINTR) { continue; }
+				if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) { break; }
+
+				/* The client has disconnected. */
+				client->is_closed = true;
+				return;
+			}
+
+			memmove(client->out, client->out + count, client->out_size - (size_t) count);
+			client->out_size -= (size_t) count;
+		}
+
+		/*
+		 * Stop reading new commands while the client is not reading
+		 * its acknowledgements and wait until it can be written to.
+		 */
+		if (client->out_size != 0) {
+			client->events = EPOLLOUT;
+			return;
+		}
+		client->events = EPOLLIN;
+
+		/* Send the remaining completion records before receiving new commands. */
+		if (client->done_list_head != NULL) {
+			continue;
+		}
+
+		/* Commands which do not fit into the buffer are not allowed. */
+		if (client->in_size == CMD_SERVER_MAX_LINE) {
+			fprintf(stderr, "The command server disconnected a client since it sent a command longer than %d characters.\n",
+						CMD_SERVER_MAX_LINE);
+			client->is_closed = true;
+			return;
+		}
+
+
+
+		/* Receive new commands. */
+		count = read(client->fd, client->in + client->in_size, CMD_SERVER_MAX_LINE - client->in_size);
+		if (count == 0) {
+			/* The client has closed its connection. */
+			client->is_closed = true;
+			return;
+		} else if (count == -1) {
+			if (errno == EINTR) { continue; }
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) { return; }
+
+			/* The client has disconnected. */
+			client->is_closed = true;
+			return;
+		}
+		client->in_size += (size_t) count;
+	}
+}
+
+/*
+ * Update the command server's epoll instance after the given client
+ * has been served. A closed client is removed from the clients list
+ * and freed, or else the events that the command server waits for
+ * are modified if they differ from old_events.
+ *
+ * Preconditions:
+ * 		1. server != NULL
+ * 		2. client is in the clients list of server
+ */
+void update_cmd_client(CmdServer *server, CmdClient *client, const uint32_t old_events) {
+	/* Client pointer used for iterating over the clients list. */
+	CmdClient *prev_client = NULL;
+	/* Completion record pointer used for freeing the client's records. */
+	CmdDone *done = NULL;
+	/* The event used to modify the client's events. */
+	struct epoll_event event;
+
+
+
+	if (client->is_closed) {
+		/*
+		 * Remove the client from the clients list. Closing its
+		 * socket also removes it from the epoll instance.
+		 */
+		if (client == server->client_list_head) {
+			server->client_list_head = client->link;
+		} else { /* (client != server->client_list_head) */
+			for (prev_client = server->client_list_head; prev_client->link != client;
+				prev_client = prev_client->link) {
+				/* Do nothing. */
+			}
+			prev_client->link = client->link;
+		}
+
+		/* Free memory allocated to the client's completion records. */
+		while (client->done_list_head != NULL) {
+			done = client->done_list_head;
+			client->done_list_head = client->done_list_head->link;
+			free(done);
+		}
+
+		/* Detach and free the element saved in client. */
+		close(client->fd);
+		client->link = NULL;
+		free(client);
+	} else if (client->events != old_events) {
+		/* Wait for the other kind of events on the client's socket. */
+		event.events = client->events;
+		event.data.ptr = (void *) client;
+		if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &event) != 0) {
+			EXIT_ERR(EPOLL_ERR_MSG, EPOLL_ERR);
+		}
+	}
+}
+
+/*
+ * Move the completion records of the command server's clients from the
+ * global completion records list to their own lists and serve each
+ * client which can be sent its records right away. Records of clients
+ * which have already disconnected are freed.
+ *
+ * Precondition: server != NULL
+ */
+void route_cmd_done(CmdServer *server, const uint_fast64_t id) {
+	/* Pointer to the head of the taken completion records list. */
+	CmdDone *done_list_head = NULL;
+	/* Completion record pointer used for iterating over the taken records. */
+	CmdDone *done = NULL;
+	/* Client pointers used for iterating over the clients list. */
+	CmdClient *client = NULL, *next_client = NULL;
+
+
+
+	/* Take the entire global completion records list in O(1). */
+	if (pthread_mutex_lock(&cmd_done_mutex) != 0) {
+		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
+	}
+	done_list_head = cmd_done_list_head;
+	cmd_done_list_head = NULL;
+	cmd_done_list_tail = NULL;
+	if (pthread_mutex_unlock(&cmd_done_mutex) != 0) {
+		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
+	}
+
+
+
+	/* Move each record to the end of its client's list keeping their order. */
+	while (done_list_head != NULL) {
+		/* Detach the current first record. */
+		done = done_list_head;
+		done_list_head = done_list_head->link;
+		done->link = NULL;
+
+		for (client = server->client_list_head; client != NULL; client = client->link) {
+			if (client->conn_num == done->req.client) {
+				/* Terminate the searching for loop. */
+				break;
+			}
+		}
+
+		if (client == NULL) {
+			/* The client has already disconnected. */
+			free(done);
+		} else if (client->done_list_head == NULL) {
+			client->done_list_head = done;
+			client->done_list_tail = done;
+		} else { /* (client->done_list_head != NULL) */
+			client->done_list_tail->link = done;
+			client->done_list_tail = done;
+		}
+	}
+
+
+
+	/*
+	 * Serve the clients which are not waiting to be written to. The rest
+	 * are sent their records once their pending acknowledgements are sent.
+	 */
+	for (client = server->client_list_head; client != NULL; client = next_client) {
+		next_client = client->link;
+		if ((client->done_list_head != NULL) && (client->events == EPOLLIN)) {
+			serve_cmd_client(client, id);
+			update_cmd_client(server, client, EPOLLIN);
+		}
+	}
+}
+
+/*
+ * The command server thread cleanup routine.
+ *
+ * Precondition: arg can be safely casted into (CmdServer *).
+ */
+void cleanup_cmd_server(void *arg) {
+	/* The resources acquired by the thread. */
+	CmdServer *server = (CmdServer *) arg;
+	/* Completion record pointer used for iterating over the records list. */
+	CmdDone *done = NULL;
+
+
+
+	/* Close the sockets of and free memory allocated to the clients list. */
+	while (server->client_list_head != NULL) {
+		server->client_list_head->is_closed = true;
+		update_cmd_client(server, server->client_list_head, server->client_list_head->events);
+	}
+
+	/*
+	 * Stop the delivery of completion records and free memory allocated
+	 * to the ones which have not been routed. The cancellation of this
+	 * thread is disabled whenever it owns cmd_done_mutex so it can be
+	 * locked here.
+	 */
+	if (pthread_mutex_lock(&cmd_done_mutex) == 0) {
+		if (cmd_done_write_fd != -1) {
+			close(cmd_done_write_fd);
+			cmd_done_write_fd = -1;
+		}
+		while (cmd_done_list_head != NULL) {
+			done = cmd_done_list_head;
+			cmd_done_list_head = cmd_done_list_head->link;
+			free(done);
+		}
+		cmd_done_list_tail = NULL;
+		pthread_mutex_unlock(&cmd_done_mutex);
+	}
+	if (server->done_fd != -1) {
+		close(server->done_fd);
+		server->done_fd = -1;
+	}
+
+	/* Close the epoll instance and the listening socket and remove the socket. */
+	if (server->epoll_fd != -1) {
+		close(server->epoll_fd);
+		server->epoll_fd = -1;
+	}
+	if (server->listen_fd != -1) {
+		close(server->listen_fd);
+		server->listen_fd = -1;
+		unlink(server->path);
+	}
+}
@@ -19,12 +19,12 @@
 #include "alarm_app.h"
 
 /*
- * Obtain a reader lock on the global
- * alarms list for the calling thread.
+ * Obtain a reader lock on the given shard of
+ * the alarms list for the calling thread.
  */
-void obtain_alarm_read_lock(MLData *data_ptr) {
+void obtain_alarm_read_lock(AlarmShard *shard, MLData *data_ptr) {
 	/* Obtain semaphore reader lock. */
-	if (sem_wait(&alarm_r_bin_sem) != 0) {
+	if (sem_wait(&(shard->alarm_r_bin_sem)) != 0) {
 		if (data_ptr != NULL) {
 			/* Cleanup main thread and terminate. */
 			print_error(data_ptr->err);
@@ -38,8 +38,8 @@ void obtain_alarm_read_lock(MLData *data_ptr) {
 	}
 
 	/* Wait on writers if we are the first reader. */
-	if (++reader_count == 1) {
-		if (sem_wait(&alarm_rw_bin_sem) != 0) {
+	if (++(shard->reader_count) == 1) {
+		if (sem_wait(&(shard->alarm_rw_bin_sem)) != 0) {
 			if (data_ptr != NULL) {
 				/* Cleanup main thread and terminate. */
 				print_error(data_ptr->err);
@@ -54,7 +54,7 @@ void obtain_alarm_read_lock(MLData *data_ptr) {
 	}
 
 	/* Release semaphore reader lock so that other readers can also continue. */
-	if (sem_post(&alarm_r_bin_sem) != 0) {
+	if (sem_post(&(shard->alarm_r_bin_sem)) != 0) {
 		if (data_ptr != NULL) {
 			/* Cleanup main thread and terminate. */
 			print_error(data_ptr->err);
@@ -69,12 +69,12 @@ void obtain_alarm_read_lock(MLData *data_ptr) {
 }
 
 /*
- * Release previously obtained reader lock on
- * the global alarms list by the calling thread.
+ * Release previously obtained reader lock on the given
+ * shard of the alarms list by the calling thread.
  */
-void release_alarm_read_lock(MLData *data_ptr) {
+void release_alarm_read_lock(AlarmShard *shard, MLData *data_ptr) {
 	/* Obtain semaphore reader lock. */
-	if (sem_wait(&alarm_r_bin_sem) != 0) {
+	if (sem_wait(&(shard->alarm_r_bin_sem)) != 0) {
 		if (data_ptr != NULL) {
 			/* Cleanup main thread and terminate. */
 			print_error(data_ptr->err);
@@ -88,8 +88,8 @@ void release_alarm_read_lock(MLData *data_ptr) {
 	}
 
 	/* Signal writers so that they can also continue if we are the last reader. */
-	if (--reader_count == 0) {
-		if (sem_post(&alarm_rw_bin_sem) != 0) {
+	if (--(shard->reader_count) == 0) {
+		if (sem_post(&(shard->alarm_rw_bin_sem)) != 0) {
 			if (data_ptr != NULL) {
 				/* Cleanup main thread and terminate. */
 				print_error(data_ptr->err);
@@ -104,7 +104,7 @@ void release_alarm_read_lock(MLData *data_ptr) {
 	}
 
 	/* Release semaphore reader lock so that other readers can also continue. */
-	if (sem_post(&alarm_r_bin_sem) != 0) {
+	if (sem_post(&(shard->alarm_r_bin_sem)) != 0) {
 		if (data_ptr != NULL) {
 			/* Cleanup main thread and terminate. */
 			print_error(data_ptr->err);
@@ -121,7 +121,31 @@ void release_alarm_read_lock(MLData *data_ptr) {
 
 
 /*
- * The only invocations of this function should be from the command handler thread.
+ * The only invocations of this function should be from the command handler threads.
+ *
+ * Obtain a writer lock on the given shard of the alarms list.
+ */
+void obtain_alarm_write_lock(AlarmShard *shard) {
+	if (sem_wait(&(shard->alarm_rw_bin_sem)) != 0) {
+		EXIT_ERR(SEM_WAIT_ERR_MSG, SEM_WAIT_ERR);
+	}
+}
+
+/*
+ * The only invocations of this function should be from the command handler threads.
+ *
+ * Release previously obtained writer lock on the given shard of the alarms list.
+ */
+void release_alarm_write_lock(AlarmShard *shard) {
+	if (sem_post(&(shard->alarm_rw_bin_sem)) != 0) {
+		EXIT_ERR(SEM_SIGNAL_ERR_MSG, SEM_SIGNAL_ERR);
+	}
+}
+
+
+
+/*
+ * The only invocations of this function should be from the command handler threads.
  *
  * Disable cancellation for the caller and then obtain all necessary locks.
  */
@@ -177,13 +201,26 @@ void cmd_handler_obtain_locks(int *old_state_ptr) {
 	 * blocked until it could obtain a writer lock while the main thread would be
 	 * free to execute. Note that when the command handler thread obtains a writer
 	 * lock, the main thread will be blocked regardless.
+	 *
+	 *
+	 *
+	 * However, the alarms list has since been partitioned into shards and which
+	 * of them the command handler thread writes to can only be known after it
+	 * has read the commands list. Therefore, it only locks cmd_mutex in here and
+	 * then obtains a writer lock on the shard(s) of each command right before
+	 * applying it(see obtain_alarm_write_lock). The above scenario is a lot less
+	 * severe with this, since every reader of a shard only holds its reader lock
+	 * for a single scan of the shard(no reader waits for anything else while
+	 * holding it) and only the readers of the shards being written to can block
+	 * the command handler thread at all.
+	 *
+	 * There are now many command handler threads which only lock cmd_mutex
+	 * in here to take their own commands from the commands list(and to create
+	 * alarm handler threads) and never lock it while holding a shard or
+	 * alarm_cancel_mutex. Therefore, a shard may still be locked while
+	 * cmd_mutex is held, just like the parsers do.
 	 */
 
-	/* Obtain writer lock. */
-	if (sem_wait(&alarm_rw_bin_sem) != 0) {
-		EXIT_ERR(SEM_WAIT_ERR_MSG, SEM_WAIT_ERR);
-	}
-
 	/* Lock cmd_mutex. */
 	if (pthread_mutex_lock(&cmd_mutex) != 0) {
 		EXIT_ERR(MUTEX_LOCK_ERR_MSG, MUTEX_LOCK_ERR);
@@ -191,7 +228,7 @@ void cmd_handler_obtain_locks(int *old_state_ptr) {
 }
 
 /*
- * The only invocations of this function should be from the command handler thread.
+ * The only invocations of this function should be from the command handler threads.
  *
  * Release all necessary locks in the opposite order of obtaining them when
  * invoking cmd_handler_obtain_locks and then enable cancellation for the
@@ -203,11 +240,6 @@ void cmd_handler_release_locks(int *old_state_ptr) {
 		EXIT_ERR(MUTEX_UNLOCK_ERR_MSG, MUTEX_UNLOCK_ERR);
 	}
 
-	/* Release writer lock. */
-	if (sem_post(&alarm_rw_bin_sem) != 0) {
-		EXIT_ERR(SEM_SIGNAL_ERR_MSG, SEM_SIGNAL_ERR);
-	}
-
 	/* Enable cancellation. */
 	if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, old_state_ptr) != 0) {
 		EXIT_ERR(CANCELLATION_ENABLE_ERR_MSG, CANCELLATION_ENABLE_ERR);
@@ -215,15 +247,4 @@ void cmd_handler_release_locks(int *old_state_ptr) {
 
 	/* Check if there are any pending cancellation requests. */
 	pthread_testcancel(); /* pthread_testcancel() never fails. */
-
-
-
-	/*
-	 * Yield the CPU to another thread that has been readied for execution.
-	 *
-	 * In the Linux implementation, sched_yield() always succeeds.
-	 */
-	if (sched_yield() != 0) {
-		EXIT_ERR(CPU_YIELD_ERR_MSG, CPU_YIELD_ERR);
-	}
 }
@@ -646,11 +646,60 @@ int read_line(int (*read_char)(FILE *), FILE *stream, size_t *len_ptr, char **li
 /* Time Functions */
 
 /*
- * Returns: Current time by invoking time(NULL)
- * and casting the result into uint_fast64_t.
+ * The time(in nanoseconds) last published by publish_now, or 0 if none has
+ * been published. It is only accessed through atomic loads and stores so
+ * that it is never read torn, even where a uint_fast64_t takes two words.
+ */
+static uint_fast64_t published_nsec = 0;
+
+/*
+ * Returns: Current time in seconds, which is the time last published by
+ * publish_now if there is one or else the result of time(NULL) cast into
+ * uint_fast64_t.
+ *
+ * The published time is read with a single atomic load, so a thread which
+ * publishes it periodically lets every other thread take a timestamp
+ * without a call into the C library, at the cost of the timestamp being
+ * as old as the period.
  */
 uint_fast64_t now(void) {
-	return ((uint_fast64_t) time(NULL));
+	/* The time last published by publish_now. */
+	const uint_fast64_t nsec = __atomic_load_n(&published_nsec, __ATOMIC_RELAXED);
+
+
+
+	if (nsec == 0) {
+		return ((uint_fast64_t) time(NULL));
+	}
+	return nsec / 1000000000;
+}
+
+/*
+ * Read the clock clock_id(see now_nsec) and publish its current time as
+ * the one returned by now. A failed read publishes 0 which makes now fall
+ * back to time(NULL) until the next successful publication.
+ */
+void publish_now(const clockid_t clock_id) {
+	__atomic_store_n(&published_nsec, now_nsec(clock_id), __ATOMIC_RELAXED);
+}
+
+/*
+ * Returns: Current time of the clock clock_id in nanoseconds by invoking
+ * clock_gettime and combining its result into a single uint_fast64_t
+ * number(0 if clock_gettime fails).
+ *
+ * CLOCK_REALTIME counts since the UNIX Epoch and CLOCK_MONOTONIC since an
+ * unspecified point, unaffected by changes to the system time. Their
+ * *_COARSE variants only read the value cached at the last kernel tick,
+ * which is cheaper but has a tick's precision.
+ */
+uint_fast64_t now_nsec(const clockid_t clock_id) {
+	struct timespec ts;
+
+	if (clock_gettime(clock_id, &ts) != 0) {
+		return 0;
+	}
+	return ((uint_fast64_t) ts.tv_sec) * 1000000000 + ((uint_fast64_t) ts.tv_nsec);
 }
 
 